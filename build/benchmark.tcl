@@ -0,0 +1,12 @@
+# Startup script for "make benchmark" and "make benchmark-snapshot": runs the
+# benchmark command (see share/scripts/_benchmark.tcl) with the parameters
+# passed via the environment and quits openMSX when it's done.
+
+set options [list]
+if {[info exists ::env(OPENMSX_BENCHMARK_SNAPSHOTS)]} {
+	lappend options -snapshots
+}
+benchmark -exit {*}$options \
+	-seconds $::env(OPENMSX_BENCHMARK_SECONDS) \
+	-output $::env(OPENMSX_BENCHMARK_OUTPUT) \
+	{*}$::env(OPENMSX_BENCHMARK_ITEMS)
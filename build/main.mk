@@ -63,7 +63,7 @@ endif
 # TODO: "dist" and "createsubs" are missing
 # TODO: more missing?
 # Logical targets which require dependency files.
-DEPEND_TARGETS:=all default install run bindist
+DEPEND_TARGETS:=all default install run benchmark benchmark-snapshot bindist
 # Logical targets which do not require dependency files.
 NODEPEND_TARGETS:=clean config probe 3rdparty run-3rdparty staticbindist
 # Mark all logical targets as such.
@@ -576,6 +576,33 @@ run: all
 	$(SUM) "Running $(notdir $(BINARY_FULL))..."
 	$(CMD)$(BINARY_FULL)
 
+# Run the emulation speed benchmark, without window or sound.
+# BENCHMARK_ITEMS are savestates (file names or names of savestates in the
+# user's savestates directory) or machine configs to start from power on.
+BENCHMARK_ITEMS?=C-BIOS_MSX2+
+BENCHMARK_SECONDS?=60
+BENCHMARK_OUTPUT?=$(BUILD_PATH)/benchmark.json
+benchmark: all
+	$(SUM) "Running benchmark, results go to $(BENCHMARK_OUTPUT)..."
+	$(CMD)OPENMSX_BENCHMARK_ITEMS="$(BENCHMARK_ITEMS)" \
+		OPENMSX_BENCHMARK_SECONDS="$(BENCHMARK_SECONDS)" \
+		OPENMSX_BENCHMARK_OUTPUT="$(abspath $(BENCHMARK_OUTPUT))" \
+		$(BINARY_FULL) -headless -script build/benchmark.tcl
+
+# Measure the time to save and restore an in-memory snapshot (as used by
+# reverse and run-ahead) of a full turboR machine. This needs the system ROMs
+# of that machine.
+SNAPSHOT_BENCHMARK_ITEMS?=Boosted_MSXturboR_with_IDE
+SNAPSHOT_BENCHMARK_SECONDS?=20
+SNAPSHOT_BENCHMARK_OUTPUT?=$(BUILD_PATH)/benchmark-snapshot.json
+benchmark-snapshot: all
+	$(SUM) "Running snapshot benchmark, results go to $(SNAPSHOT_BENCHMARK_OUTPUT)..."
+	$(CMD)OPENMSX_BENCHMARK_ITEMS="$(SNAPSHOT_BENCHMARK_ITEMS)" \
+		OPENMSX_BENCHMARK_SECONDS="$(SNAPSHOT_BENCHMARK_SECONDS)" \
+		OPENMSX_BENCHMARK_OUTPUT="$(abspath $(SNAPSHOT_BENCHMARK_OUTPUT))" \
+		OPENMSX_BENCHMARK_SNAPSHOTS=1 \
+		$(BINARY_FULL) -headless -script build/benchmark.tcl
+
 
 # Installation and Binary Packaging
 # =================================
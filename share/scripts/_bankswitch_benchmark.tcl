@@ -0,0 +1,117 @@
+namespace eval bankswitch_benchmark {
+
+# Measures the emulation speed of a program that does nothing else than
+# switching MegaROM banks and memory mapper segments (and reading from the
+# newly selected banks). The CPU cache has to be refilled after each switch,
+# so this mostly measures the cost of bank switches, like in SCC music
+# drivers that switch banks all the time.
+
+set_help_text bankswitch_benchmark \
+"Usage: bankswitch_benchmark \[<seconds>\]
+
+Generate a small Konami SCC MegaROM that switches the ROM bank at 0x6000
+and the memory mapper segment in page 2 in a tight loop, insert it in
+cartridge slot A and emulate it for <seconds> (default 10) seconds with
+throttle off. Prints the emulation speed, the number of executed
+instructions and the number of bank switches per host second.
+
+Note: this resets the machine, both before and after the benchmark, and
+replaces the cartridge in slot A."
+
+variable seconds
+variable saved_throttle
+variable start
+variable rom_file
+
+# Program at 0x4010 (the INIT address in the ROM header):
+#       di
+#       ld   b,0
+# loop: ld   a,b
+#       ld   (0x7000),a   ; select ROM bank at 0x6000
+#       ld   a,(0x6000)
+#       out  (0xFD),a     ; select mapper segment in page 2
+#       ld   a,(0x8000)
+#       ld   (0x7000),a   ; select ROM bank at 0x6000
+#       ld   a,(0x6100)
+#       inc  b
+#       jr   loop
+variable program {
+	0xF3 0x06 0x00
+	0x78 0x32 0x00 0x70 0x3A 0x00 0x60 0xD3 0xFD
+	0x3A 0x00 0x80 0x32 0x00 0x70 0x3A 0x00 0x61 0x04 0x18 0xEB
+}
+# number of bank switches per iteration of the loop above
+variable switches_per_loop 3
+# number of instructions per iteration of the loop above
+variable instructions_per_loop 9
+
+proc create_rom {filename} {
+	variable program
+	set rom ""
+	for {set block 0} {$block < 16} {incr block} {
+		set data [string repeat [binary format c [expr {$block * 7 + 1}]] 0x2000]
+		if {$block == 0} {
+			set header [binary format a2s "AB" 0x4010]
+			append header [string repeat "\0" 12]
+			append header [binary format c* $program]
+			set data [string replace $data 0 [expr {[string length $header] - 1}] $header]
+		}
+		append rom $data
+	}
+	set f [open $filename w]
+	fconfigure $f -translation binary
+	puts -nonewline $f $rom
+	close $f
+}
+
+proc end_run {} {
+	variable seconds
+	variable saved_throttle
+	variable start
+	variable rom_file
+	variable switches_per_loop
+	variable instructions_per_loop
+
+	lassign $start host_start instr_start
+	set host [expr {([clock microseconds] - $host_start) / 1000000.0}]
+	set instructions [expr {[machine_info instructions] - $instr_start}]
+	set switches [expr {$instructions * $switches_per_loop / $instructions_per_loop}]
+
+	set ::throttle $saved_throttle
+	carta eject
+	file delete $rom_file
+	reset
+	message [format "Bank switch benchmark: %.1f%% speed, %.3g instructions/s, %.3g bank switches/s (%.2fs host time)" \
+		[expr {100.0 * $seconds / $host}] [expr {$instructions / $host}] \
+		[expr {$switches / $host}] $host]
+}
+
+proc bankswitch_benchmark {{secs 10}} {
+	variable seconds $secs
+	variable saved_throttle
+	variable start
+	variable rom_file
+
+	if {[catch carta]} {
+		error "This machine has no cartridge slot A."
+	}
+	set rom_file [file normalize $::env(OPENMSX_USER_DATA)/../bankswitch_benchmark.rom]
+	create_rom $rom_file
+	carta $rom_file -romtype KonamiSCC
+	reset
+
+	set saved_throttle $::throttle
+	set ::throttle off
+	# give the BIOS time to boot and start the program
+	after time 5 [namespace code {
+		set start [list [clock microseconds] [machine_info instructions]]
+		after time $seconds [namespace code end_run]
+	}]
+	return "Started bank switch benchmark, this takes [expr {$secs + 5}] emulated seconds..."
+}
+
+namespace export bankswitch_benchmark
+
+} ;# namespace bankswitch_benchmark
+
+namespace import bankswitch_benchmark::*
@@ -0,0 +1,219 @@
+namespace eval benchmark {
+
+# Deterministic emulation speed benchmark. Each item (a savestate or a machine
+# config) is emulated for a fixed amount of emulated time with throttle off,
+# and the speed is reported as JSON, so that results of different openMSX
+# builds can be compared (e.g. 'make benchmark', see build/benchmark.tcl).
+
+set_help_text benchmark \
+"Usage: benchmark \[-seconds <n>\] \[-output <file>\] \[-snapshots\] \[-exit\] <item> ...
+
+Emulate each item for <n> (default 60) emulated seconds with throttle off
+and report the emulation speed as JSON. An item is either the filename of a
+savestate, the name of a savestate (see list_savestates) or the name of a
+machine config (which is then started from power on). Emulating from a
+savestate or from power on is deterministic, so runs with different builds
+of openMSX do exactly the same emulation work.
+
+Per item this reports:
+ - emulated seconds per host second
+ - executed CPU instructions per host second
+ - emulated (VDP) frames per host second
+ - the host time spent in the CPU emulation, per type of device (the sync
+   points of the VDP, the sound mixer, ...) and outside of the emulation
+   (events, Tcl scripts, ...), see the 'profile' command.
+
+With -snapshots the machine is also copied in memory every frame (like for
+the reverse snapshots, by running ahead one frame, see the 'runahead'
+setting) and the average time in milliseconds to save and to restore such a
+snapshot is reported as well. Note that this extra work lowers the reported
+emulation speed.
+
+The results are written to <file>, or printed when no file is given. With
+-exit openMSX quits when all items are done. Start openMSX with -headless to
+not render the screen; the sound driver is always set to 'null' during the
+benchmark."
+
+variable items
+variable results
+variable seconds
+variable output
+variable exit_when_done
+variable snapshots
+variable saved_settings
+variable running false
+variable frames
+variable start
+
+proc json_string {str} {
+	return "\"[string map {\\ \\\\ \" \\\" \n \\n} $str]\""
+}
+
+proc json_number {value} {
+	return [format %.9g $value]
+}
+
+proc load_item {item} {
+	if {[file exists $item]} {
+		set oldID [machine]
+		set newID [restore_machine $item]
+		activate_machine $newID
+		delete_machine $oldID
+	} elseif {$item in [list_savestates]} {
+		loadstate $item
+	} else {
+		machine $item
+	}
+}
+
+proc count_frame {} {
+	variable running
+	variable frames
+	if {!$running} return
+	incr frames
+	after frame [namespace code count_frame]
+}
+
+proc next_item {} {
+	variable items
+	variable seconds
+	variable running
+	variable frames
+	variable start
+
+	if {[llength $items] == 0} {
+		finish
+		return
+	}
+	if {[catch {load_item [lindex $items 0]} msg]} {
+		puts stderr "benchmark: skipping '[lindex $items 0]': $msg"
+		set items [lrange $items 1 end]
+		after realtime 0 [namespace code next_item]
+		return
+	}
+	set ::throttle off
+	set ::power on
+
+	set frames 0
+	set running true
+	after frame [namespace code count_frame]
+	profile start
+	set start [list [clock microseconds] [machine_info time] \
+	                [machine_info instructions]]
+	after time $seconds [namespace code end_item]
+}
+
+proc end_item {} {
+	variable items
+	variable results
+	variable snapshots
+	variable running
+	variable frames
+	variable start
+
+	set running false
+	profile stop
+	lassign $start host_start emu_start instr_start
+	set host [expr {([clock microseconds] - $host_start) / 1000000.0}]
+	set emu  [expr {[machine_info time] - $emu_start}]
+	set instructions [expr {[machine_info instructions] - $instr_start}]
+	set profile [profile]
+
+	set emulation [dict get $profile total]
+	set cpu $emulation
+	set times [list]
+	dict for {name entry} [dict get $profile syncpoints] {
+		set t [lindex $entry 0]
+		set cpu [expr {$cpu - $t}]
+		lappend times "[json_string $name]: [json_number $t]"
+	}
+	set times [linsert $times 0 \
+		"\"cpu\": [json_number $cpu]" \
+		"\"other\": [json_number [expr {$host - $emulation}]]"]
+
+	set fields [list \
+		"\"name\": [json_string [lindex $items 0]]" \
+		"\"machine\": [json_string [machine_info config_name]]" \
+		"\"emulated_seconds\": [json_number $emu]" \
+		"\"host_seconds\": [json_number $host]" \
+		"\"speed\": [json_number [expr {$emu / $host}]]" \
+		"\"instructions\": $instructions" \
+		"\"instructions_per_second\": [json_number [expr {$instructions / $host}]]" \
+		"\"frames\": $frames" \
+		"\"frames_per_second\": [json_number [expr {$frames / $host}]]" \
+		"\"host_time\": {[join $times {, }]}"]
+	if {$snapshots} {
+		set info [machine_info runahead]
+		lappend fields "\"snapshot\": {\"save\": [json_number [dict get $info save]], \"restore\": [json_number [dict get $info restore]]}"
+	}
+	lappend results "    {[join $fields {, }]}"
+
+	set items [lrange $items 1 end]
+	# don't switch machines from within a sync point of the current one
+	after realtime 0 [namespace code next_item]
+}
+
+proc finish {} {
+	variable results
+	variable seconds
+	variable output
+	variable exit_when_done
+	variable saved_settings
+
+	foreach {setting value} $saved_settings {
+		set ::$setting $value
+	}
+	set json "{\n  \"version\": [json_string [openmsx_info version]],\n"
+	append json "  \"seconds\": $seconds,\n"
+	append json "  \"results\": \[\n[join $results ,\n]\n  \]\n}"
+	if {$output ne ""} {
+		set f [open $output w]
+		puts $f $json
+		close $f
+	} else {
+		puts $json
+	}
+	if {$exit_when_done} exit
+}
+
+proc benchmark {args} {
+	variable items
+	variable results
+	variable seconds 60
+	variable output ""
+	variable exit_when_done false
+	variable snapshots false
+	variable saved_settings
+
+	while {[string match -* [lindex $args 0]]} {
+		set args [lassign $args option]
+		switch -- $option {
+			-seconds { set args [lassign $args seconds] }
+			-output  { set args [lassign $args output] }
+			-snapshots { set snapshots true }
+			-exit    { set exit_when_done true }
+			default  { error "Unknown option: $option" }
+		}
+	}
+	if {[llength $args] == 0} {
+		error "Nothing to benchmark, specify at least one savestate or machine."
+	}
+	set items $args
+	set results [list]
+
+	set saved_settings [list]
+	foreach setting {throttle sound_driver runahead} {
+		lappend saved_settings $setting [set ::$setting]
+	}
+	set ::sound_driver null
+	set ::runahead [expr {$snapshots ? 1 : 0}]
+
+	next_item
+	return "Started benchmark of [llength $items] item(s), [expr {$seconds}] emulated seconds each..."
+}
+
+namespace export benchmark
+
+} ;# namespace benchmark
+
+namespace import benchmark::*
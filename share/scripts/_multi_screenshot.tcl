@@ -14,10 +14,12 @@ proc multi_screenshot {num {base ""}} {
 
 proc multi_screenshot_helper {acc max {base ""}} {
 	if {$acc <= $max} {
+		# write the files in the background, so that taking a
+		# screenshot every frame doesn't slow down the emulation
 		if {$base eq ""} {
-			screenshot
+			screenshot -async
 		} else {
-			screenshot -prefix $base
+			screenshot -async -prefix $base
 		}
 		after frame "[namespace code multi_screenshot_helper] [expr {$acc + 1}] $max $base"
 	}
@@ -0,0 +1,143 @@
+namespace eval v9990_benchmark {
+
+# Measures the emulation speed while the V9990 shows a (random) screen in
+# P1, P2 and BYUV mode, each with and without the 'v9990_render_thread'
+# setting. Rendering dominates the host CPU time in these tests, so the
+# results mostly compare the different line converters and the effect of
+# converting lines on a separate thread.
+
+set_help_text v9990_benchmark \
+"Usage: v9990_benchmark \[<seconds>\] \[<V9990 name>\]
+
+Run the V9990 rendering benchmark: show a screen with random VRAM content
+in P1, P2 and BYUV mode and, for each mode, emulate <seconds> (default 10)
+seconds with throttle off, once without and once with the
+'v9990_render_thread' setting. The results are printed when all runs are
+finished. The V9990 name defaults to 'Sunrise GFX9000' (use 'ext gfx9000'
+to insert one).
+
+Note: this changes the V9990 registers and VRAM contents, and it only
+measures rendering when the openMSX window is visible (frames are not
+rendered while fast-forwarding)."
+
+# mode name, SCREEN_MODE_0 (R#6), PALETTE_CONTROL (R#13)
+variable modes {
+	P1   0x00 0x00
+	P2   0x45 0x00
+	BYUV 0x86 0xC0
+}
+
+variable runs
+variable results
+variable device
+variable seconds
+variable saved_settings
+variable start_time
+
+proc read_reg {reg} {
+	variable device
+	debug read "$device regs" $reg
+}
+
+proc write_reg {reg value} {
+	variable device
+	debug write "$device regs" $reg $value
+}
+
+proc fill_vram {} {
+	variable device
+	set size [debug size "$device VRAM"]
+	# 4kB block with random content, repeated over the whole VRAM
+	set block ""
+	for {set i 0} {$i < 4096} {incr i} {
+		append block [binary format c [expr {int(rand() * 256)}]]
+	}
+	for {set addr 0} {$addr < $size} {incr addr 4096} {
+		debug write_block "$device VRAM" $addr $block
+	}
+}
+
+proc start_run {} {
+	variable runs
+	variable seconds
+	variable start_time
+
+	if {[llength $runs] == 0} {
+		finish
+		return
+	}
+	lassign [lindex $runs 0] name r6 r13 threaded
+	set ::v9990_render_thread $threaded
+	write_reg 6 $r6
+	write_reg 13 $r13
+	# display enabled, sprites/cursors enabled
+	write_reg 8 [expr {([read_reg 8] | 0x80) & ~0x40}]
+
+	set start_time [clock microseconds]
+	after time $seconds [namespace code end_run]
+}
+
+proc end_run {} {
+	variable runs
+	variable results
+	variable seconds
+	variable start_time
+
+	set host [expr {([clock microseconds] - $start_time) / 1000000.0}]
+	lassign [lindex $runs 0] name r6 r13 threaded
+	set speed [expr {100.0 * $seconds / $host}]
+	lappend results [format "%-5s render_thread=%-5s: %6.1f%% (%.2fs host time)" \
+		$name $threaded $speed $host]
+	set runs [lrange $runs 1 end]
+	start_run
+}
+
+proc finish {} {
+	variable results
+	variable saved_settings
+
+	foreach {setting value} $saved_settings {
+		set ::$setting $value
+	}
+	message "V9990 benchmark results (emulation speed):\n[join $results \n]"
+}
+
+proc v9990_benchmark {{secs 10} {name "Sunrise GFX9000"}} {
+	variable modes
+	variable runs
+	variable results
+	variable device
+	variable seconds
+	variable saved_settings
+
+	if {"$name regs" ni [debug list]} {
+		error "No V9990 named '$name' found (use e.g. 'ext gfx9000')."
+	}
+	set device $name
+	set seconds $secs
+
+	set saved_settings [list]
+	foreach setting {throttle minframeskip maxframeskip v9990_render_thread} {
+		lappend saved_settings $setting [set ::$setting]
+	}
+	set ::throttle off
+	set ::minframeskip 0
+	set ::maxframeskip 0
+
+	fill_vram
+	set runs [list]
+	set results [list]
+	foreach {mode r6 r13} $modes {
+		foreach threaded {false true} {
+			lappend runs [list $mode $r6 $r13 $threaded]
+		}
+	}
+	start_run
+	return "Started V9990 benchmark, this takes about [expr {[llength $runs] * $secs}] emulated seconds..."
+}
+
+namespace export v9990_benchmark
+
+} ;# namespace v9990_benchmark
+
+namespace import v9990_benchmark::*
@@ -3,6 +3,8 @@
 #  (preferably keep this list sorted on script name)
 register_lazy "_about.tcl" about
 register_lazy "_backwards_compatibility.tcl" {quit decr restoredefault alias}
+register_lazy "_bankswitch_benchmark.tcl" bankswitch_benchmark
+register_lazy "_benchmark.tcl" benchmark
 register_lazy "_cheat.tcl" findcheat
 register_lazy "_cashandler.tcl" {casload cassave caslist casrun caspos caseject tapedeck}
 register_lazy "_cpuregs.tcl" {reg cpuregs get_active_cpu}
@@ -79,6 +81,7 @@ register_lazy "_utils.tcl" {
 	get_display_name_by_config_name get_machine_time format_time
 	format_time_subseconds get_ordered_machine_list get_random_number clip
 	file_completion filename_clean get_next_numbered_filename}
+register_lazy "_v9990_benchmark.tcl" v9990_benchmark
 register_lazy "_vdp.tcl" {
 	getcolor setcolor get_screen_mode get_screen_mode_number vdpreg vdpregs
 	v9990regs vpeek vpoke palette}
@@ -0,0 +1,265 @@
+#include "CloneRunner.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
+#include "ReverseManager.hh"
+#include "Keyboard.hh"
+#include "UnicodeKeymap.hh"
+#include "MSXMixer.hh"
+#include "Debugger.hh"
+#include "Debuggable.hh"
+#include "DeltaBlock.hh"
+#include "HelperThread.hh"
+#include "Scheduler.hh"
+#include "TclObject.hh"
+#include "CommandException.hh"
+#include "MSXException.hh"
+#include "serialize.hh"
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+CloneRunner::CloneRunner(MSXMotherBoard& motherBoard_)
+	: motherBoard(motherBoard_)
+	, runCmd(motherBoard.getCommandController())
+{
+}
+
+vector<vector<vector<byte>>> CloneRunner::run(
+	EmuDuration duration, const vector<Inputs>& inputs,
+	const vector<Read>& reads)
+{
+	// -- save: copy the machine state in memory --
+	// Like in RunAheadManager, don't use 'reverseSnapshot' mode.
+	LastDeltaBlocks lastDeltaBlocks;
+	vector<std::shared_ptr<DeltaBlock>> deltaBlocks;
+	MemOutputArchive out(lastDeltaBlocks, deltaBlocks, false);
+	out.serialize("machine", motherBoard);
+	size_t size;
+	auto savestate = out.releaseBuffer(size);
+	EmuTime start = motherBoard.getCurrentTime();
+
+	struct Job {
+		void operator()() {
+			// For this time, the clone belongs to this thread.
+			auto& scheduler = clone->getScheduler();
+			scheduler.setThread(std::this_thread::get_id());
+			try {
+				emulate(*clone, start, duration, *inputs);
+			} catch (MSXException& e) {
+				error = e.getMessage();
+			}
+			scheduler.setThread(std::thread::id());
+		}
+		std::unique_ptr<MSXMotherBoard> clone;
+		const Inputs* inputs;
+		EmuTime start;
+		EmuDuration duration;
+		string error;
+	};
+
+	// Never have more machines than threads: each machine uses quite some
+	// memory. This thread also emulates one of them.
+	auto numThreads = unsigned(std::max<size_t>(1, std::min<size_t>(
+		std::thread::hardware_concurrency(), inputs.size())));
+	vector<HelperThread> threads(numThreads - 1);
+
+	vector<vector<vector<byte>>> results;
+	for (size_t first = 0; first < inputs.size(); first += numThreads) {
+		auto num = std::min<size_t>(numThreads, inputs.size() - first);
+
+		// -- restore: creating a machine registers commands and
+		//    settings, so it can only be done in this thread --
+		vector<Job> jobs;
+		for (size_t i = 0; i < num; ++i) {
+			auto clone = motherBoard.getReactor().createEmptyMotherBoard(true);
+			clone->setHeadless();
+			MemInputArchive in(savestate.data(), size, deltaBlocks);
+			in.serialize("machine", *clone);
+			clone->getMSXMixer().mute();
+			jobs.push_back(Job{std::move(clone), &inputs[first + i],
+			                   start, duration, string()});
+		}
+
+		// -- emulate: in parallel --
+		for (size_t i = 1; i < num; ++i) {
+			threads[i - 1].start(jobs[i]);
+		}
+		jobs[0]();
+		for (size_t i = 1; i < num; ++i) {
+			threads[i - 1].wait();
+		}
+
+		// -- collect the results (and delete the machines) --
+		for (auto& job : jobs) {
+			if (!job.error.empty()) {
+				throw CommandException(
+					"Error while emulating a clone: ", job.error);
+			}
+			auto& debugger = job.clone->getDebugger();
+			vector<vector<byte>> values;
+			for (auto& r : reads) {
+				// same machine, so same debuggables as checked in RunCmd
+				auto* debuggable = debugger.findDebuggable(r.debuggable);
+				assert(debuggable);
+				vector<byte> bytes;
+				for (unsigned i = 0; i < r.size; ++i) {
+					bytes.push_back(debuggable->read(r.address + i));
+				}
+				values.push_back(std::move(bytes));
+			}
+			results.push_back(std::move(values));
+		}
+	}
+	return results;
+}
+
+void CloneRunner::emulate(MSXMotherBoard& clone, EmuTime::param start,
+                          EmuDuration duration, const Inputs& inputs)
+{
+	Keyboard* keyboard = clone.getReverseManager().getKeyboard();
+	for (auto& input : inputs) {
+		clone.fastForward(start + input.time, true);
+		keyboard->changeCmdKeyMatrix(input.row, input.mask, input.up);
+	}
+	clone.fastForward(start + duration, true);
+}
+
+
+// class RunCmd
+
+CloneRunner::RunCmd::RunCmd(CommandController& controller)
+	: Command(controller, "run_clones")
+{
+}
+
+void CloneRunner::RunCmd::execute(array_ref<TclObject> tokens, TclObject& result)
+{
+	if ((tokens.size() != 3) && (tokens.size() != 4)) {
+		throw SyntaxError();
+	}
+	auto& runner = OUTER(CloneRunner, runCmd);
+	auto& motherBoard = runner.motherBoard;
+	auto& interp = getInterpreter();
+	if (!motherBoard.isPowered()) {
+		throw CommandException("Machine is not powered on");
+	}
+
+	double seconds = tokens[1].getDouble(interp);
+	if (seconds <= 0.0) {
+		throw CommandException("Invalid duration: ", tokens[1].getString());
+	}
+	EmuDuration duration(seconds);
+
+	vector<Inputs> inputs;
+	unsigned numClones = tokens[2].getListLength(interp);
+	for (unsigned c = 0; c < numClones; ++c) {
+		TclObject sequence = tokens[2].getListIndex(interp, c);
+		Inputs in;
+		unsigned numInputs = sequence.getListLength(interp);
+		for (unsigned i = 0; i < numInputs; ++i) {
+			TclObject input = sequence.getListIndex(interp, i);
+			if (input.getListLength(interp) != 4) {
+				throw CommandException(
+					"Invalid input, expected "
+					"{<time> keymatrixdown|keymatrixup <row> <mask>}: ",
+					input.getString());
+			}
+			double time = input.getListIndex(interp, 0).getDouble(interp);
+			string_view cmd = input.getListIndex(interp, 1).getString();
+			int row  = input.getListIndex(interp, 2).getInt(interp);
+			int mask = input.getListIndex(interp, 3).getInt(interp);
+			if ((time < 0.0) || (time > seconds)) {
+				throw CommandException("Invalid input time: ", time);
+			}
+			if ((cmd != "keymatrixdown") && (cmd != "keymatrixup")) {
+				throw CommandException("Invalid input: ", cmd);
+			}
+			if ((row < 0) || (unsigned(row) >= KeyMatrixPosition::NUM_ROWS)) {
+				throw CommandException("Invalid row: ", row);
+			}
+			if ((mask < 0) || (mask >= 256)) {
+				throw CommandException("Invalid mask: ", mask);
+			}
+			in.push_back(Input{EmuDuration(time), byte(row), byte(mask),
+			                   cmd == "keymatrixup"});
+		}
+		std::stable_sort(in.begin(), in.end(),
+			[](const Input& x, const Input& y) { return x.time < y.time; });
+		if (!in.empty() && !motherBoard.getReverseManager().getKeyboard()) {
+			throw CommandException("This machine has no keyboard");
+		}
+		inputs.push_back(std::move(in));
+	}
+
+	vector<Read> reads;
+	if (tokens.size() == 4) {
+		auto& debugger = motherBoard.getDebugger();
+		unsigned numReads = tokens[3].getListLength(interp);
+		for (unsigned i = 0; i < numReads; ++i) {
+			TclObject read = tokens[3].getListIndex(interp, i);
+			unsigned len = read.getListLength(interp);
+			if ((len != 2) && (len != 3)) {
+				throw CommandException(
+					"Invalid read, expected "
+					"{<debuggable> <address> [<size>]}: ",
+					read.getString());
+			}
+			string debuggableName = read.getListIndex(interp, 0).getString().str();
+			int address = read.getListIndex(interp, 1).getInt(interp);
+			int size = (len == 3) ? read.getListIndex(interp, 2).getInt(interp) : 1;
+			auto* debuggable = debugger.findDebuggable(debuggableName);
+			if (!debuggable) {
+				throw CommandException("No such debuggable: ", debuggableName);
+			}
+			if ((address < 0) || (size <= 0) ||
+			    (unsigned(address + size) > debuggable->getSize())) {
+				throw CommandException("Invalid address or size for ",
+				                       debuggableName, ": ", read.getString());
+			}
+			reads.push_back(Read{debuggableName, unsigned(address), unsigned(size)});
+		}
+	}
+
+	for (auto& values : runner.run(duration, inputs, reads)) {
+		TclObject clone;
+		for (auto& bytes : values) {
+			if (bytes.size() == 1) {
+				clone.addListElement(int(bytes[0]));
+			} else {
+				TclObject list;
+				for (auto b : bytes) list.addListElement(int(b));
+				clone.addListElement(list);
+			}
+		}
+		result.addListElement(clone);
+	}
+}
+
+string CloneRunner::RunCmd::help(const vector<string>& /*tokens*/) const
+{
+	return "run_clones <duration> <input-sequences> [<reads>]\n"
+	       "  Copies the current machine state into one hidden machine per "
+	       "input sequence, emulates these machines <duration> seconds "
+	       "further (in parallel, on as many threads as there are host CPU "
+	       "cores) and returns for each machine the values of <reads>. The "
+	       "actual machine isn't affected. The hidden machines don't show "
+	       "video and don't make sound.\n"
+	       "  Each input sequence is a list of keyboard matrix changes "
+	       "{<time> keymatrixdown|keymatrixup <row> <mask>}, with <time> in "
+	       "seconds from now (the same as the 'keymatrixdown' and "
+	       "'keymatrixup' commands).\n"
+	       "  <reads> is a list of {<debuggable> <address> [<size>]}. The "
+	       "result is a list with for each machine a list with for each "
+	       "read the byte value, or a list of <size> byte values.\n"
+	       "  Example: press 'space' 0.1 or 0.2 seconds from now, and read "
+	       "RAM address 0xE000 after one second:\n"
+	       "    run_clones 1.0 {{{0.1 keymatrixdown 8 1}} "
+	       "{{0.2 keymatrixdown 8 1}}} {{memory 0xE000}}\n";
+}
+
+} // namespace openmsx
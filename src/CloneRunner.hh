@@ -0,0 +1,65 @@
+#ifndef CLONERUNNER_HH
+#define CLONERUNNER_HH
+
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "openmsx.hh"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+
+/** Copies the state of this machine (in memory, like the snapshots of
+  * ReverseManager) into several hidden, headless machines and emulates
+  * those in parallel, each with its own keyboard input. The actual machine
+  * is not affected. This makes searching over alternative input sequences
+  * (TAS brute-forcing, finding lag frames, ...) scale with the number of
+  * host CPU cores, see the 'run_clones' command.
+  *
+  * The hidden machines don't render video, don't produce sound, don't
+  * send CliComm messages and don't call Tcl callbacks (see
+  * MSXMotherBoard::isHidden() and setHeadless()). They're created and
+  * deleted in the main thread (that touches the Tcl interpreter), only the
+  * emulation itself runs on the helper threads (see Scheduler::setThread()),
+  * while the main thread waits for them.
+  */
+class CloneRunner
+{
+public:
+	explicit CloneRunner(MSXMotherBoard& motherBoard);
+
+private:
+	struct Input {
+		EmuDuration time; // relative to the start
+		byte row;
+		byte mask;
+		bool up;
+	};
+	using Inputs = std::vector<Input>;
+	struct Read {
+		std::string debuggable;
+		unsigned address;
+		unsigned size;
+	};
+
+	std::vector<std::vector<std::vector<byte>>> run(
+		EmuDuration duration, const std::vector<Inputs>& inputs,
+		const std::vector<Read>& reads);
+	static void emulate(MSXMotherBoard& clone, EmuTime::param start,
+	                    EmuDuration duration, const Inputs& inputs);
+
+	MSXMotherBoard& motherBoard;
+
+	struct RunCmd final : Command {
+		explicit RunCmd(CommandController& controller);
+		void execute(array_ref<TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} runCmd;
+};
+
+} // namespace openmsx
+
+#endif
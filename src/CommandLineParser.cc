@@ -56,6 +56,7 @@ CommandLineParser::CommandLineParser(Reactor& reactor_)
 {
 	haveConfig = false;
 	haveSettings = false;
+	headless = false;
 
 	registerOption("-h",          helpOption,    PHASE_BEFORE_INIT, 1);
 	registerOption("--help",      helpOption,    PHASE_BEFORE_INIT, 1);
@@ -70,6 +71,7 @@ CommandLineParser::CommandLineParser(Reactor& reactor_)
 	registerOption("-nopbo",      noPBOOption,   PHASE_BEFORE_SETTINGS, 1);
 	#endif
 	registerOption("-testconfig", testConfigOption, PHASE_BEFORE_SETTINGS, 1);
+	registerOption("-headless",   headlessOption, PHASE_BEFORE_SETTINGS, 1);
 
 	registerOption("-machine",    machineOption, PHASE_LOAD_MACHINE);
 
@@ -278,7 +280,7 @@ void CommandLineParser::parse(int argc, char** argv)
 
 bool CommandLineParser::isHiddenStartup() const
 {
-	return (parseStatus == CONTROL) || (parseStatus == TEST);
+	return (parseStatus == CONTROL) || (parseStatus == TEST) || headless;
 }
 
 CommandLineParser::ParseStatus CommandLineParser::getParseStatus() const
@@ -575,6 +577,20 @@ string_view CommandLineParser::TestConfigOption::optionHelp() const
 	return "Test if the specified config works and exit";
 }
 
+// class HeadlessOption
+
+void CommandLineParser::HeadlessOption::parseOption(
+	const string& /*option*/, array_ref<string>& /*cmdLine*/)
+{
+	auto& parser = OUTER(CommandLineParser, headlessOption);
+	parser.headless = true;
+}
+
+string_view CommandLineParser::HeadlessOption::optionHelp() const
+{
+	return "Run without opening a window (renderer stays 'none')";
+}
+
 // class BashOption
 
 void CommandLineParser::BashOption::parseOption(
@@ -126,6 +126,11 @@ private:
 		string_view optionHelp() const override;
 	} testConfigOption;
 
+	struct HeadlessOption final : CLIOption {
+		void parseOption(const std::string& option, array_ref<std::string>& cmdLine) override;
+		string_view optionHelp() const override;
+	} headlessOption;
+
 	struct BashOption final : CLIOption {
 		void parseOption(const std::string& option, array_ref<std::string>& cmdLine) override;
 		string_view optionHelp() const override;
@@ -145,6 +150,7 @@ private:
 	ParseStatus parseStatus;
 	bool haveConfig;
 	bool haveSettings;
+	bool headless;
 };
 
 } // namespace openmsx
@@ -3,6 +3,7 @@
 #include "FileContext.hh"
 #include "File.hh"
 #include "FileException.hh"
+#include "MSXMotherBoard.hh"
 
 namespace openmsx {
 
@@ -30,6 +31,10 @@ FirmwareSwitch::FirmwareSwitch(const DeviceConfig& config_)
 
 FirmwareSwitch::~FirmwareSwitch()
 {
+	// A hidden machine (see MSXMotherBoard::isHidden()) doesn't persist
+	// anything, leave that to the actual machine.
+	if (config.getMotherBoard().isHidden()) return;
+
 	// save firmware switch setting value to persistent data
 	try {
 		File file(config.getFileContext().resolveCreate(filename),
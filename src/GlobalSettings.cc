@@ -43,6 +43,21 @@ GlobalSettings::GlobalSettings(GlobalCommandController& commandController_)
 			{"hq",   ResampledSoundDevice::RESAMPLE_HQ},
 			{"fast", ResampledSoundDevice::RESAMPLE_LQ},
 			{"blip", ResampledSoundDevice::RESAMPLE_BLIP}})
+	, framePacingSetting(commandController, "frame_pacing",
+		"how to wait for the next frame: 'sleep' only sleeps, 'precise' "
+		"sleeps and then busy-waits the last part (smoother, but costs "
+		"some host CPU time), see 'machine_info frame_pacing'",
+		RealTime::PACING_SLEEP, EnumSetting<RealTime::Pacing>::Map{
+			{"sleep",   RealTime::PACING_SLEEP},
+			{"precise", RealTime::PACING_PRECISE}})
+	, runAheadSetting(commandController, "runahead",
+		"number of frames to run ahead, this lowers the input latency "
+		"but costs a lot of host CPU time (see 'machine_info runahead'), "
+		"0 means off", 0, 0, 10)
+	, fastDiskIOSetting(commandController, "fast_disk_io",
+		"transfer disk sectors directly instead of via the emulated "
+		"floppy disk controller (much faster, but not cycle accurate)",
+		false)
 	, throttleManager(commandController)
 {
 	for (auto i : xrange(SDL_NumJoysticks())) {
@@ -8,6 +8,7 @@
 #include "StringSetting.hh"
 #include "ThrottleManager.hh"
 #include "ResampledSoundDevice.hh"
+#include "RealTime.hh"
 #include <memory>
 #include <vector>
 
@@ -50,6 +51,15 @@ public:
 	EnumSetting<ResampledSoundDevice::ResampleType>& getResampleSetting() {
 		return resampleSetting;
 	}
+	EnumSetting<RealTime::Pacing>& getFramePacingSetting() {
+		return framePacingSetting;
+	}
+	IntegerSetting& getRunAheadSetting() {
+		return runAheadSetting;
+	}
+	BooleanSetting& getFastDiskIOSetting() {
+		return fastDiskIOSetting;
+	}
 	IntegerSetting& getJoyDeadzoneSetting(int i) {
 		return *deadzoneSettings[i];
 	}
@@ -71,6 +81,9 @@ private:
 	StringSetting  umrCallBackSetting;
 	StringSetting  invalidPsgDirectionsSetting;
 	EnumSetting<ResampledSoundDevice::ResampleType> resampleSetting;
+	EnumSetting<RealTime::Pacing> framePacingSetting;
+	IntegerSetting runAheadSetting;
+	BooleanSetting fastDiskIOSetting;
 	std::vector<std::unique_ptr<IntegerSetting>> deadzoneSettings;
 	ThrottleManager throttleManager;
 };
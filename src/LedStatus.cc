@@ -18,10 +18,12 @@ static std::string getLedName(LedStatus::Led led)
 LedStatus::LedStatus(
 		RTScheduler& rtScheduler,
 		CommandController& commandController,
-		MSXCliComm& msxCliComm_)
+		MSXCliComm& msxCliComm_,
+		bool hidden_)
 	: RTSchedulable(rtScheduler)
 	, msxCliComm(msxCliComm_)
 	, interp(commandController.getInterpreter())
+	, hidden(hidden_)
 {
 	lastTime = Timer::getTime();
 	for (int i = 0; i < NUM_LEDS; ++i) {
@@ -41,6 +43,11 @@ void LedStatus::setLed(Led led, bool status)
 	if (ledValue[led] == status) return;
 	ledValue[led] = status;
 
+	// Nobody sees the LEDs of a hidden machine. And it may run on another
+	// thread (see CloneRunner), so it must not touch the settings or the
+	// RTScheduler.
+	if (hidden) return;
+
 	// Some MSX programs generate tons of LED events (e.g. New Era uses
 	// the LEDs as a VU meter while playing samples). Without throttling
 	// all these events overload the host CPU. That's why we limit it to
@@ -28,7 +28,8 @@ public:
 
 	LedStatus(RTScheduler& rtScheduler,
 	          CommandController& commandController,
-	          MSXCliComm& msxCliComm);
+	          MSXCliComm& msxCliComm,
+	          bool hidden);
 	~LedStatus();
 
 	void setLed(Led led, bool status);
@@ -44,6 +45,7 @@ private:
 	std::unique_ptr<ReadOnlySetting> ledStatus[NUM_LEDS];
 	uint64_t lastTime;
 	bool ledValue[NUM_LEDS];
+	const bool hidden; // see MSXMotherBoard::isHidden()
 };
 
 } // namespace openmsx
@@ -452,6 +452,11 @@ void MSXDevice::globalRead(word /*address*/, EmuTime::param /*time*/)
 	UNREACHABLE;
 }
 
+void MSXDevice::executeTrap(word /*address*/, EmuTime::param /*time*/)
+{
+	UNREACHABLE;
+}
+
 byte* MSXDevice::getWriteCacheLine(word /*start*/) const
 {
 	return nullptr; // uncacheable
@@ -462,6 +467,12 @@ void MSXDevice::invalidateMemCache(word start, unsigned size)
 	getCPU().invalidateMemCache(start, size);
 }
 
+void MSXDevice::fillMemCache(word start, unsigned size,
+                             const byte* rData, byte* wData)
+{
+	getCPUInterface().fillMemCache(*this, start, size, rData, wData);
+}
+
 template<typename Archive>
 void MSXDevice::serialize(Archive& ar, unsigned /*version*/)
 {
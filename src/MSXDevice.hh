@@ -202,12 +202,31 @@ public:
 	  */
 	virtual void globalRead(word address, EmuTime::param time);
 
+	/** Emulator traps. Called when the CPU executes the opcode ED FE (a
+	  * NOP on real hardware) at a registered address in this device, see
+	  * MSXCPUInterface::registerTrap(). This allows to replace a ROM
+	  * routine by native code: the device can read and modify the CPU
+	  * registers and memory. When the program counter is left unchanged,
+	  * execution continues after the ED FE opcode.
+	  */
+	virtual void executeTrap(word address, EmuTime::param time);
+
 	/** Invalidate CPU memory-mapping cache.
 	  * This is a shortcut to the MSXCPU::invalidateMemCache() method,
 	  * see that method for more details.
 	  */
 	void invalidateMemCache(word start, unsigned size);
 
+	/** Like invalidateMemCache(), but also pass the memory that is now
+	  * visible in [start, start + size): 'rData' for reading and 'wData'
+	  * for writing (nullptr when not cacheable). When this device is
+	  * visible for the CPU, the CPU cache is filled in directly, so the
+	  * CPU doesn't have to query getReadCacheLine()/getWriteCacheLine()
+	  * again for each line. See MSXCPUInterface::fillMemCache().
+	  */
+	void fillMemCache(word start, unsigned size,
+	                  const byte* rData, byte* wData);
+
 	/** Get the mother board this device belongs to
 	  */
 	MSXMotherBoard& getMotherBoard() const;
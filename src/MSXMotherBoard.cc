@@ -2,6 +2,8 @@
 #include "Reactor.hh"
 #include "MSXDevice.hh"
 #include "ReverseManager.hh"
+#include "RunAheadManager.hh"
+#include "CloneRunner.hh"
 #include "HardwareConfig.hh"
 #include "ConfigException.hh"
 #include "XMLElement.hh"
@@ -41,12 +43,19 @@
 #include "serialize.hh"
 #include "serialize_stl.hh"
 #include "ScopedAssign.hh"
+#include "StringOp.hh"
+#include "likely.hh"
 #include "stl.hh"
 #include "unreachable.hh"
 #include <cassert>
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <memory>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
 
 using std::make_unique;
 using std::string;
@@ -142,6 +151,17 @@ private:
 	MSXMotherBoard& motherBoard;
 };
 
+class ProfileCmd final : public Command
+{
+public:
+	explicit ProfileCmd(MSXMotherBoard& motherBoard);
+	void execute(array_ref<TclObject> tokens, TclObject& result) override;
+	string help(const vector<string>& tokens) const override;
+	void tabCompletion(vector<string>& tokens) const override;
+private:
+	MSXMotherBoard& motherBoard;
+};
+
 class FastForwardHelper final : private Schedulable
 {
 public:
@@ -172,7 +192,7 @@ private:
 
 static unsigned machineIDCounter = 0;
 
-MSXMotherBoard::MSXMotherBoard(Reactor& reactor_)
+MSXMotherBoard::MSXMotherBoard(Reactor& reactor_, bool hidden_)
 	: reactor(reactor_)
 	, machineID(strCat("machine", ++machineIDCounter))
 	, mapperIOCounter(0)
@@ -194,6 +214,9 @@ MSXMotherBoard::MSXMotherBoard(Reactor& reactor_)
 	, powered(false)
 	, active(false)
 	, fastForwarding(false)
+	, hidden(hidden_)
+	, headless(false)
+	, profileTime(0)
 {
 	slotManager = make_unique<CartridgeSlotManager>(*this);
 	reverseManager = make_unique<ReverseManager>(*this);
@@ -205,14 +228,17 @@ MSXMotherBoard::MSXMotherBoard(Reactor& reactor_)
 	machineNameInfo = make_unique<MachineNameInfo>(*this);
 	machineTypeInfo = make_unique<MachineTypeInfo>(*this);
 	deviceInfo = make_unique<DeviceInfo>(*this);
+	profileCommand = make_unique<ProfileCmd>(*this);
 	debugger = make_unique<Debugger>(*this);
+	runAheadManager = make_unique<RunAheadManager>(*this);
+	cloneRunner = make_unique<CloneRunner>(*this);
 
 	msxMixer->mute(); // powered down
 
 	// Do this before machine-specific settings are created, otherwise
 	// a setting-info clicomm message is send with a machine id that hasn't
 	// been announced yet over clicomm.
-	addRemoveUpdate = make_unique<AddRemoveUpdate>(*this);
+	if (!hidden) addRemoveUpdate = make_unique<AddRemoveUpdate>(*this);
 
 	// TODO: Initialization of this field cannot be done much earlier because
 	//       EventDelay creates a setting, calling getMSXCliComm()
@@ -469,7 +495,8 @@ LedStatus& MSXMotherBoard::getLedStatus()
 		ledStatus = make_unique<LedStatus>(
 			reactor.getRTScheduler(),
 			*msxCommandController,
-			*msxCliComm);
+			*msxCliComm,
+			hidden);
 	}
 	return *ledStatus;
 }
@@ -496,7 +523,15 @@ bool MSXMotherBoard::execute()
 	}
 	assert(getMachineConfig()); // otherwise powered cannot be true
 
-	getCPU().execute(false);
+	if (likely(!scheduler->isProfiling())) {
+		getCPU().execute(false);
+	} else {
+		using namespace std::chrono;
+		auto start = steady_clock::now();
+		getCPU().execute(false);
+		auto stop = steady_clock::now();
+		profileTime += duration_cast<nanoseconds>(stop - start).count();
+	}
 	return true;
 }
 
@@ -594,6 +629,7 @@ void MSXMotherBoard::powerUp()
 	}
 	getCPU().doReset(time);
 	msxMixer->unmute();
+	runAheadManager->reInit();
 	// let everyone know we're booting, note that the fact that this is
 	// done after the reset call to the devices is arbitrary here
 	reactor.getEventDistributor().distributeEvent(
@@ -823,6 +859,89 @@ string ListExtCmd::help(const vector<string>& /*tokens*/) const
 }
 
 
+// ProfileCmd
+ProfileCmd::ProfileCmd(MSXMotherBoard& motherBoard_)
+	: Command(motherBoard_.getCommandController(), "profile")
+	, motherBoard(motherBoard_)
+{
+}
+
+static string schedulableName(const std::type_index& type)
+{
+	string result = type.name();
+#ifdef __GNUC__
+	int status;
+	char* demangled = abi::__cxa_demangle(result.c_str(), nullptr, nullptr, &status);
+	if (demangled) {
+		result = demangled;
+		free(demangled);
+	}
+#endif
+	string_view prefix = "openmsx::";
+	if (StringOp::startsWith(result, prefix)) {
+		result.erase(0, prefix.size());
+	}
+	return result;
+}
+
+void ProfileCmd::execute(array_ref<TclObject> tokens, TclObject& result)
+{
+	auto& scheduler = motherBoard.getScheduler();
+	if (tokens.size() == 2) {
+		string_view sub = tokens[1].getString();
+		if (sub == "start") {
+			motherBoard.profileTime = 0;
+			scheduler.setProfiling(true);
+		} else if (sub == "stop") {
+			scheduler.setProfiling(false);
+		} else {
+			throw SyntaxError();
+		}
+		return;
+	}
+	if (tokens.size() != 1) {
+		throw SyntaxError();
+	}
+
+	// Several instances of the same class (e.g. multiple PSGs) are
+	// reported together.
+	TclObject syncPoints;
+	for (auto& p : scheduler.getProfile()) {
+		TclObject entry;
+		entry.addListElement(p.second.time * 1e-9);
+		entry.addListElement(double(p.second.count));
+		syncPoints.addListElement(schedulableName(p.first));
+		syncPoints.addListElement(entry);
+	}
+	result.addListElement("total");
+	result.addListElement(motherBoard.profileTime * 1e-9);
+	result.addListElement("syncpoints");
+	result.addListElement(syncPoints);
+}
+
+string ProfileCmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Measure where the host CPU time goes while emulating.\n"
+	       "  profile start : (re)start collecting timing information\n"
+	       "  profile stop  : stop collecting, the results remain available\n"
+	       "  profile       : return the results as a Tcl dict: 'total' is "
+	       "the host time (in seconds) spent emulating this machine and "
+	       "'syncpoints' is a dict with, per type of device, the host time "
+	       "spent in its sync points and the number of sync points. The "
+	       "remaining time is spent in the CPU emulation (including the "
+	       "I/O and memory accesses to devices).\n"
+	       "Collecting this information slows down the emulation a bit.\n";
+}
+
+void ProfileCmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const subCmds[] = { "start", "stop" };
+		completeString(tokens, subCmds);
+	}
+}
+
+
 // ExtCmd
 ExtCmd::ExtCmd(MSXMotherBoard& motherBoard_, std::string commandName_)
 	: RecordedCommand(motherBoard_.getCommandController(),
@@ -1114,6 +1233,8 @@ void MSXMotherBoard::serialize(Archive& ar, unsigned version)
 		powerSetting.setBoolean(true);
 		getLedStatus().setLed(LedStatus::POWER, true);
 		msxMixer->unmute();
+		// like for MSXMixer above, but this needs the VDP state
+		runAheadManager->reInit();
 	}
 
 	if (version == 2) {
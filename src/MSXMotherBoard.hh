@@ -46,12 +46,15 @@ class MSXMapperIO;
 class MSXMixer;
 class PanasonicMemory;
 class PluggingController;
+class ProfileCmd;
 class Reactor;
 class RealTime;
 class RemoveExtCmd;
 class RenShaTurbo;
 class ResetCmd;
 class ReverseManager;
+class RunAheadManager;
+class CloneRunner;
 class SettingObserver;
 class Scheduler;
 class Setting;
@@ -63,7 +66,7 @@ public:
 	MSXMotherBoard(const MSXMotherBoard&) = delete;
 	MSXMotherBoard& operator=(const MSXMotherBoard&) = delete;
 
-	explicit MSXMotherBoard(Reactor& reactor);
+	explicit MSXMotherBoard(Reactor& reactor, bool hidden = false);
 	~MSXMotherBoard();
 
 	const std::string& getMachineID()   const { return machineID; }
@@ -94,8 +97,24 @@ public:
 	void doReset();
 	void activate(bool active);
 	bool isActive() const { return active; }
+	bool isPowered() const { return powered; }
 	bool isFastForwarding() const { return fastForwarding; }
 
+	/** A hidden machine (see RunAheadManager and CloneRunner) is not
+	  * visible to the user: it isn't announced and doesn't send messages
+	  * via CliComm, it doesn't call Tcl callbacks (e.g. di_halt_callback)
+	  * and it doesn't run ahead itself. It also doesn't persist anything:
+	  * SRAM isn't loaded or saved, and disk and harddisk writes are kept
+	  * in memory (see SectorAccessibleDisk::enableWriteOverlay()).
+	  */
+	bool isHidden() const { return hidden; }
+
+	/** A headless machine is a hidden machine that also doesn't render
+	  * video, see CloneRunner. Must be set before the devices are created.
+	  */
+	void setHeadless() { assert(hidden); headless = true; }
+	bool isHeadless() const { return headless; }
+
 	byte readIRQVector();
 
 	const HardwareConfig* getMachineConfig() const { return machineConfig; }
@@ -252,6 +271,8 @@ private:
 
 	std::unique_ptr<CartridgeSlotManager> slotManager;
 	std::unique_ptr<ReverseManager> reverseManager;
+	std::unique_ptr<RunAheadManager> runAheadManager;
+	std::unique_ptr<CloneRunner> cloneRunner;
 	std::unique_ptr<ResetCmd>     resetCommand;
 	std::unique_ptr<LoadMachineCmd> loadMachineCommand;
 	std::unique_ptr<ListExtCmd>   listExtCommand;
@@ -261,6 +282,8 @@ private:
 	std::unique_ptr<MachineTypeInfo> machineTypeInfo;
 	std::unique_ptr<DeviceInfo>   deviceInfo;
 	friend class DeviceInfo;
+	std::unique_ptr<ProfileCmd>   profileCommand;
+	friend class ProfileCmd;
 
 	std::unique_ptr<FastForwardHelper> fastForwardHelper;
 
@@ -271,6 +294,10 @@ private:
 	bool powered;
 	bool active;
 	bool fastForwarding;
+	const bool hidden;
+	bool headless;
+
+	uint64_t profileTime; // host time (ns) spent in execute() while profiling
 };
 SERIALIZE_CLASS_VERSION(MSXMotherBoard, 4);
 
@@ -1,6 +1,8 @@
 #include "RTScheduler.hh"
 #include "RTSchedulable.hh"
+#include "Thread.hh"
 #include <algorithm>
+#include <cassert>
 #include <limits>
 #include <iterator>
 
@@ -17,6 +19,9 @@ struct EqualRTSchedulable {
 
 void RTScheduler::add(uint64_t delta, RTSchedulable& schedulable)
 {
+	// Not thread safe. E.g. the machines of CloneRunner, which run on
+	// other threads, must not use it.
+	assert(Thread::isMainThread());
 	queue.insert(RTSyncPoint{Timer::getTime() + delta, &schedulable},
 	             [](RTSyncPoint& sp) {
                              sp.time = std::numeric_limits<uint64_t>::max(); },
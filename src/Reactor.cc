@@ -23,6 +23,7 @@
 #include "Display.hh"
 #include "Mixer.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExporter.hh"
 #include "GlobalSettings.hh"
 #include "BooleanSetting.hh"
 #include "EnumSetting.hh"
@@ -241,6 +242,7 @@ void Reactor::init()
 	restoreMachineCommand = make_unique<RestoreMachineCommand>(
 		*globalCommandController, *this);
 	aviRecordCommand = make_unique<AviRecorder>(*this);
+	shmExportCommand = make_unique<SharedMemoryExporter>(*this);
 	extensionInfo = make_unique<ConfigInfo>(
 		getOpenMSXInfoCommand(), "extensions");
 	machineInfo   = make_unique<ConfigInfo>(
@@ -375,9 +377,9 @@ MSXMotherBoard& Reactor::getMachine(string_view machineID) const
 	throw CommandException("No machine with ID: ", machineID);
 }
 
-Reactor::Board Reactor::createEmptyMotherBoard()
+Reactor::Board Reactor::createEmptyMotherBoard(bool hidden)
 {
-	return make_unique<MSXMotherBoard>(*this);
+	return make_unique<MSXMotherBoard>(*this, hidden);
 }
 
 void Reactor::replaceBoard(MSXMotherBoard& oldBoard_, Board newBoard_)
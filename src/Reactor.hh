@@ -48,6 +48,7 @@ class ActivateMachineCommand;
 class StoreMachineCommand;
 class RestoreMachineCommand;
 class AviRecorder;
+class SharedMemoryExporter;
 class ConfigInfo;
 class RealTimeInfo;
 class SoftwareInfoTopic;
@@ -106,7 +107,7 @@ public:
 	std::string getMachineID() const;
 
 	using Board = std::unique_ptr<MSXMotherBoard>;
-	Board createEmptyMotherBoard();
+	Board createEmptyMotherBoard(bool hidden = false);
 	void replaceBoard(MSXMotherBoard& oldBoard, Board newBoard); // for reverse
 
 private:
@@ -165,6 +166,7 @@ private:
 	std::unique_ptr<StoreMachineCommand> storeMachineCommand;
 	std::unique_ptr<RestoreMachineCommand> restoreMachineCommand;
 	std::unique_ptr<AviRecorder> aviRecordCommand;
+	std::unique_ptr<SharedMemoryExporter> shmExportCommand;
 	std::unique_ptr<ConfigInfo> extensionInfo;
 	std::unique_ptr<ConfigInfo> machineInfo;
 	std::unique_ptr<RealTimeInfo> realTimeInfo;
@@ -9,14 +9,22 @@
 #include "Reactor.hh"
 #include "IntegerSetting.hh"
 #include "BooleanSetting.hh"
+#include "EnumSetting.hh"
 #include "ThrottleManager.hh"
+#include "TclObject.hh"
 #include "checked_cast.hh"
+#include "outer.hh"
+#include <algorithm>
+#include <cmath>
 
 namespace openmsx {
 
 const double   SYNC_INTERVAL = 0.08;  // s
 const int64_t  MAX_LAG       = 200000; // us
 const uint64_t ALLOWED_LAG   =  20000; // us
+const double   MIN_SPIN      =    100; // us
+const double   MAX_SPIN      =   4000; // us
+const int64_t  LATE          =   1000; // us
 
 RealTime::RealTime(
 		MSXMotherBoard& motherBoard_, GlobalSettings& globalSettings,
@@ -29,13 +37,18 @@ RealTime::RealTime(
 	, speedSetting   (globalSettings.getSpeedSetting())
 	, pauseSetting   (globalSettings.getPauseSetting())
 	, powerSetting   (globalSettings.getPowerSetting())
+	, pacingSetting  (globalSettings.getFramePacingSetting())
+	, pacingInfo(motherBoard.getMachineInfoCommand())
 	, emuTime(EmuTime::zero)
+	, spinMargin(MIN_SPIN)
+	, overSleep(0.0)
 	, enabled(true)
 {
 	speedSetting.attach(*this);
 	throttleManager.attach(*this);
 	pauseSetting.attach(*this);
 	powerSetting.attach(*this);
+	pacingSetting.attach(*this);
 
 	resync();
 
@@ -48,6 +61,7 @@ RealTime::~RealTime()
 	eventDistributor.unregisterEventListener(OPENMSX_FRAME_DRAWN_EVENT,  *this);
 	eventDistributor.unregisterEventListener(OPENMSX_FINISH_FRAME_EVENT, *this);
 
+	pacingSetting.detach(*this);
 	powerSetting.detach(*this);
 	pauseSetting.detach(*this);
 	throttleManager.detach(*this);
@@ -92,7 +106,10 @@ void RealTime::internalSync(EmuTime::param time, bool allowSleep)
 		idealRealTime += realDuration;
 		auto currentRealTime = Timer::getTime();
 		int64_t sleep = idealRealTime - currentRealTime;
-		if (allowSleep) {
+		if (allowSleep && (pacingSetting.getEnum() == PACING_PRECISE)) {
+			preciseSleep(currentRealTime);
+			addStat(Timer::getTime() - idealRealTime);
+		} else if (allowSleep) {
 			// want to sleep for 'sleep' us
 			sleep += static_cast<int64_t>(sleepAdjust);
 			int64_t delta = 0;
@@ -103,6 +120,7 @@ void RealTime::internalSync(EmuTime::param time, bool allowSleep)
 			}
 			const double ALPHA = 0.2;
 			sleepAdjust = sleepAdjust * (1 - ALPHA) + delta * ALPHA;
+			addStat(Timer::getTime() - idealRealTime);
 		}
 		if (-sleep > MAX_LAG) {
 			idealRealTime = currentRealTime - MAX_LAG / 2;
@@ -115,6 +133,49 @@ void RealTime::internalSync(EmuTime::param time, bool allowSleep)
 	emuTime = time;
 }
 
+void RealTime::preciseSleep(uint64_t currentRealTime)
+{
+	// Sleep till 'spinMargin' before the deadline and busy-wait for the
+	// remaining time. The margin follows the (average) oversleep of the OS,
+	// so on an idle system we hardly spin, on a loaded system we spin
+	// longer but still wake up in time.
+	auto margin = static_cast<uint64_t>(spinMargin);
+	if (idealRealTime > (currentRealTime + margin)) {
+		auto wakeup = idealRealTime - margin;
+		Timer::sleepPrecise(wakeup - currentRealTime);
+		auto over = static_cast<int64_t>(Timer::getTime() - wakeup);
+		const double ALPHA = 0.1;
+		overSleep = overSleep * (1 - ALPHA) + over * ALPHA;
+		spinMargin = std::min(std::max(2 * overSleep + MIN_SPIN, MIN_SPIN),
+		                      MAX_SPIN);
+	}
+	Timer::busyWaitUntil(idealRealTime);
+}
+
+void RealTime::resetStats()
+{
+	statCount = 0;
+	statSum = 0.0;
+	statSumSq = 0.0;
+	statMin = 0;
+	statMax = 0;
+	statLate = 0;
+}
+
+void RealTime::addStat(int64_t error)
+{
+	if (statCount == 0) {
+		statMin = statMax = error;
+	} else {
+		statMin = std::min(statMin, error);
+		statMax = std::max(statMax, error);
+	}
+	++statCount;
+	statSum += error;
+	statSumSq += double(error) * error;
+	if (error > LATE) ++statLate;
+}
+
 void RealTime::executeUntil(EmuTime::param time)
 {
 	internalSync(time, true);
@@ -123,9 +184,12 @@ void RealTime::executeUntil(EmuTime::param time)
 
 int RealTime::signalEvent(const std::shared_ptr<const Event>& event)
 {
-	if (!motherBoard.isActive() || !enabled) {
+	if ((motherBoard.getReactor().getMotherBoard() != &motherBoard) ||
+	    !enabled) {
 		// these are global events, only the active machine should
-		// synchronize with real time
+		// synchronize with real time (not MSXMotherBoard::isActive(),
+		// while running ahead that's the hidden machine that shows
+		// its video, see RunAheadManager)
 		return 0;
 	}
 	if (event->getType() == OPENMSX_FINISH_FRAME_EVENT) {
@@ -157,6 +221,7 @@ void RealTime::resync()
 
 	idealRealTime = Timer::getTime();
 	sleepAdjust = 0.0;
+	resetStats();
 	removeSyncPoint();
 	emuTime = getCurrentTime();
 	setSyncPoint(emuTime + getEmuDuration(SYNC_INTERVAL));
@@ -174,4 +239,53 @@ void RealTime::disable()
 	removeSyncPoint();
 }
 
+
+// class PacingInfo
+
+RealTime::PacingInfo::PacingInfo(InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "frame_pacing")
+{
+}
+
+void RealTime::PacingInfo::execute(
+	array_ref<TclObject> /*tokens*/, TclObject& result) const
+{
+	auto& rt = OUTER(RealTime, pacingInfo);
+	double avg = 0.0;
+	double stddev = 0.0;
+	if (rt.statCount) {
+		avg = rt.statSum / rt.statCount;
+		stddev = sqrt(std::max(0.0, rt.statSumSq / rt.statCount - avg * avg));
+	}
+	result.addListElement("frames");
+	result.addListElement(int(std::min<uint64_t>(rt.statCount, 0x7FFFFFFF)));
+	result.addListElement("average");
+	result.addListElement(avg);
+	result.addListElement("stddev");
+	result.addListElement(stddev);
+	result.addListElement("min");
+	result.addListElement(double(rt.statMin));
+	result.addListElement("max");
+	result.addListElement(double(rt.statMax));
+	result.addListElement("late");
+	result.addListElement(int(std::min<uint64_t>(rt.statLate, 0x7FFFFFFF)));
+	result.addListElement("spin");
+	result.addListElement(rt.pacingSetting.getEnum() == PACING_PRECISE
+	                      ? rt.spinMargin : 0.0);
+}
+
+std::string RealTime::PacingInfo::help(
+	const std::vector<std::string>& /*tokens*/) const
+{
+	return "Returns statistics about the synchronization with real time "
+	       "(typically once per frame) since the last change of the "
+	       "speed/throttle/pause/power/frame_pacing settings, as a "
+	       "dictionary. 'average', 'stddev', 'min' and 'max' are about "
+	       "the difference (in microseconds) between the moment we "
+	       "actually woke up and the moment we should have, 'late' is the "
+	       "number of frames that were more than 1ms late and 'spin' is "
+	       "the current busy-wait time (in microseconds) of the 'precise' "
+	       "frame_pacing.";
+}
+
 } // namespace openmsx
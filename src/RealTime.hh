@@ -4,6 +4,7 @@
 #include "Schedulable.hh"
 #include "EventListener.hh"
 #include "Observer.hh"
+#include "InfoTopic.hh"
 #include "EmuTime.hh"
 #include <cstdint>
 
@@ -15,6 +16,7 @@ class EventDistributor;
 class EventDelay;
 class IntegerSetting;
 class BooleanSetting;
+template<typename T> class EnumSetting;
 class ThrottleManager;
 class Setting;
 
@@ -23,6 +25,14 @@ class RealTime final : private Schedulable, private EventListener
                      , private Observer<ThrottleManager>
 {
 public:
+	/** How to wait till it's time for the next frame (see 'frame_pacing'
+	  * setting).
+	  */
+	enum Pacing {
+		PACING_SLEEP,   // only sleep, corrected for the average oversleep
+		PACING_PRECISE, // sleep, then busy-wait the last part
+	};
+
 	explicit RealTime(
 		MSXMotherBoard& motherBoard, GlobalSettings& globalSettings,
 		EventDelay& eventDelay);
@@ -68,6 +78,9 @@ private:
 	void update(const ThrottleManager& throttleManager) override;
 
 	void internalSync(EmuTime::param time, bool allowSleep);
+	void preciseSleep(uint64_t currentRealTime);
+	void resetStats();
+	void addStat(int64_t error);
 
 	MSXMotherBoard& motherBoard;
 	EventDistributor& eventDistributor;
@@ -76,10 +89,31 @@ private:
 	IntegerSetting& speedSetting;
 	BooleanSetting& pauseSetting;
 	BooleanSetting& powerSetting;
+	EnumSetting<Pacing>& pacingSetting;
+
+	struct PacingInfo final : InfoTopic {
+		explicit PacingInfo(InfoCommand& machineInfoCommand);
+		void execute(array_ref<TclObject> tokens,
+		             TclObject& result) const override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} pacingInfo;
 
 	uint64_t idealRealTime;
 	EmuTime emuTime;
 	double sleepAdjust;
+	// PACING_PRECISE: start busy-waiting this long (us) before the deadline
+	double spinMargin;
+	double overSleep; // average oversleep (us) of Timer::sleepPrecise()
+
+	// Wake-up error (us, positive means too late) of the syncs that were
+	// allowed to sleep (typically once per frame), since the last resync.
+	uint64_t statCount;
+	double statSum;
+	double statSumSq;
+	int64_t statMin;
+	int64_t statMax;
+	uint64_t statLate; // number of syncs that were more than 1ms too late
+
 	bool enabled;
 };
 
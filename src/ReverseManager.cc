@@ -45,6 +45,9 @@ static const EmuDuration MIN_PARTITION_LENGTH = EmuDuration(60.0);
 // Max distance of one before last snapshot before the end time in replay file (in seconds)
 static const EmuDuration MAX_DIST_1_BEFORE_LAST_SNAPSHOT = EmuDuration(30.0);
 
+// Max amount of decompressed snapshot data kept for 'reverse goto' (in bytes)
+static const size_t DECODED_BLOCK_CACHE_SIZE = 32 * 1024 * 1024;
+
 static const char* const REPLAY_DIR = "replays";
 
 // A replay is a struct that contains a vector of motherboards and an MSX event
@@ -105,6 +108,7 @@ void ReverseManager::ReverseHistory::swap(ReverseHistory& other)
 {
 	std::swap(chunks, other.chunks);
 	std::swap(events, other.events);
+	std::swap(blockCache, other.blockCache);
 }
 
 void ReverseManager::ReverseHistory::clear()
@@ -112,6 +116,7 @@ void ReverseManager::ReverseHistory::clear()
 	// clear() and free storage capacity
 	Chunks().swap(chunks);
 	Events().swap(events);
+	blockCache.reset();
 }
 
 
@@ -415,11 +420,30 @@ void ReverseManager::goTo(
 			// -- restore old snapshot --
 			newBoard_ = reactor.createEmptyMotherBoard();
 			newBoard = newBoard_.get();
+			if (!hist.blockCache) {
+				hist.blockCache = std::make_unique<DeltaBlockCache>(
+					DECODED_BLOCK_CACHE_SIZE);
+			}
 			MemInputArchive in(chunk.savestate.data(),
 					   chunk.size,
-					   chunk.deltaBlocks);
+					   chunk.deltaBlocks,
+					   hist.blockCache.get());
 			in.serialize("machine", *newBoard);
 
+			// When seeking (e.g. via the reverse bar) the next
+			// goto is likely near this one. So already decompress
+			// the neighbouring snapshots in the background.
+			vector<shared_ptr<DeltaBlock>> neighbours;
+			if (it != begin(hist.chunks)) {
+				const auto& blocks = std::prev(it)->second.deltaBlocks;
+				neighbours.insert(end(neighbours), begin(blocks), end(blocks));
+			}
+			if (std::next(it) != end(hist.chunks)) {
+				const auto& blocks = std::next(it)->second.deltaBlocks;
+				neighbours.insert(end(neighbours), begin(blocks), end(blocks));
+			}
+			hist.blockCache->prefetch(neighbours);
+
 			if (eventDelay) {
 				// Handle all events that are scheduled, but not yet
 				// distributed. This makes sure no events get lost
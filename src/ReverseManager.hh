@@ -36,6 +36,7 @@ public:
 	void registerKeyboard(Keyboard& keyboard_) {
 		keyboard = &keyboard_;
 	}
+	Keyboard* getKeyboard() const { return keyboard; }
 
 	// To not loose any events we need to flush delayed events before
 	// switching machine. See comments in goTo() for more info.
@@ -75,6 +76,8 @@ private:
 		Chunks chunks;
 		Events events;
 		LastDeltaBlocks lastDeltaBlocks;
+		// created on the first 'reverse goto' that restores a snapshot
+		std::unique_ptr<DeltaBlockCache> blockCache;
 	};
 
 	bool isCollecting() const { return collecting; }
@@ -0,0 +1,241 @@
+#include "RunAheadManager.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
+#include "GlobalSettings.hh"
+#include "IntegerSetting.hh"
+#include "EventDistributor.hh"
+#include "Event.hh"
+#include "MSXMixer.hh"
+#include "VDP.hh"
+#include "DeltaBlock.hh"
+#include "TclObject.hh"
+#include "Timer.hh"
+#include "serialize.hh"
+#include <cassert>
+
+namespace openmsx {
+
+RunAheadManager::RunAheadManager(MSXMotherBoard& motherBoard_)
+	: syncFrame(motherBoard_.getScheduler())
+	, motherBoard(motherBoard_)
+	, eventDistributor(motherBoard.getReactor().getEventDistributor())
+	, runAheadSetting(motherBoard.getReactor().getGlobalSettings().getRunAheadSetting())
+	, runAheadInfo(motherBoard.getMachineInfoCommand())
+	, saveTime(0.0f)
+	, restoreTime(0.0f)
+	, emulateTime(0.0f)
+	, totalTime(0.0f)
+	, pendingRunAhead(false)
+{
+	eventDistributor.registerEventListener(OPENMSX_RUN_AHEAD, *this);
+	runAheadSetting.attach(*this);
+	// Don't schedule yet: this machine is either powered up or loaded
+	// from a savestate first, both call reInit().
+}
+
+RunAheadManager::~RunAheadManager()
+{
+	syncFrame.removeSyncPoint();
+	aheadBoard.reset();
+	runAheadSetting.detach(*this);
+	eventDistributor.unregisterEventListener(OPENMSX_RUN_AHEAD, *this);
+}
+
+void RunAheadManager::reInit()
+{
+	// Like MSXMixer::reInit(): after loading a savestate a previously set
+	// sync point lies in the past.
+	syncFrame.removeSyncPoint();
+	if (isEnabled() && !motherBoard.isHidden()) start();
+}
+
+bool RunAheadManager::isEnabled() const
+{
+	return runAheadSetting.getInt() != 0;
+}
+
+bool RunAheadManager::isActiveBoard() const
+{
+	return motherBoard.getReactor().getMotherBoard() == &motherBoard;
+}
+
+void RunAheadManager::start()
+{
+	schedule(getCurrentTime());
+}
+
+void RunAheadManager::stop()
+{
+	syncFrame.removeSyncPoint();
+	pendingRunAhead = false;
+	showOwnVideo();
+	saveTime = restoreTime = emulateTime = totalTime = 0.0;
+}
+
+void RunAheadManager::showOwnVideo()
+{
+	aheadBoard.reset();
+	// Only re-activate our video when we're still the active machine,
+	// otherwise Reactor::switchBoard() takes care of it.
+	if (!motherBoard.isActive() && isActiveBoard()) {
+		motherBoard.activate(true);
+	}
+}
+
+VDP* RunAheadManager::getVDP() const
+{
+	return dynamic_cast<VDP*>(motherBoard.findDevice("VDP"));
+}
+
+EmuDuration RunAheadManager::getFrameDuration(VDP* vdp) const
+{
+	return vdp ? VDP::VDPClock::duration(vdp->getTicksPerFrame())
+	           : EmuDuration(1.0 / 60.0);
+}
+
+void RunAheadManager::schedule(EmuTime::param time)
+{
+	// Run ahead at the start of each VDP frame, so that the hidden machine
+	// can show exactly one complete frame.
+	VDP* vdp = getVDP();
+	EmuDuration frame = getFrameDuration(vdp);
+	EmuTime next = vdp ? vdp->getFrameStartTime() + frame : time + frame;
+	while (next <= time) next += frame;
+	syncFrame.setSyncPoint(next);
+}
+
+void RunAheadManager::execFrame()
+{
+	// Same as in ReverseManager::execNewSnapshot(): we can't copy the
+	// machine in the middle of a Z80 instruction (and certainly not
+	// create a new machine while this one is emulating), so do it from
+	// the event loop.
+	pendingRunAhead = true;
+	eventDistributor.distributeEvent(
+		std::make_shared<SimpleEvent>(OPENMSX_RUN_AHEAD));
+}
+
+int RunAheadManager::signalEvent(const std::shared_ptr<const Event>& event)
+{
+	(void)event;
+	assert(event->getType() == OPENMSX_RUN_AHEAD);
+
+	// This event is send to all MSX machines, make sure it's actually this
+	// machine that requested it.
+	if (pendingRunAhead) {
+		pendingRunAhead = false;
+		// Only the active machine runs ahead. In particular not the
+		// hidden machines created below (they also have a
+		// RunAheadManager).
+		if (isEnabled() && isActiveBoard() && motherBoard.isPowered()) {
+			runAhead();
+		} else {
+			showOwnVideo();
+		}
+		schedule(getCurrentTime());
+	}
+	return 0;
+}
+
+void RunAheadManager::runAhead()
+{
+	auto time0 = Timer::getTime();
+
+	// -- save: copy the machine state in memory --
+	// Don't use 'reverseSnapshot' mode, that would interfere with the
+	// delta-compression of the ReverseManager snapshots (see TrackedRam).
+	LastDeltaBlocks lastDeltaBlocks;
+	std::vector<std::shared_ptr<DeltaBlock>> deltaBlocks;
+	MemOutputArchive out(lastDeltaBlocks, deltaBlocks, false);
+	out.serialize("machine", motherBoard);
+	size_t size;
+	auto savestate = out.releaseBuffer(size);
+	auto time1 = Timer::getTime();
+
+	// -- restore: in a new, hidden machine --
+	// First delete the previous one, so that it no longer shows its frame.
+	aheadBoard.reset();
+	// It's hidden: it doesn't get announced to the CliComm listeners
+	// (that would happen every frame).
+	auto newBoard = motherBoard.getReactor().createEmptyMotherBoard(true);
+	MemInputArchive in(savestate.data(), size, deltaBlocks);
+	in.serialize("machine", *newBoard);
+	newBoard->getMSXMixer().mute(); // only our own machine makes sound
+	auto time2 = Timer::getTime();
+
+	// -- emulate: 'runahead' frames further, only render the last one --
+	VDP* vdp = getVDP();
+	EmuDuration frame = getFrameDuration(vdp);
+	EmuDuration margin = frame / 8;
+	EmuTime start = vdp ? vdp->getFrameStartTime() : getCurrentTime();
+	unsigned frames = runAheadSetting.getInt();
+	if (frames > 1) {
+		newBoard->fastForward(start + frame * (frames - 1) - margin, true);
+	}
+	// Show the video of the hidden machine instead of our own. Our machine
+	// still synchronizes with real time (RealTime only looks at the
+	// active machine of the Reactor).
+	if (motherBoard.isActive()) {
+		motherBoard.activate(false);
+	}
+	newBoard->activate(true);
+	newBoard->fastForward(start + frame * frames + margin, false);
+	aheadBoard = std::move(newBoard);
+	auto time3 = Timer::getTime();
+
+	const double ALPHA = 0.2;
+	saveTime    = saveTime    * (1 - ALPHA) + (time1 - time0) * ALPHA;
+	restoreTime = restoreTime * (1 - ALPHA) + (time2 - time1) * ALPHA;
+	emulateTime = emulateTime * (1 - ALPHA) + (time3 - time2) * ALPHA;
+	totalTime   = totalTime   * (1 - ALPHA) + (time3 - time0) * ALPHA;
+}
+
+void RunAheadManager::update(const Setting& setting)
+{
+	(void)setting;
+	assert(&setting == &runAheadSetting);
+	if (motherBoard.isHidden()) return;
+	if (isEnabled()) {
+		if (!syncFrame.pendingSyncPoint()) start();
+	} else {
+		stop();
+	}
+}
+
+
+// class RunAheadInfo
+
+RunAheadManager::RunAheadInfo::RunAheadInfo(InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "runahead")
+{
+}
+
+void RunAheadManager::RunAheadInfo::execute(
+	array_ref<TclObject> /*tokens*/, TclObject& result) const
+{
+	auto& manager = OUTER(RunAheadManager, runAheadInfo);
+	result.addListElement("frames");
+	result.addListElement(manager.aheadBoard ? manager.runAheadSetting.getInt() : 0);
+	result.addListElement("save");
+	result.addListElement(manager.saveTime / 1000.0);
+	result.addListElement("restore");
+	result.addListElement(manager.restoreTime / 1000.0);
+	result.addListElement("emulate");
+	result.addListElement(manager.emulateTime / 1000.0);
+	result.addListElement("total");
+	result.addListElement(manager.totalTime / 1000.0);
+}
+
+std::string RunAheadManager::RunAheadInfo::help(
+	const std::vector<std::string>& /*tokens*/) const
+{
+	return "Returns the host time (in milliseconds, averaged) spent per "
+	       "frame on running ahead (see the 'runahead' setting), as a "
+	       "dictionary: 'save' for copying the machine state, 'restore' for "
+	       "creating the hidden machine from it, 'emulate' for emulating "
+	       "the frames ahead and 'total'. When 'total' gets close to the "
+	       "duration of a frame (20ms for PAL, 16.7ms for NTSC), lower the "
+	       "number of frames.";
+}
+
+} // namespace openmsx
@@ -0,0 +1,92 @@
+#ifndef RUNAHEADMANAGER_HH
+#define RUNAHEADMANAGER_HH
+
+#include "Schedulable.hh"
+#include "EventListener.hh"
+#include "Observer.hh"
+#include "InfoTopic.hh"
+#include "EmuTime.hh"
+#include "outer.hh"
+#include <memory>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class EventDistributor;
+class IntegerSetting;
+class Setting;
+class VDP;
+
+/** Reduces the input latency by showing the future: at the start of each
+  * frame the machine state is copied (in memory, like the snapshots of
+  * ReverseManager) to a hidden machine, that one is emulated 'runahead'
+  * frames further and its last frame is shown instead of the frame of the
+  * actual machine. Input (and sound) still goes to the actual machine, so
+  * an input event becomes visible 'runahead' frames earlier. Games that
+  * only read the input once per frame then react (visually) immediately.
+  */
+class RunAheadManager final : private EventListener, private Observer<Setting>
+{
+public:
+	explicit RunAheadManager(MSXMotherBoard& motherBoard);
+	~RunAheadManager();
+
+	/** Must be called after the machine is powered up or loaded from a
+	  * savestate, (re)schedules the start-of-frame sync point. */
+	void reInit();
+
+private:
+	bool isEnabled() const;
+	bool isActiveBoard() const;
+	void start();
+	void stop();
+	void showOwnVideo();
+	void schedule(EmuTime::param time);
+	void runAhead();
+	VDP* getVDP() const;
+	EmuDuration getFrameDuration(VDP* vdp) const;
+
+	// Schedulable
+	struct SyncFrame final : Schedulable {
+		friend class RunAheadManager;
+		explicit SyncFrame(Scheduler& s) : Schedulable(s) {}
+		void executeUntil(EmuTime::param /*time*/) override {
+			auto& ram = OUTER(RunAheadManager, syncFrame);
+			ram.execFrame();
+		}
+	} syncFrame;
+	void execFrame();
+	EmuTime::param getCurrentTime() const { return syncFrame.getCurrentTime(); }
+
+	// EventListener
+	int signalEvent(const std::shared_ptr<const Event>& event) override;
+
+	// Observer<Setting>
+	void update(const Setting& setting) override;
+
+	MSXMotherBoard& motherBoard;
+	EventDistributor& eventDistributor;
+	IntegerSetting& runAheadSetting;
+
+	struct RunAheadInfo final : InfoTopic {
+		explicit RunAheadInfo(InfoCommand& machineInfoCommand);
+		void execute(array_ref<TclObject> tokens,
+		             TclObject& result) const override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} runAheadInfo;
+
+	// The hidden machine that shows the future, replaced every frame.
+	std::unique_ptr<MSXMotherBoard> aheadBoard;
+
+	// Moving averages of the host time (in us) spent per frame.
+	double saveTime;
+	double restoreTime;
+	double emulateTime;
+	double totalTime;
+
+	bool pendingRunAhead;
+};
+
+} // namespace openmsx
+
+#endif
@@ -5,7 +5,9 @@
 #include "serialize.hh"
 #include <cassert>
 #include <algorithm>
+#include <chrono>
 #include <iterator> // for back_inserter
+#include <typeinfo>
 
 namespace openmsx {
 
@@ -23,6 +25,7 @@ Scheduler::Scheduler()
 	: scheduleTime(EmuTime::zero)
 	, cpu(nullptr)
 	, scheduleInProgress(false)
+	, profiling(false)
 {
 }
 
@@ -37,9 +40,16 @@ Scheduler::~Scheduler()
 	assert(queue.empty());
 }
 
+bool Scheduler::isOwnThread() const
+{
+	return (thread == std::thread::id())
+	     ? Thread::isMainThread()
+	     : (thread == std::this_thread::get_id());
+}
+
 void Scheduler::setSyncPoint(EmuTime::param time, Schedulable& device)
 {
-	assert(Thread::isMainThread());
+	assert(isOwnThread());
 	assert(time >= scheduleTime);
 
 	// Push sync point into queue.
@@ -66,20 +76,20 @@ Scheduler::SyncPoints Scheduler::getSyncPoints(const Schedulable& device) const
 
 bool Scheduler::removeSyncPoint(Schedulable& device)
 {
-	assert(Thread::isMainThread());
+	assert(isOwnThread());
 	return queue.remove(EqualSchedulable(device));
 }
 
 void Scheduler::removeSyncPoints(Schedulable& device)
 {
-	assert(Thread::isMainThread());
+	assert(isOwnThread());
 	queue.remove_all(EqualSchedulable(device));
 }
 
 bool Scheduler::pendingSyncPoint(const Schedulable& device,
                                  EmuTime& result) const
 {
-	assert(Thread::isMainThread());
+	assert(isOwnThread());
 	auto it = std::find_if(std::begin(queue), std::end(queue),
 	                       EqualSchedulable(device));
 	if (it != std::end(queue)) {
@@ -92,7 +102,7 @@ bool Scheduler::pendingSyncPoint(const Schedulable& device,
 
 EmuTime::param Scheduler::getCurrentTime() const
 {
-	assert(Thread::isMainThread());
+	assert(isOwnThread());
 	return scheduleTime;
 }
 
@@ -109,7 +119,11 @@ void Scheduler::scheduleHelper(EmuTime::param limit, EmuTime next)
 
 		queue.remove_front();
 
-		device->executeUntil(next);
+		if (likely(!profiling)) {
+			device->executeUntil(next);
+		} else {
+			executeProfiled(*device, next);
+		}
 
 		next = getNext();
 		if (likely(next > limit)) break;
@@ -119,6 +133,25 @@ void Scheduler::scheduleHelper(EmuTime::param limit, EmuTime next)
 	cpu->setNextSyncPoint(next);
 }
 
+void Scheduler::setProfiling(bool enabled)
+{
+	if (enabled && !profiling) profile.clear();
+	profiling = enabled;
+}
+
+void Scheduler::executeProfiled(Schedulable& device, EmuTime::param time)
+{
+	using namespace std::chrono;
+	// Look up the entry before executing, the device may delete itself
+	// (e.g. an 'after' command).
+	auto& entry = profile[std::type_index(typeid(device))];
+	auto start = steady_clock::now();
+	device.executeUntil(time);
+	auto stop = steady_clock::now();
+	entry.time += duration_cast<nanoseconds>(stop - start).count();
+	++entry.count;
+}
+
 
 template <typename Archive>
 void SynchronizationPoint::serialize(Archive& ar, unsigned /*version*/)
@@ -4,6 +4,10 @@
 #include "EmuTime.hh"
 #include "SchedulerQueue.hh"
 #include "likely.hh"
+#include <cstdint>
+#include <map>
+#include <thread>
+#include <typeindex>
 #include <vector>
 
 namespace openmsx {
@@ -36,6 +40,14 @@ class Scheduler
 public:
 	using SyncPoints = std::vector<SynchronizationPoint>;
 
+	/** Host time (in ns) spent in, and number of calls to, the
+	  * executeUntil() method of one type of Schedulable. */
+	struct ProfileEntry {
+		uint64_t time = 0;
+		uint64_t count = 0;
+	};
+	using Profile = std::map<std::type_index, ProfileEntry>;
+
 	Scheduler();
 	~Scheduler();
 
@@ -44,6 +56,15 @@ public:
 		cpu = cpu_;
 	}
 
+	/** A Scheduler (and the machine it belongs to) is only used from the
+	  * main thread. Except for a hidden machine that is emulated in a
+	  * helper thread while the main thread waits for it, see CloneRunner.
+	  * @param id The id of that thread, a default constructed id for the
+	  *           main thread again.
+	  */
+	void setThread(std::thread::id id) { thread = id; }
+	bool isOwnThread() const;
+
 	/**
 	 * Get the current scheduler time.
 	 */
@@ -69,6 +90,14 @@ public:
 		scheduleTime = limit;
 	}
 
+	/** Start or stop measuring the host time spent in the sync points.
+	  * Starting also clears the previously collected results. This
+	  * measurement is too expensive to always have it enabled.
+	  */
+	void setProfiling(bool enabled);
+	bool isProfiling() const { return profiling; }
+	const Profile& getProfile() const { return profile; }
+
 	template <typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -108,6 +137,7 @@ private: // -> intended for Schedulable
 
 private:
 	void scheduleHelper(EmuTime::param limit, EmuTime next);
+	void executeProfiled(Schedulable& device, EmuTime::param time);
 
 	/** Vector used as heap, not a priority queue because that
 	  * doesn't allow removal of non-top element.
@@ -115,7 +145,10 @@ private:
 	SchedulerQueue<SynchronizationPoint> queue;
 	EmuTime scheduleTime;
 	MSXCPU* cpu;
+	std::thread::id thread; // default constructed: main thread
+	Profile profile;
 	bool scheduleInProgress;
+	bool profiling;
 };
 
 } // namespace openmsx
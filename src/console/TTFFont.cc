@@ -1,12 +1,18 @@
 #include "TTFFont.hh"
 #include "LocalFileReference.hh"
 #include "MSXException.hh"
+#include "TclObject.hh"
 #include "StringOp.hh"
+#include "utf8_core.hh"
+#include "utf8_unchecked.hh"
 #include "stl.hh"
 #include "xrange.hh"
 #include <SDL_ttf.h>
 #include <algorithm>
 #include <cassert>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 using std::string;
@@ -23,12 +29,78 @@ private:
 	~SDLTTF();
 };
 
+// All glyphs of one font (one file at one size) that were used so far: their
+// metrics and their (color independent) coverage bitmaps. Text is composed
+// from these, so each glyph only has to be rasterized once by SDL_ttf. The
+// bitmaps are stored in one buffer, each glyph gets a slot of the full font
+// height (so packing is trivial: fill rows of slots from left to right).
+class GlyphAtlas
+{
+public:
+	struct Glyph {
+		int minx, maxx, advance;
+		int index;     // glyph index, only used for kerning
+		unsigned x, y; // position of the bitmap in the atlas
+		unsigned w;    // width of the bitmap (0 for e.g. a space)
+		bool ok;       // false if SDL_ttf couldn't handle this glyph
+	};
+	// glyphs of one line of text, with their x-position
+	struct Layout {
+		std::vector<std::pair<const Glyph*, int>> glyphs;
+		int minX = 0;
+		int maxX = 0;
+		unsigned getWidth() const { return maxX - minX; }
+	};
+
+	explicit GlyphAtlas(TTF_Font* font);
+
+	/** Calculate the position of all glyphs in the given text (a single
+	  * line). Returns false if the text can't be handled by the atlas
+	  * (invalid UTF-8, characters outside the BMP, ...), then the SDL_ttf
+	  * functions should be used instead (those also give a proper error).
+	  */
+	bool layout(string_view text, Layout& result);
+
+	/** Draw a line of text (see layout()) on a 32bpp ARGB surface. */
+	void draw(const Layout& layout, SDL_Surface& dst, int y,
+	          uint32_t pixel) const;
+
+	unsigned getHeight() const { return height; }
+	size_t getNumGlyphs() const { return glyphs.size(); }
+	size_t getMemorySize() const { return pixels.size(); }
+
+	// Statistics over all atlases, see 'openmsx_info font_cache'.
+	static uint64_t hits;      // glyph was already in the atlas
+	static uint64_t misses;    // glyph had to be rasterized
+	static uint64_t fallbacks; // text rendered without the atlas
+
+private:
+	static const unsigned ATLAS_WIDTH = 1024;
+
+	const Glyph* get(uint32_t ch);
+	void rasterize(uint16_t ch, Glyph& glyph);
+
+	TTF_Font* font;
+	std::unordered_map<uint32_t, Glyph> glyphs;
+	std::vector<uint8_t> pixels; // ATLAS_WIDTH bytes per row
+	unsigned height;
+	unsigned penX, penY;
+	bool kerning;
+};
+
+uint64_t GlyphAtlas::hits = 0;
+uint64_t GlyphAtlas::misses = 0;
+uint64_t GlyphAtlas::fallbacks = 0;
+
+
 class TTFFontPool
 {
 public:
 	static TTFFontPool& instance();
 	TTF_Font* get(const string& filename, int ptSize);
 	void release(TTF_Font* font);
+	GlyphAtlas& getAtlas(TTF_Font* font);
+	void getAtlasInfo(size_t& fonts, size_t& glyphs, size_t& memory) const;
 
 private:
 	TTFFontPool() = default;
@@ -51,6 +123,7 @@ private:
 	struct FontInfo {
 		LocalFileReference file;
 		TTF_Font* font;
+		std::unique_ptr<GlyphAtlas> atlas; // created on first use
 		std::string name;
 		int size;
 		int count;
@@ -80,6 +153,146 @@ SDLTTF& SDLTTF::instance()
 }
 
 
+// class GlyphAtlas
+
+GlyphAtlas::GlyphAtlas(TTF_Font* font_)
+	: font(font_)
+	, height(TTF_FontHeight(font))
+	, penX(0), penY(0)
+{
+#if (SDL_TTF_MAJOR_VERSION > 2) || (SDL_TTF_MINOR_VERSION > 0) || \
+    (SDL_TTF_PATCHLEVEL >= 10)
+	kerning = TTF_GetFontKerning(font) != 0;
+#else
+	kerning = false;
+#endif
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::get(uint32_t ch)
+{
+	if (ch > 0xFFFF) return nullptr; // SDL_ttf glyph functions take UCS-2
+	auto it = glyphs.find(ch);
+	if (it == glyphs.end()) {
+		++misses;
+		it = glyphs.emplace(ch, Glyph()).first;
+		rasterize(ch, it->second);
+	} else {
+		++hits;
+	}
+	return it->second.ok ? &it->second : nullptr;
+}
+
+void GlyphAtlas::rasterize(uint16_t ch, Glyph& glyph)
+{
+	glyph.ok = false;
+	glyph.x = glyph.y = glyph.w = 0;
+	int miny, maxy;
+	if (TTF_GlyphMetrics(font, ch, &glyph.minx, &glyph.maxx,
+	                     &miny, &maxy, &glyph.advance)) {
+		return;
+	}
+	glyph.index = 0;
+#if (SDL_TTF_MAJOR_VERSION > 2) || (SDL_TTF_MINOR_VERSION > 0) || \
+    (SDL_TTF_PATCHLEVEL >= 10)
+	if (kerning) glyph.index = TTF_GlyphIsProvided(font, ch);
+#endif
+	glyph.ok = true;
+	if (glyph.maxx <= glyph.minx) return; // nothing to draw (e.g. space)
+
+	SDL_Color white = { 255, 255, 255, 0 };
+	SDLSurfacePtr surf(TTF_RenderGlyph_Blended(font, ch, white));
+	if (!surf) {
+		glyph.ok = false;
+		return;
+	}
+	// Same as TTF_RenderUTF8_Blended(): don't draw more than maxx - minx.
+	auto w = std::min<unsigned>(surf->w, glyph.maxx - glyph.minx);
+	if (w > ATLAS_WIDTH) {
+		glyph.ok = false;
+		return;
+	}
+	if ((penX + w) > ATLAS_WIDTH) {
+		penX = 0;
+		penY += height;
+	}
+	if (pixels.size() < ((penY + height) * ATLAS_WIDTH)) {
+		pixels.resize((penY + height) * ATLAS_WIDTH, 0);
+	}
+	glyph.x = penX;
+	glyph.y = penY;
+	glyph.w = w;
+	penX += w;
+
+	// Depending on the SDL_ttf version the glyph surface is either the
+	// full font height or only as high as the glyph itself.
+	int yOffset = (unsigned(surf->h) >= height)
+	            ? 0 : TTF_FontAscent(font) - maxy;
+	const auto& format = *surf->format;
+	for (auto row : xrange(surf->h)) {
+		int y = row + yOffset;
+		if ((y < 0) || (unsigned(y) >= height)) continue;
+		auto* src = reinterpret_cast<const uint32_t*>(
+			static_cast<const uint8_t*>(surf->pixels) + row * surf->pitch);
+		auto* dst = &pixels[(glyph.y + y) * ATLAS_WIDTH + glyph.x];
+		for (auto col : xrange(w)) {
+			dst[col] = (src[col] & format.Amask) >> format.Ashift;
+		}
+	}
+}
+
+bool GlyphAtlas::layout(string_view text, Layout& result)
+{
+	result.glyphs.clear();
+	result.minX = result.maxX = 0;
+	if (!utf8::is_valid(text.begin(), text.end())) return false;
+
+	// Same calculation as TTF_SizeUTF8().
+	int x = 0;
+	const Glyph* prev = nullptr;
+	auto it = text.begin();
+	while (it != text.end()) {
+		const auto* glyph = get(utf8::unchecked::next(it));
+		if (!glyph) return false;
+#if (SDL_TTF_MAJOR_VERSION > 2) || (SDL_TTF_MINOR_VERSION > 0) || \
+    (SDL_TTF_PATCHLEVEL >= 10)
+		if (kerning && prev && prev->index && glyph->index) {
+			x += TTF_GetFontKerningSize(font, prev->index, glyph->index);
+		}
+#endif
+		result.minX = std::min(result.minX, x + glyph->minx);
+		result.maxX = std::max(result.maxX,
+		                       x + std::max(glyph->advance, glyph->maxx));
+		result.glyphs.emplace_back(glyph, x);
+		x += glyph->advance;
+		prev = glyph;
+	}
+	return true;
+}
+
+void GlyphAtlas::draw(const Layout& layout, SDL_Surface& dst, int y,
+                      uint32_t pixel) const
+{
+	for (auto& p : layout.glyphs) {
+		const auto& glyph = *p.first;
+		int x0 = p.second + glyph.minx - layout.minX;
+		for (auto row : xrange(height)) {
+			int dy = y + row;
+			if ((dy < 0) || (dy >= dst.h)) continue;
+			auto* d = reinterpret_cast<uint32_t*>(
+				static_cast<uint8_t*>(dst.pixels) + dy * dst.pitch);
+			const auto* src = &pixels[(glyph.y + row) * ATLAS_WIDTH + glyph.x];
+			for (auto col : xrange(glyph.w)) {
+				int dx = x0 + col;
+				if ((dx < 0) || (dx >= dst.w) || !src[col]) continue;
+				// overlapping glyphs: keep the highest coverage
+				uint32_t alpha = std::max<uint32_t>(src[col], d[dx] >> 24);
+				d[dx] = pixel | (alpha << 24);
+			}
+		}
+	}
+}
+
+
 // class TTFFontPool
 
 TTFFontPool::~TTFFontPool()
@@ -118,6 +331,27 @@ TTF_Font* TTFFontPool::get(const string& filename, int ptSize)
 	return result;
 }
 
+GlyphAtlas& TTFFontPool::getAtlas(TTF_Font* font)
+{
+	auto it = rfind_if_unguarded(pool,
+		[&](const FontInfo& i) { return i.font == font; });
+	if (!it->atlas) {
+		it->atlas = std::make_unique<GlyphAtlas>(font);
+	}
+	return *it->atlas;
+}
+
+void TTFFontPool::getAtlasInfo(size_t& fonts, size_t& glyphs, size_t& memory) const
+{
+	fonts = glyphs = memory = 0;
+	for (auto& i : pool) {
+		if (!i.atlas) continue;
+		++fonts;
+		glyphs += i.atlas->getNumGlyphs();
+		memory += i.atlas->getMemorySize();
+	}
+}
+
 void TTFFontPool::release(TTF_Font* font)
 {
 	auto it = rfind_if_unguarded(pool,
@@ -145,8 +379,6 @@ TTFFont::~TTFFont()
 
 SDLSurfacePtr TTFFont::render(std::string text, byte r, byte g, byte b) const
 {
-	SDL_Color color = { r, g, b, 0 };
-
 	// Optimization: remove trailing empty lines
 	StringOp::trimRight(text, " \n");
 	if (text.empty()) return SDLSurfacePtr(nullptr);
@@ -155,13 +387,52 @@ SDLSurfacePtr TTFFont::render(std::string text, byte r, byte g, byte b) const
 	auto lines = StringOp::split(text, '\n');
 	assert(!lines.empty());
 
+	auto& atlas = TTFFontPool::instance().getAtlas(static_cast<TTF_Font*>(font));
+	std::vector<GlyphAtlas::Layout> layouts(lines.size());
+	unsigned width = 0;
+	for (auto i : xrange(lines.size())) {
+		if (!atlas.layout(lines[i], layouts[i])) {
+			++GlyphAtlas::fallbacks;
+			return renderSDLTTF(lines, r, g, b);
+		}
+		width = std::max(width, layouts[i].getWidth());
+	}
+	if (width == 0) return SDLSurfacePtr(nullptr); // only whitespace
+
+	// There might be extra space between two successive lines
+	// (so lineSkip might be bigger than the font height).
+	unsigned lineSkip = getHeight();
+	// For the last line we don't include spacing between two lines.
+	auto height = unsigned((lines.size() - 1) * lineSkip + atlas.getHeight());
+
+	// Create destination surface, initially fully transparent (but already
+	// in the text color, like TTF_RenderUTF8_Blended() does).
+	SDLSurfacePtr destination(SDL_CreateRGBSurface(SDL_SWSURFACE, width, height,
+			32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000));
+	if (!destination) {
+		throw MSXException("Couldn't allocate surface for text.");
+	}
+	uint32_t pixel = (r << 16) | (g << 8) | (b << 0);
+	SDL_FillRect(destination.get(), nullptr, pixel);
+
+	for (auto i : xrange(lines.size())) {
+		atlas.draw(layouts[i], *destination, int(i * lineSkip), pixel);
+	}
+	return destination;
+}
+
+SDLSurfacePtr TTFFont::renderSDLTTF(
+	const std::vector<string_view>& lines, byte r, byte g, byte b) const
+{
+	SDL_Color color = { r, g, b, 0 };
+
 	if (lines.size() == 1) {
 		// Special case for a single line: we can avoid the
 		// copy to an extra SDL_Surface
-		assert(!text.empty());
+		assert(!lines[0].empty());
 		SDLSurfacePtr surface(
 			TTF_RenderUTF8_Blended(static_cast<TTF_Font*>(font),
-			                       text.c_str(), color));
+			                       lines[0].str().c_str(), color));
 		if (!surface) {
 			throw MSXException(TTF_GetError());
 		}
@@ -241,6 +512,16 @@ unsigned TTFFont::getWidth() const
 void TTFFont::getSize(const std::string& text,
                       unsigned& width, unsigned& height) const
 {
+	if (text.find('\n') == std::string::npos) {
+		auto& atlas = TTFFontPool::instance().getAtlas(
+			static_cast<TTF_Font*>(font));
+		GlyphAtlas::Layout layout;
+		if (atlas.layout(text, layout)) {
+			width = layout.getWidth();
+			height = atlas.getHeight();
+			return;
+		}
+	}
 	if (TTF_SizeUTF8(static_cast<TTF_Font*>(font), text.c_str(),
 	                 reinterpret_cast<int*>(&width),
 	                 reinterpret_cast<int*>(&height))) {
@@ -248,4 +529,26 @@ void TTFFont::getSize(const std::string& text,
 	}
 }
 
+void TTFFont::getCacheInfo(TclObject& result)
+{
+	size_t fonts, glyphs, memory;
+	TTFFontPool::instance().getAtlasInfo(fonts, glyphs, memory);
+	auto lookups = GlyphAtlas::hits + GlyphAtlas::misses;
+	auto toInt = [](uint64_t x) { return int(std::min<uint64_t>(x, 0x7FFFFFFF)); };
+	result.addListElement("fonts");
+	result.addListElement(toInt(fonts));
+	result.addListElement("glyphs");
+	result.addListElement(toInt(glyphs));
+	result.addListElement("memory");
+	result.addListElement(toInt(memory));
+	result.addListElement("hits");
+	result.addListElement(toInt(GlyphAtlas::hits));
+	result.addListElement("misses");
+	result.addListElement(toInt(GlyphAtlas::misses));
+	result.addListElement("hitrate");
+	result.addListElement(lookups ? double(GlyphAtlas::hits) / lookups : 0.0);
+	result.addListElement("fallbacks");
+	result.addListElement(toInt(GlyphAtlas::fallbacks));
+}
+
 } // namespace openmsx
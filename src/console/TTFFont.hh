@@ -3,11 +3,15 @@
 
 #include "SDLSurfacePtr.hh"
 #include "openmsx.hh"
+#include "string_view.hh"
 #include <algorithm>
 #include <string>
+#include <vector>
 
 namespace openmsx {
 
+class TclObject;
+
 class TTFFont
 {
 public:
@@ -51,6 +55,8 @@ public:
 	/** Render the given text to a new SDL_Surface.
 	  * The text must be UTF-8 encoded.
 	  * The result is a 32bpp RGBA SDL_Surface.
+	  * The glyphs are cached (per font), so only new characters have to
+	  * be rendered by SDL_ttf.
 	  */
 	SDLSurfacePtr render(std::string text, byte r, byte g, byte b) const;
 
@@ -72,7 +78,15 @@ public:
 	 */
 	void getSize(const std::string& text, unsigned& width, unsigned& height) const;
 
+	/** Statistics of the glyph cache (of all fonts), as a dictionary.
+	  * See 'openmsx_info font_cache'.
+	  */
+	static void getCacheInfo(TclObject& result);
+
 private:
+	SDLSurfacePtr renderSDLTTF(const std::vector<string_view>& lines,
+	                           byte r, byte g, byte b) const;
+
 	void* font;  // TTF_Font*
 };
 
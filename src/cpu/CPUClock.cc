@@ -5,6 +5,7 @@ namespace openmsx {
 
 CPUClock::CPUClock(EmuTime::param time, Scheduler& scheduler_)
 	: clock(time)
+	, totalCycles(0)
 	, scheduler(scheduler_)
 	, remaining(-1), limit(-1), limitEnabled(false)
 {
@@ -12,8 +13,11 @@ CPUClock::CPUClock(EmuTime::param time, Scheduler& scheduler_)
 
 void CPUClock::advanceTime(EmuTime::param time)
 {
-	remaining = limit;
+	sync();
+	// also count the waited cycles, see getCyclesFast()
+	uint64_t ticks = clock.getTotalTicks();
 	clock.advance(time);
+	totalCycles += clock.getTotalTicks() - ticks;
 	setLimit(scheduler.getNext());
 }
 
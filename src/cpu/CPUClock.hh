@@ -20,16 +20,21 @@ protected:
 // when using the following code:
 #if 0
 	// 64-bit addition is cheap
-	inline void add(unsigned ticks) { clock += ticks; }
+	inline void add(unsigned ticks) { clock += ticks; totalCycles += ticks; }
 	inline void sync() const { }
+	uint64_t getCyclesFast() const { return totalCycles; }
 #else
 	// 64-bit addition is expensive
 	// (if executed several million times per second)
 	inline void add(unsigned ticks) { remaining -= ticks; }
 	inline void sync() const {
 		clock.fastAdd(limit - remaining);
+		totalCycles += limit - remaining;
 		limit = remaining;
 	}
+	/** Number of executed cycles, only meaningful as the difference
+	  * between two calls (used by the profiler). */
+	uint64_t getCyclesFast() const { return totalCycles + (limit - remaining); }
 #endif
 
 	// These are similar to the corresponding methods in DynamicClock.
@@ -55,6 +60,7 @@ protected:
 		unsigned ticks = clock.getTicksTillUp(time);
 		unsigned halts = (ticks + hltStates - 1) / hltStates; // round up
 		clock += halts * hltStates;
+		totalCycles += halts * hltStates;
 		return halts;
 	}
 
@@ -119,6 +125,7 @@ protected:
 
 private:
 	mutable DynamicClock clock;
+	mutable uint64_t totalCycles; // see getCyclesFast()
 	Scheduler& scheduler;
 	int remaining;
 	mutable int limit;
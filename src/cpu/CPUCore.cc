@@ -165,14 +165,16 @@
 #include "CliComm.hh"
 #include "TclCallback.hh"
 #include "Dasm.hh"
+#include "CPUTraceBuffer.hh"
+#include "CPUProfiler.hh"
 #include "Z80.hh"
 #include "R800.hh"
-#include "Thread.hh"
 #include "cstd.hh"
 #include "endian.hh"
 #include "likely.hh"
 #include "inline.hh"
 #include "unreachable.hh"
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <type_traits>
@@ -300,6 +302,7 @@ struct CondTrue { bool operator()(byte /*f*/) const { return true; } };
 template<class T> CPUCore<T>::CPUCore(
 		MSXMotherBoard& motherboard_, const string& name,
 		const BooleanSetting& traceSetting_,
+		CPUTraceBuffer& traceBuffer_, CPUProfiler& profiler_,
 		TclCallback& diHaltCallback_, EmuTime::param time)
 	: CPURegs(T::isR800())
 	, T(time, motherboard_.getScheduler())
@@ -307,6 +310,8 @@ template<class T> CPUCore<T>::CPUCore(
 	, scheduler(motherboard.getScheduler())
 	, interface(nullptr)
 	, traceSetting(traceSetting_)
+	, traceBuffer(traceBuffer_)
+	, profiler(profiler_)
 	, diHaltCallback(diHaltCallback_)
 	, IRQStatus(motherboard.getDebugger(), name + ".pendingIRQ",
 	            "Non-zero if there are pending IRQs (thus CPU would enter "
@@ -326,9 +331,12 @@ template<class T> CPUCore<T>::CPUCore(
 		T::CLOCK_FREQ, 1000000, 1000000000)
 	, freq(T::CLOCK_FREQ)
 	, NMIStatus(0)
+	, instructionCount(0)
 	, nmiEdge(false)
 	, exitLoop(false)
-	, tracingEnabled(traceSetting.getBoolean())
+	, tracingEnabled(traceSetting.getBoolean() || traceBuffer.isEnabled())
+	, profilingEnabled(profiler.isEnabled())
+	, profilingMemory(profiler.isMemoryEnabled())
 	, isTurboR(motherboard.isTurboR())
 {
 	static_assert(!std::is_polymorphic<CPUCore<T>>::value,
@@ -356,6 +364,40 @@ template<class T> void CPUCore<T>::invalidateMemCache(unsigned start, unsigned s
 	memset(&writeCacheLine [first], 0, num * sizeof(byte*)); //
 	memset(&readCacheTried [first], 0, num * sizeof(bool));  // FALSE
 	memset(&writeCacheTried[first], 0, num * sizeof(bool));  //
+	memset(&readWatchLine  [first], 0, num * sizeof(byte*)); // nullptr
+	memset(&writeWatchLine [first], 0, num * sizeof(byte*)); //
+}
+
+template<class T> void CPUCore<T>::fillMemCache(
+	unsigned start, unsigned size, const byte* rData, byte* wData)
+{
+	assert((start & CacheLine::LOW) == 0);
+	assert((size  & CacheLine::LOW) == 0);
+	if (unlikely(profilingMemory)) {
+		// the profiler must see all memory accesses
+		invalidateMemCache(start, size);
+		return;
+	}
+	unsigned first = start / CacheLine::SIZE;
+	unsigned num = size / CacheLine::SIZE;
+	// All lines point into the same block, so they all get the same base
+	// adjusted pointer (see RDMEMslow()).
+	if (rData) {
+		std::fill_n(&readCacheLine[first], num, rData - start);
+		std::fill_n(&readCacheTried[first], num, true);
+	} else {
+		memset(&readCacheLine [first], 0, num * sizeof(byte*));
+		memset(&readCacheTried[first], 0, num * sizeof(bool));
+	}
+	if (wData) {
+		std::fill_n(&writeCacheLine[first], num, wData - start);
+		std::fill_n(&writeCacheTried[first], num, true);
+	} else {
+		memset(&writeCacheLine [first], 0, num * sizeof(byte*));
+		memset(&writeCacheTried[first], 0, num * sizeof(bool));
+	}
+	memset(&readWatchLine [first], 0, num * sizeof(byte*));
+	memset(&writeWatchLine[first], 0, num * sizeof(byte*));
 }
 
 template<class T> void CPUCore<T>::doReset(EmuTime::param time)
@@ -429,7 +471,7 @@ template<class T> void CPUCore<T>::exitCPULoopAsync()
 }
 template<class T> void CPUCore<T>::exitCPULoopSync()
 {
-	assert(Thread::isMainThread());
+	assert(scheduler.isOwnThread());
 	exitLoop = true;
 	T::disableLimit();
 }
@@ -560,10 +602,21 @@ template<class T> void CPUCore<T>::update(const Setting& setting)
 	} else if (&setting == &freqValue) {
 		doSetFreq();
 	} else if (&setting == &traceSetting) {
-		tracingEnabled = traceSetting.getBoolean();
+		updateTracing();
 	}
 }
 
+template<class T> void CPUCore<T>::updateTracing()
+{
+	tracingEnabled = traceSetting.getBoolean() || traceBuffer.isEnabled();
+}
+
+template<class T> void CPUCore<T>::updateProfiling()
+{
+	profilingEnabled = profiler.isEnabled();
+	profilingMemory  = profiler.isMemoryEnabled();
+}
+
 template<class T> void CPUCore<T>::setFreq(unsigned freq_)
 {
 	freq = freq_;
@@ -604,15 +657,31 @@ NEVER_INLINE byte CPUCore<T>::RDMEMslow(unsigned address, unsigned cc)
 {
 	// not cached
 	unsigned high = address >> CacheLine::BITS;
-	if (!readCacheTried[high]) {
-		// try to cache now
-		unsigned addrBase = address & CacheLine::HIGH;
-		if (const byte* line = interface->getReadCacheLine(addrBase)) {
-			// cached ok
-			T::template PRE_MEM<PRE_PB, POST_PB>(address);
-			T::template POST_MEM<       POST_PB>(address);
-			readCacheLine[high] = line - addrBase;
-			return readCacheLine[high][address];
+	if (unlikely(profilingMemory)) {
+		// count every access, so don't (try to) cache
+		profiler.read(*interface, address);
+	} else {
+		if (!readCacheTried[high]) {
+			// try to cache now
+			unsigned addrBase = address & CacheLine::HIGH;
+			if (const byte* line = interface->getReadCacheLine(addrBase)) {
+				// cached ok
+				T::template PRE_MEM<PRE_PB, POST_PB>(address);
+				T::template POST_MEM<       POST_PB>(address);
+				readCacheLine[high] = line - addrBase;
+				return readCacheLine[high][address];
+			}
+			const byte* line = interface->getReadCacheLineWatched(addrBase);
+			readWatchLine[high] = line ? (line - addrBase) : nullptr;
+			readCacheTried[high] = true;
+		}
+		if (const byte* line = readWatchLine[high]) {
+			if (!interface->isReadWatched(address)) {
+				// not watched byte in a line with watchpoints
+				T::template PRE_MEM<PRE_PB, POST_PB>(address);
+				T::template POST_MEM<       POST_PB>(address);
+				return line[address];
+			}
 		}
 	}
 	// uncacheable
@@ -707,16 +776,33 @@ NEVER_INLINE void CPUCore<T>::WRMEMslow(unsigned address, byte value, unsigned c
 {
 	// not cached
 	unsigned high = address >> CacheLine::BITS;
-	if (!writeCacheTried[high]) {
-		// try to cache now
-		unsigned addrBase = address & CacheLine::HIGH;
-		if (byte* line = interface->getWriteCacheLine(addrBase)) {
-			// cached ok
-			T::template PRE_MEM<PRE_PB, POST_PB>(address);
-			T::template POST_MEM<       POST_PB>(address);
-			writeCacheLine[high] = line - addrBase;
-			writeCacheLine[high][address] = value;
-			return;
+	if (unlikely(profilingMemory)) {
+		// count every access, so don't (try to) cache
+		profiler.write(*interface, address);
+	} else {
+		if (!writeCacheTried[high]) {
+			// try to cache now
+			unsigned addrBase = address & CacheLine::HIGH;
+			if (byte* line = interface->getWriteCacheLine(addrBase)) {
+				// cached ok
+				T::template PRE_MEM<PRE_PB, POST_PB>(address);
+				T::template POST_MEM<       POST_PB>(address);
+				writeCacheLine[high] = line - addrBase;
+				writeCacheLine[high][address] = value;
+				return;
+			}
+			byte* line = interface->getWriteCacheLineWatched(addrBase);
+			writeWatchLine[high] = line ? (line - addrBase) : nullptr;
+			writeCacheTried[high] = true;
+		}
+		if (byte* line = writeWatchLine[high]) {
+			if (!interface->isWriteWatched(address)) {
+				// not watched byte in a line with watchpoints
+				T::template PRE_MEM<PRE_PB, POST_PB>(address);
+				T::template POST_MEM<       POST_PB>(address);
+				line[address] = value;
+				return;
+			}
 		}
 	}
 	// uncacheable
@@ -913,6 +999,8 @@ void CPUCore<T>::executeInstructions()
 	T::R800Refresh(*this); \
 	if (likely(!T::limitReached())) { \
 		incR(1); \
+		++instructionCount; \
+		profileInstruction(); \
 		unsigned address = getPC(); \
 		const byte* line = readCacheLine[address >> CacheLine::BITS]; \
 		if (likely(line != nullptr)) { \
@@ -977,8 +1065,10 @@ void CPUCore<T>::executeInstructions()
 start:
 #endif
 	unsigned ixy; // for dd_cb/fd_cb
+	profileInstruction();
 	byte opcodeMain = RDMEM_OPCODE<0>(T::CC_MAIN);
 	incR(1);
+	++instructionCount;
 #ifdef USE_COMPUTED_GOTO
 	goto *(opcodeTable[opcodeMain]);
 
@@ -1567,9 +1657,11 @@ CASE(ED) {
 		case 0xf0: case 0xf1: case 0xf2:
 		case 0xf4: case 0xf5: case 0xf6: case 0xf7:
 		case 0xf8: case 0xf9: case 0xfa: case 0xfb:
-		case 0xfc: case 0xfd: case 0xfe: case 0xff:
+		case 0xfc: case 0xfd:            case 0xff:
 		           { II ii = nop(); NEXT; }
 
+		case 0xfe: { II ii = trap(); NEXT; }
+
 		case 0x40: { II ii = in_R_c<B>(); NEXT; }
 		case 0x48: { II ii = in_R_c<C>(); NEXT; }
 		case 0x50: { II ii = in_R_c<D>(); NEXT; }
@@ -2463,6 +2555,9 @@ xx_cb: {
 template<class T> inline void CPUCore<T>::cpuTracePre()
 {
 	start_pc = getPC();
+	if (unlikely(tracingEnabled)) {
+		cpuTracePre_slow();
+	}
 }
 template<class T> inline void CPUCore<T>::cpuTracePost()
 {
@@ -2470,8 +2565,42 @@ template<class T> inline void CPUCore<T>::cpuTracePost()
 		cpuTracePost_slow();
 	}
 }
+template<class T> inline void CPUCore<T>::profileInstruction()
+{
+	if (unlikely(profilingEnabled)) {
+		profiler.instruction(*interface, getPC(), T::getCyclesFast());
+	}
+}
+template<class T> void CPUCore<T>::cpuTracePre_slow()
+{
+	if (!traceBuffer.isEnabled()) return;
+
+	// Record the instruction bytes and the slot before the instruction
+	// is executed, it might change them.
+	auto& e = traceBuffer.add();
+	e.pc = start_pc;
+	for (unsigned i = 0; i < 4; ++i) {
+		unsigned address = (start_pc + i) & 0xFFFF;
+		const byte* line = readCacheLine[address >> CacheLine::BITS];
+		e.opcode[i] = line ? line[address]
+		                   : interface->peekMem(address, T::getTimeFast());
+	}
+	int page = start_pc >> 14;
+	byte ps = interface->getPrimarySlot(page);
+	e.slot = interface->isExpanded(ps)
+	       ? (0x80 | (interface->getSecondarySlot(page) << 2) | ps)
+	       : ps;
+}
 template<class T> void CPUCore<T>::cpuTracePost_slow()
 {
+	if (traceBuffer.isEnabled()) {
+		auto& e = traceBuffer.getLast();
+		e.time = T::getTimeFast();
+		e.af = getAF(); e.bc = getBC(); e.de = getDE(); e.hl = getHL();
+		e.ix = getIX(); e.iy = getIY(); e.sp = getSP();
+	}
+	if (!traceSetting.getBoolean()) return;
+
 	byte opbuf[4];
 	string dasmOutput;
 	dasm(*interface, start_pc, opbuf, dasmOutput, T::getTimeFast());
@@ -2565,6 +2694,10 @@ template<class T> void CPUCore<T>::execute(bool fastForward)
 	}
 	execute2(fastForward);
 	interface->setFastForward(false);
+	if (profilingEnabled) {
+		// don't count the time till the next execute() call
+		profiler.flush(T::getCyclesFast());
+	}
 }
 
 template<class T> void CPUCore<T>::execute2(bool fastForward)
@@ -4177,6 +4310,21 @@ template<class T> II CPUCore<T>::otir() { return BLOCK_OUT( 1, true ); }
 
 // various
 template<class T> II CPUCore<T>::nop() { return {1, T::CC_NOP}; }
+
+// ED FE: a NOP on a real Z80/R800, used as emulator trap
+// (see MSXCPUInterface::registerTrap())
+template<class T> II CPUCore<T>::trap() {
+	unsigned pc = getPC(); // points to the FE byte
+	EmuTime time = T::getTimeFast(T::CC_NOP);
+	scheduler.schedule(time);
+	interface->executeTrap(pc - 1, time);
+	if (getPC() != pc) {
+		// the trap handler jumped elsewhere
+		T::R800ForcePageBreak();
+		return {0, T::CC_NOP};
+	}
+	return {1, T::CC_NOP};
+}
 template<class T> II CPUCore<T>::ccf() {
 	byte f = 0;
 	if (T::isR800()) {
@@ -4297,7 +4445,7 @@ template<class T> II CPUCore<T>::halt() {
 	setHALT(true);
 	setSlowInstructions();
 
-	if (!(getIFF1() || getIFF2())) {
+	if (!(getIFF1() || getIFF2()) && !motherboard.isHidden()) {
 		diHaltCallback.execute();
 	}
 	return {1, T::CC_HALT};
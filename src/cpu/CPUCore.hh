@@ -17,6 +17,8 @@
 namespace openmsx {
 
 class MSXCPUInterface;
+class CPUTraceBuffer;
+class CPUProfiler;
 class Scheduler;
 class MSXMotherBoard;
 class TclCallback;
@@ -46,6 +48,7 @@ class CPUCore final : public CPUBase, public CPURegs, public CPU_POLICY
 public:
 	CPUCore(MSXMotherBoard& motherboard, const std::string& name,
 	        const BooleanSetting& traceSetting,
+	        CPUTraceBuffer& traceBuffer, CPUProfiler& profiler,
 	        TclCallback& diHaltCallback, EmuTime::param time);
 
 	void setInterface(MSXCPUInterface* interf) { interface = interf; }
@@ -75,12 +78,19 @@ public:
 	EmuTime waitCycles(EmuTime::param time, unsigned cycles);
 	void setNextSyncPoint(EmuTime::param time);
 	void invalidateMemCache(unsigned start, unsigned size);
+	void fillMemCache(unsigned start, unsigned size,
+	                  const byte* rData, byte* wData);
 	bool isM1Cycle(unsigned address) const;
 
 	void disasmCommand(Interpreter& interp,
 	                   array_ref<TclObject> tokens,
                            TclObject& result) const;
 
+	/** Should be called after the trace buffer is enabled or disabled. */
+	void updateTracing();
+	/** Should be called after the profiler is started or stopped. */
+	void updateProfiling();
+
 	/**
 	 * Raises the maskable interrupt count.
 	 * Devices should call MSXCPU::raiseIRQ instead, or use the IRQHelper class.
@@ -110,6 +120,13 @@ public:
 	 */
 	void setFreq(unsigned freq);
 
+	/**
+	 * Number of executed instructions (prefixed instructions count as one
+	 * instruction). Only meant for statistics (e.g. the benchmark script),
+	 * this is not part of the savestate.
+	 */
+	uint64_t getInstructionCount() const { return instructionCount; }
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -127,12 +144,18 @@ private:
 	byte* writeCacheLine[CacheLine::NUM];
 	bool readCacheTried [CacheLine::NUM];
 	bool writeCacheTried[CacheLine::NUM];
+	// Lines that are only uncacheable because they contain memory
+	// watchpoints: the unwatched bytes can still be accessed directly.
+	const byte* readWatchLine [CacheLine::NUM];
+	byte* writeWatchLine[CacheLine::NUM];
 
 	MSXMotherBoard& motherboard;
 	Scheduler& scheduler;
 	MSXCPUInterface* interface;
 
 	const BooleanSetting& traceSetting;
+	CPUTraceBuffer& traceBuffer;
+	CPUProfiler& profiler;
 	TclCallback& diHaltCallback;
 
 	Probe<int> IRQStatus;
@@ -147,6 +170,8 @@ private:
 	int slowInstructions;
 	int NMIStatus;
 
+	uint64_t instructionCount;
+
 	/**
 	 * Set to true when there was a rising edge on the NMI line
 	 * (rising = non-active -> active).
@@ -156,8 +181,11 @@ private:
 
 	std::atomic<bool> exitLoop;
 
-	/** In sync with traceSetting.getBoolean(). */
+	/** In sync with traceSetting.getBoolean() || traceBuffer.isEnabled(). */
 	bool tracingEnabled;
+	/** In sync with profiler.isEnabled() and profiler.isMemoryEnabled(). */
+	bool profilingEnabled;
+	bool profilingMemory;
 
 	/** 'normal' Z80 and Z80 in a turboR behave slightly different */
 	const bool isTurboR;
@@ -165,7 +193,9 @@ private:
 
 	inline void cpuTracePre();
 	inline void cpuTracePost();
+	void cpuTracePre_slow();
 	void cpuTracePost_slow();
+	inline void profileInstruction();
 
 	inline byte READ_PORT(unsigned port, unsigned cc);
 	inline void WRITE_PORT(unsigned port, byte value, unsigned cc);
@@ -447,6 +477,7 @@ private:
 	inline II otir();
 
 	inline II nop();
+	inline II trap();
 	inline II ccf();
 	inline II cpl();
 	inline II daa();
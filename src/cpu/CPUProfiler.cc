@@ -0,0 +1,150 @@
+#include "CPUProfiler.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMapperIO.hh"
+#include "MSXDevice.hh"
+#include "Debugger.hh"
+#include "Debuggable.hh"
+#include "File.hh"
+#include "strCat.hh"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using std::string;
+
+namespace openmsx {
+
+CPUProfiler::CPUProfiler(Debugger& debugger_)
+	: debugger(debugger_)
+	, lastCounters(nullptr), lastCycles(0)
+	, enabled(false), memoryEnabled(false)
+{
+	invalidate(0x0000, 0x10000);
+}
+
+CPUProfiler::~CPUProfiler() = default;
+
+void CPUProfiler::start(bool memory)
+{
+	enabled = true;
+	memoryEnabled = memory;
+	lastCounters = nullptr;
+	invalidate(0x0000, 0x10000);
+}
+
+void CPUProfiler::stop()
+{
+	enabled = false;
+	memoryEnabled = false;
+	lastCounters = nullptr;
+}
+
+void CPUProfiler::clear()
+{
+	counters.clear();
+	lastCounters = nullptr;
+	invalidate(0x0000, 0x10000);
+}
+
+void CPUProfiler::invalidate(unsigned start, unsigned size)
+{
+	unsigned first = start / CacheLine::SIZE;
+	unsigned num = (size + CacheLine::SIZE - 1) / CacheLine::SIZE;
+	std::fill_n(&lines[first], num, nullptr);
+	for (unsigned page = start >> 14; page <= (start + size - 1) >> 14; ++page) {
+		pages[page].device = nullptr;
+	}
+}
+
+CPUProfiler::Counters* CPUProfiler::lookup(
+	MSXCPUInterface& interface, unsigned address)
+{
+	int page = address >> 14;
+	byte ps = interface.getPrimarySlot(page);
+	unsigned slot = interface.isExpanded(ps)
+	              ? (0x80 | (interface.getSecondarySlot(page) << 2) | ps)
+	              : ps;
+	unsigned lineNr = address >> CacheLine::BITS;
+	auto& c = counters[Key(slot, getSegment(interface, address), lineNr)];
+	if (!c) c = std::make_unique<Counters[]>(CacheLine::SIZE); // zeroed
+	Counters* line = c.get() - (lineNr << CacheLine::BITS);
+	// Only remember cacheable memory: for that a segment switch always
+	// invalidates the line (see MSXCPUInterface::fillMemCache()), other
+	// devices may switch without telling the CPU.
+	if (interface.getReadCacheLine(address & CacheLine::HIGH)) {
+		lines[lineNr] = line;
+	}
+	return line;
+}
+
+int CPUProfiler::getSegment(MSXCPUInterface& interface, unsigned address)
+{
+	int page = address >> 14;
+	auto& p = pages[page];
+	const MSXDevice* device = &interface.getVisibleDevice(page);
+	if (p.device != device) {
+		p.device = device;
+		p.mapper = dynamic_cast<const MSXMemoryMapperInterface*>(device);
+		p.romBlocks = p.mapper ? nullptr : debugger.findDebuggable(
+			device->getName() + " romblocks");
+	}
+	if (p.mapper) {
+		return p.mapper->getSelectedSegment(page);
+	} else if (p.romBlocks) {
+		byte block = p.romBlocks->read(address);
+		return (block == 255) ? -1 : block; // 255: nothing mapped
+	} else {
+		return -1;
+	}
+}
+
+void CPUProfiler::save(const string& filename, bool json) const
+{
+	std::vector<Record> records;
+	for (auto& p : counters) {
+		unsigned slot = std::get<0>(p.first);
+		unsigned base = std::get<2>(p.first) << CacheLine::BITS;
+		for (unsigned i = 0; i < CacheLine::SIZE; ++i) {
+			const auto& c = p.second[i];
+			if (!c.exec && !c.reads && !c.writes) continue;
+			records.push_back(Record{
+				uint16_t(base + i), int8_t(slot & 3),
+				int8_t((slot & 0x80) ? ((slot >> 2) & 3) : -1),
+				std::get<1>(p.first),
+				c.exec, c.cycles, c.reads, c.writes});
+		}
+	}
+
+	File file(filename, File::TRUNCATE);
+	if (json) {
+		string out = "{\n  \"counters\": [";
+		const char* sep = "\n";
+		for (auto& r : records) {
+			strAppend(out, sep,
+			          "    {\"ps\": ", int(r.ps),
+			          ", \"ss\": ", int(r.ss),
+			          ", \"segment\": ", r.segment,
+			          ", \"address\": ", r.address,
+			          ", \"exec\": ", r.exec,
+			          ", \"cycles\": ", r.cycles,
+			          ", \"reads\": ", r.reads,
+			          ", \"writes\": ", r.writes, '}');
+			sep = ",\n";
+		}
+		out += "\n  ]\n}\n";
+		file.write(out.data(), out.size());
+	} else {
+		struct Header {
+			char magic[8];
+			uint32_t recordSize;
+			uint32_t numRecords;
+		} header;
+		memcpy(header.magic, "oMSXPRF1", sizeof(header.magic));
+		header.recordSize = sizeof(Record);
+		header.numRecords = uint32_t(records.size());
+		file.write(&header, sizeof(header));
+		file.write(records.data(), records.size() * sizeof(Record));
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,135 @@
+#ifndef CPUPROFILER_HH
+#define CPUPROFILER_HH
+
+#include "CacheLine.hh"
+#include "likely.hh"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace openmsx {
+
+class MSXCPUInterface;
+class MSXDevice;
+class Debugger;
+class Debuggable;
+struct MSXMemoryMapperInterface;
+
+/** Counts for each memory location how often it was executed, read and
+  * written and how many CPU cycles were spent in the instructions at that
+  * location. The counters are kept separately per slot and per segment
+  * (of a memory mapper or a MegaROM), so code that is banked in at the
+  * same address isn't mixed up. See the 'debug profile' command.
+  *
+  * Reads and writes can only be counted when the CPU doesn't access
+  * memory via its cache (see CPUCore), so that's optional.
+  */
+class CPUProfiler
+{
+public:
+	struct Counters {
+		uint64_t exec;   // number of instructions started here
+		uint64_t cycles; // including HALT and interrupt acceptance
+		uint64_t reads;  // including instruction fetches
+		uint64_t writes;
+	};
+
+	explicit CPUProfiler(Debugger& debugger);
+	~CPUProfiler();
+
+	/** Start counting (memory: also count reads and writes), the
+	  * counters of a previous run are kept.
+	  */
+	void start(bool memory);
+	void stop();
+	void clear();
+	bool isEnabled() const { return enabled; }
+	bool isMemoryEnabled() const { return memoryEnabled; }
+
+	/** Called by CPUCore at the start of each instruction. */
+	inline void instruction(MSXCPUInterface& interface, unsigned pc,
+	                        uint64_t cycles)
+	{
+		if (lastCounters) lastCounters->cycles += cycles - lastCycles;
+		Counters* line = lines[pc >> CacheLine::BITS];
+		if (unlikely(!line)) line = lookup(interface, pc);
+		lastCounters = &line[pc];
+		lastCycles = cycles;
+		++lastCounters->exec;
+	}
+	/** Called by CPUCore when it stops executing instructions, so that
+	  * the time in between isn't counted. */
+	void flush(uint64_t cycles)
+	{
+		if (lastCounters) lastCounters->cycles += cycles - lastCycles;
+		lastCounters = nullptr;
+	}
+	/** Called by CPUCore for each (uncached) memory access. */
+	void read(MSXCPUInterface& interface, unsigned address)
+	{
+		Counters* line = lines[address >> CacheLine::BITS];
+		if (unlikely(!line)) line = lookup(interface, address);
+		++line[address].reads;
+	}
+	void write(MSXCPUInterface& interface, unsigned address)
+	{
+		Counters* line = lines[address >> CacheLine::BITS];
+		if (unlikely(!line)) line = lookup(interface, address);
+		++line[address].writes;
+	}
+
+	/** Must be called when the memory that's visible in the given range
+	  * changes (slot or segment switch), like MSXCPU::invalidateMemCache().
+	  */
+	void invalidate(unsigned start, unsigned size);
+
+	/** Write all non-zero counters to a file.
+	  * Binary format (host byte order): the 8 characters "oMSXPRF1",
+	  * uint32 record size, uint32 number of records, then the records
+	  * (see Record below). JSON format: an object with a "counters" array
+	  * that contains one object per record.
+	  * @throws MSXException When the file can't be written.
+	  */
+	void save(const std::string& filename, bool json) const;
+
+private:
+	struct Record {
+		uint16_t address;
+		int8_t ps;       // primary slot
+		int8_t ss;       // secondary slot, -1 if not expanded
+		int32_t segment; // -1 if unknown
+		uint64_t exec;
+		uint64_t cycles;
+		uint64_t reads;
+		uint64_t writes;
+	};
+	// (slot, segment, cache line number), slot like in Record but
+	// combined in one byte: bits 1-0 primary, 3-2 secondary, bit 7 set
+	// if expanded
+	using Key = std::tuple<unsigned, int, unsigned>;
+	struct Page {
+		const MSXDevice* device; // nullptr when unknown
+		const MSXMemoryMapperInterface* mapper;
+		Debuggable* romBlocks;
+	};
+
+	Counters* lookup(MSXCPUInterface& interface, unsigned address);
+	int getSegment(MSXCPUInterface& interface, unsigned address);
+
+	Debugger& debugger;
+	std::map<Key, std::unique_ptr<Counters[]>> counters;
+	// per cache line: the counters for the currently visible memory,
+	// base adjusted like CPUCore::readCacheLine, nullptr when not known
+	Counters* lines[CacheLine::NUM];
+	Page pages[4];
+	Counters* lastCounters; // counters of the current instruction
+	uint64_t lastCycles;    // cycle count at its start
+	bool enabled;
+	bool memoryEnabled;
+};
+
+} // namespace openmsx
+
+#endif
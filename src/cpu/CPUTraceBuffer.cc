@@ -0,0 +1,65 @@
+#include "CPUTraceBuffer.hh"
+#include "Dasm.hh"
+#include "strCat.hh"
+#include <algorithm>
+#include <cstdio>
+
+namespace openmsx {
+
+CPUTraceBuffer::CPUTraceBuffer()
+	: pos(0), last(0), wrapped(false)
+{
+}
+
+void CPUTraceBuffer::setSize(unsigned size)
+{
+	std::vector<Entry> tmp(
+		size, Entry{EmuTime::zero, 0, 0, 0, 0, 0, 0, 0, 0, {}, 0});
+	entries.swap(tmp); // also frees the memory when size is zero
+	clear();
+}
+
+void CPUTraceBuffer::clear()
+{
+	pos = 0;
+	last = 0;
+	wrapped = false;
+}
+
+std::string CPUTraceBuffer::dump(unsigned count) const
+{
+	count = std::min(count, getCount());
+	std::string result;
+	if (count == 0) return result;
+
+	std::string dasmOutput;
+	unsigned size = getSize();
+	unsigned i = (pos + size - count) % size;
+	for (unsigned n = 0; n < count; ++n, i = (i + 1) % size) {
+		const auto& e = entries[i];
+		dasmOutput.clear();
+		dasm(e.opcode, e.pc, dasmOutput);
+		// nanosecond precision, enough to distinguish instructions
+		char time[32];
+		snprintf(time, sizeof(time), "%.9f",
+		         (e.time - EmuTime::zero).toDouble());
+		strAppend(result, time, ' ', e.slot & 3);
+		if (e.slot & 0x80) {
+			strAppend(result, '-', (e.slot >> 2) & 3);
+		} else {
+			result += "  ";
+		}
+		strAppend(result,
+		          ' ', hex_string<4>(e.pc), " : ", dasmOutput,
+		          " AF=", hex_string<4>(e.af),
+		          " BC=", hex_string<4>(e.bc),
+		          " DE=", hex_string<4>(e.de),
+		          " HL=", hex_string<4>(e.hl),
+		          " IX=", hex_string<4>(e.ix),
+		          " IY=", hex_string<4>(e.iy),
+		          " SP=", hex_string<4>(e.sp), '\n');
+	}
+	return result;
+}
+
+} // namespace openmsx
@@ -0,0 +1,75 @@
+#ifndef CPUTRACEBUFFER_HH
+#define CPUTRACEBUFFER_HH
+
+#include "EmuTime.hh"
+#include "openmsx.hh"
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+/** Records the executed CPU instructions in a ring buffer. Unlike the
+  * 'cputrace' setting (which disassembles and prints each instruction),
+  * only the raw state is stored, so this has a lot less overhead. The
+  * instructions are only disassembled when the buffer is dumped, see the
+  * 'debug trace' command.
+  */
+class CPUTraceBuffer
+{
+public:
+	struct Entry {
+		EmuTime time;    // at the end of the instruction
+		word pc;         // address of the instruction
+		word af, bc, de, hl, ix, iy, sp; // after the instruction
+		byte opcode[4];  // instruction bytes (possibly more than needed)
+		byte slot;       // slot of the page of 'pc': bits 1-0 primary,
+		                 // bits 3-2 secondary, bit 7 set if expanded
+	};
+
+	CPUTraceBuffer();
+
+	/** Start recording in a buffer with the given number of entries, or
+	  * stop recording (and free the buffer) when 'size' is zero. This
+	  * empties the buffer.
+	  */
+	void setSize(unsigned size);
+	unsigned getSize() const { return unsigned(entries.size()); }
+	bool isEnabled() const { return !entries.empty(); }
+
+	/** Number of recorded entries (at most getSize()). */
+	unsigned getCount() const { return wrapped ? getSize() : pos; }
+
+	/** Start a new entry (overwrites the oldest entry when the buffer is
+	  * full). Only allowed while enabled.
+	  */
+	Entry& add()
+	{
+		Entry& e = entries[pos];
+		last = pos;
+		if (++pos == entries.size()) {
+			pos = 0;
+			wrapped = true;
+		}
+		return e;
+	}
+	/** The entry that was started by the last add() call. */
+	Entry& getLast() { return entries[last]; }
+
+	/** Remove all entries. */
+	void clear();
+
+	/** Disassemble the last (at most) 'count' entries, oldest first, one
+	  * line per instruction.
+	  */
+	std::string dump(unsigned count) const;
+
+private:
+	std::vector<Entry> entries;
+	unsigned pos;  // position of the next entry
+	unsigned last; // position of the last entry
+	bool wrapped;
+};
+
+} // namespace openmsx
+
+#endif
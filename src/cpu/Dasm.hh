@@ -21,6 +21,15 @@ class MSXCPUInterface;
 unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
               std::string& dest, EmuTime::param time);
 
+/** Disassemble an instruction of which the bytes are already known (e.g.
+  * because they were recorded while the instruction was executed).
+  * @param opcode The bytes of the instruction, 4 bytes is always enough
+  * @param pc The address of the instruction
+  * @param dest String representation of the disassembled opcode
+  * @return Length of the disassembled opcode in bytes
+  */
+unsigned dasm(const byte opcode[4], word pc, std::string& dest);
+
 } // namespace openmsx
 
 #endif
@@ -9,6 +9,7 @@
 #include "TclObject.hh"
 #include "outer.hh"
 #include "serialize.hh"
+#include "strCat.hh"
 #include "unreachable.hh"
 #include <cassert>
 #include <memory>
@@ -26,15 +27,17 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	, diHaltCallback(
 		motherboard.getCommandController(), "di_halt_callback",
 		"Tcl proc called when the CPU executed a DI/HALT sequence")
+	, profiler(motherboard.getDebugger())
 	, z80(std::make_unique<CPUCore<Z80TYPE>>(
-		motherboard, "z80", traceSetting,
+		motherboard, "z80", traceSetting, traceBuffer, profiler,
 		diHaltCallback, EmuTime::zero))
 	, r800(motherboard.isTurboR()
 		? std::make_unique<CPUCore<R800TYPE>>(
-			motherboard, "r800", traceSetting,
+			motherboard, "r800", traceSetting, traceBuffer, profiler,
 			diHaltCallback, EmuTime::zero)
 		: nullptr)
 	, timeInfo(motherboard.getMachineInfoCommand())
+	, instructionsInfo(motherboard.getMachineInfoCommand())
 	, z80FreqInfo(motherboard.getMachineInfoCommand(), "z80_freq", *z80)
 	, r800FreqInfo(r800
 		? std::make_unique<CPUFreqInfoTopic>(
@@ -146,10 +149,19 @@ void MSXCPU::updateVisiblePage(byte page, byte primarySlot, byte secondarySlot)
 
 void MSXCPU::invalidateMemCache(word start, unsigned size)
 {
+	profiler.invalidate(start, size);
 	z80Active ? z80 ->invalidateMemCache(start, size)
 	          : r800->invalidateMemCache(start, size);
 }
 
+void MSXCPU::fillMemCache(word start, unsigned size,
+                          const byte* rData, byte* wData)
+{
+	profiler.invalidate(start, size);
+	z80Active ? z80 ->fillMemCache(start, size, rData, wData)
+	          : r800->fillMemCache(start, size, rData, wData);
+}
+
 void MSXCPU::raiseIRQ()
 {
 	          z80 ->raiseIRQ();
@@ -226,6 +238,29 @@ void MSXCPU::disasmCommand(
 	          : r800->disasmCommand(interp, tokens, result);
 }
 
+void MSXCPU::setTraceBufferSize(unsigned size)
+{
+	traceBuffer.setSize(size);
+	          z80 ->updateTracing();
+	if (r800) r800->updateTracing();
+	// the CPU loop only checks for tracing when it's (re)started
+	exitCPULoopSync();
+}
+
+void MSXCPU::setProfiling(bool enable, bool memory)
+{
+	if (enable) {
+		profiler.start(memory);
+	} else {
+		profiler.stop();
+	}
+	          z80 ->updateProfiling();
+	if (r800) r800->updateProfiling();
+	// (re)fill the memory cache without or with the profiled accesses
+	invalidateMemCache(0x0000, 0x10000);
+	exitCPULoopSync();
+}
+
 void MSXCPU::setPaused(bool paused)
 {
 	if (z80Active) {
@@ -259,6 +294,30 @@ string MSXCPU::TimeInfoTopic::help(const vector<string>& /*tokens*/) const
 }
 
 
+// class InstructionsInfoTopic
+
+MSXCPU::InstructionsInfoTopic::InstructionsInfoTopic(
+		InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "instructions")
+{
+}
+
+void MSXCPU::InstructionsInfoTopic::execute(
+	array_ref<TclObject> /*tokens*/, TclObject& result) const
+{
+	auto& cpu = OUTER(MSXCPU, instructionsInfo);
+	uint64_t count = cpu.z80->getInstructionCount();
+	if (cpu.r800) count += cpu.r800->getInstructionCount();
+	result.setString(strCat(count));
+}
+
+string MSXCPU::InstructionsInfoTopic::help(const vector<string>& /*tokens*/) const
+{
+	return "Prints the number of instructions executed by the CPU (Z80 "
+	       "and R800 together) since this machine was created\n";
+}
+
+
 // class CPUFreqInfoTopic
 
 MSXCPU::CPUFreqInfoTopic::CPUFreqInfoTopic(
@@ -7,6 +7,8 @@
 #include "BooleanSetting.hh"
 #include "EmuTime.hh"
 #include "TclCallback.hh"
+#include "CPUTraceBuffer.hh"
+#include "CPUProfiler.hh"
 #include "serialize_meta.hh"
 #include "openmsx.hh"
 #include "array_ref.hh"
@@ -53,6 +55,15 @@ public:
 	  * method when a 'memory switch' occurs. */
 	void invalidateMemCache(word start, unsigned size);
 
+	/** Like invalidateMemCache(), but immediately fill in the cache for
+	  * the interval [start, start + size) with the given (contiguous)
+	  * memory blocks. A nullptr means that kind of access is not
+	  * cacheable (it's then invalidated). Should only be called via
+	  * MSXCPUInterface::fillMemCache(), which checks that the memory is
+	  * actually visible for the CPU. */
+	void fillMemCache(word start, unsigned size,
+	                  const byte* rData, byte* wData);
+
 	/** This method raises a maskable interrupt. A device may call this
 	  * method more than once. If the device wants to lower the
 	  * interrupt again it must call the lowerIRQ() method exactly as
@@ -103,6 +114,16 @@ public:
 	                   array_ref<TclObject> tokens,
                            TclObject& result) const;
 
+	/** Start (size != 0) or stop (size == 0) recording the executed
+	  * instructions in the trace buffer, see CPUTraceBuffer. */
+	void setTraceBufferSize(unsigned size);
+	CPUTraceBuffer& getTraceBuffer() { return traceBuffer; }
+
+	/** Start or stop the profiler, with 'memory' it also counts the
+	  * memory reads and writes (slower), see CPUProfiler. */
+	void setProfiling(bool enable, bool memory);
+	CPUProfiler& getProfiler() { return profiler; }
+
 	/** (un)pause CPU. During pause the CPU executes NOP instructions
 	  * continuously (just like during HALT). Used by turbor hw pause. */
 	void setPaused(bool paused);
@@ -135,7 +156,9 @@ private:
 
 	MSXMotherBoard& motherboard;
 	BooleanSetting traceSetting;
+	CPUTraceBuffer traceBuffer;
 	TclCallback diHaltCallback;
+	CPUProfiler profiler;
 	const std::unique_ptr<CPUCore<Z80TYPE>> z80;
 	const std::unique_ptr<CPUCore<R800TYPE>> r800; // can be nullptr
 
@@ -146,6 +169,13 @@ private:
 		std::string help (const std::vector<std::string>& tokens) const override;
 	} timeInfo;
 
+	struct InstructionsInfoTopic final : InfoTopic {
+		explicit InstructionsInfoTopic(InfoCommand& machineInfoCommand);
+		void execute(array_ref<TclObject> tokens,
+			     TclObject& result) const override;
+		std::string help (const std::vector<std::string>& tokens) const override;
+	} instructionsInfo;
+
 	class CPUFreqInfoTopic final : public InfoTopic {
 	public:
 		CPUFreqInfoTopic(InfoCommand& machineInfoCommand,
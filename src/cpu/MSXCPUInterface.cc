@@ -8,6 +8,7 @@
 #include "RealTime.hh"
 #include "MSXMotherBoard.hh"
 #include "MSXCPU.hh"
+#include "CPURegs.hh"
 #include "VDPIODelay.hh"
 #include "CliComm.hh"
 #include "MSXMultiIODevice.hh"
@@ -51,12 +52,6 @@ static std::unique_ptr<ReadOnlySetting> breakedSetting;
 static unsigned breakedSettingCount = 0;
 
 
-// Bitfields used in the disallowReadCache and disallowWriteCache arrays
-static const byte SECONDARY_SLOT_BIT = 0x01;
-static const byte MEMORY_WATCH_BIT   = 0x02;
-static const byte GLOBAL_RW_BIT      = 0x04;
-
-
 MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 	: memoryDebug       (motherBoard_)
 	, slottedMemoryDebug(motherBoard_)
@@ -188,9 +183,8 @@ byte MSXCPUInterface::readMemSlow(word address, EmuTime::param time)
 			}
 		}
 		// execute read watches before actual read
-		if (readWatchSet[address >> CacheLine::BITS]
-		                [address &  CacheLine::LOW]) {
-			executeMemWatch(WatchPoint::READ_MEM, address);
+		if (isReadWatched(address)) {
+			executeMemWatch(WatchPoint::READ_MEM, address, time);
 		}
 	}
 	if (unlikely((address == 0xFFFF) && isExpanded(primarySlotState[3]))) {
@@ -221,9 +215,8 @@ void MSXCPUInterface::writeMemSlow(word address, byte value, EmuTime::param time
 			}
 		}
 		// execute write watches after actual write
-		if (writeWatchSet[address >> CacheLine::BITS]
-		                 [address &  CacheLine::LOW]) {
-			executeMemWatch(WatchPoint::WRITE_MEM, address, value);
+		if (isWriteWatched(address)) {
+			executeMemWatch(WatchPoint::WRITE_MEM, address, time, value);
 		}
 	}
 }
@@ -584,6 +577,29 @@ void MSXCPUInterface::unregisterGlobalRead(MSXDevice& device, word address)
 	msxcpu.invalidateMemCache(address & CacheLine::HIGH, 0x100);
 }
 
+void MSXCPUInterface::registerTrap(MSXDevice& device, word address)
+{
+	traps.push_back({&device, address});
+}
+
+void MSXCPUInterface::unregisterTrap(MSXDevice& device, word address)
+{
+	GlobalRwInfo info = { &device, address };
+	move_pop_back(traps, rfind_unguarded(traps, info));
+}
+
+void MSXCPUInterface::executeTrap(word address, EmuTime::param time)
+{
+	for (auto& t : traps) {
+		if ((t.addr == address) &&
+		    (visibleDevices[address >> 14] == t.device)) {
+			t.device->executeTrap(address, time);
+			return;
+		}
+	}
+	// no trap registered here, acts as a NOP
+}
+
 ALWAYS_INLINE void MSXCPUInterface::updateVisible(int page, int ps, int ss)
 {
 	MSXDevice* newDevice = slotLayout[ps][ss][page];
@@ -768,6 +784,35 @@ void MSXCPUInterface::checkBreakPoints(
 }
 
 
+void MSXCPUInterface::fillMemCache(
+	const MSXDevice& device, word start_, unsigned size,
+	const byte* rData, byte* wData)
+{
+	unsigned start = start_;
+	unsigned end = start + size;
+	while (start < end) {
+		unsigned page = start >> 14;
+		unsigned pageEnd = std::min(end, (page + 1) * 0x4000);
+		unsigned num = pageEnd - start;
+		if (visibleDevices[page] != &device) {
+			// not visible (or only indirectly, e.g. via MultiMemDevice)
+			msxcpu.invalidateMemCache(start, num);
+		} else {
+			msxcpu.fillMemCache(start, num, rData, wData);
+			for (unsigned line = start >> CacheLine::BITS;
+			     line < (pageEnd >> CacheLine::BITS); ++line) {
+				if (disallowReadCache[line] | disallowWriteCache[line]) {
+					msxcpu.invalidateMemCache(
+						line << CacheLine::BITS, CacheLine::SIZE);
+				}
+			}
+		}
+		if (rData) rData += num;
+		if (wData) wData += num;
+		start = pageEnd;
+	}
+}
+
 void MSXCPUInterface::setWatchPoint(const shared_ptr<WatchPoint>& watchPoint)
 {
 	watchPoints.push_back(watchPoint);
@@ -897,31 +942,57 @@ void MSXCPUInterface::updateMemWatch(WatchPoint::Type type)
 }
 
 void MSXCPUInterface::executeMemWatch(WatchPoint::Type type,
-                                      unsigned address, unsigned value)
+                                      unsigned address, EmuTime::param time,
+                                      unsigned value)
 {
 	assert(!watchPoints.empty());
 	if (isFastForward()) return;
 
-	auto& globalCliComm = motherBoard.getReactor().getGlobalCliComm();
-	auto& interp        = motherBoard.getReactor().getInterpreter();
-	interp.setVariable(TclObject("wp_last_address"),
-	                   TclObject(int(address)));
-	if (value != ~0u) {
-		interp.setVariable(TclObject("wp_last_value"),
-		                   TclObject(int(value)));
-	}
-
-	auto wpCopy = watchPoints;
-	for (auto& w : wpCopy) {
+	// First the native actions, these don't need the Tcl interpreter.
+	bool anyTcl = false;
+	bool needBreak = false;
+	for (auto& w : watchPoints) {
 		if ((w->getBeginAddress() <= address) &&
 		    (w->getEndAddress()   >= address) &&
 		    (w->getType()         == type)) {
-			w->checkAndExecute(globalCliComm, interp);
+			if (w->getAction() == WatchPoint::TCL) {
+				anyTcl = true;
+			} else {
+				// for reads, log the value that will be read
+				byte v = (value != ~0u) ? value
+				       : ((w->getAction() == WatchPoint::LOG)
+				          ? peekMem(address, time) : 0);
+				word pc = msxcpu.getRegisters().getPC();
+				needBreak |= w->executeNative(address, v, pc, time);
+			}
+		}
+	}
+
+	if (anyTcl) {
+		auto& globalCliComm = motherBoard.getReactor().getGlobalCliComm();
+		auto& interp        = motherBoard.getReactor().getInterpreter();
+		interp.setVariable(TclObject("wp_last_address"),
+		                   TclObject(int(address)));
+		if (value != ~0u) {
+			interp.setVariable(TclObject("wp_last_value"),
+			                   TclObject(int(value)));
 		}
+
+		auto wpCopy = watchPoints;
+		for (auto& w : wpCopy) {
+			if ((w->getBeginAddress() <= address) &&
+			    (w->getEndAddress()   >= address) &&
+			    (w->getType()         == type) &&
+			    (w->getAction()       == WatchPoint::TCL)) {
+				w->checkAndExecute(globalCliComm, interp);
+			}
+		}
+
+		interp.unsetVariable("wp_last_address");
+		interp.unsetVariable("wp_last_value");
 	}
 
-	interp.unsetVariable("wp_last_address");
-	interp.unsetVariable("wp_last_value");
+	if (needBreak) doBreak();
 }
 
 
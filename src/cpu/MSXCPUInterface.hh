@@ -103,6 +103,19 @@ public:
 	void   registerGlobalRead(MSXDevice& device, word address);
 	void unregisterGlobalRead(MSXDevice& device, word address);
 
+	/** (Un)register an emulator trap. When the CPU executes the opcode
+	  * ED FE (a NOP on a real Z80 or R800) at the given address while the
+	  * device is visible at that address, the executeTrap() method of the
+	  * device gets called.
+	  * @see MSXDevice::executeTrap()
+	  */
+	void   registerTrap(MSXDevice& device, word address);
+	void unregisterTrap(MSXDevice& device, word address);
+
+	/** Called by the CPU when it executes ED FE, see registerTrap().
+	  */
+	void executeTrap(word address, EmuTime::param time);
+
 	/**
 	 * Reset (the slot state)
 	 */
@@ -183,6 +196,48 @@ public:
 		return visibleDevices[start >> 14]->getWriteCacheLine(start);
 	}
 
+	/**
+	 * Called by a device when it switched the memory that is visible in
+	 * the interval [start, start + size), for example a MegaROM mapper on
+	 * a bank switch. 'rData'/'wData' point to the newly visible memory
+	 * block for reading/writing (nullptr if not cacheable), so for each
+	 * cache line in the interval the device's getReadCacheLine() and
+	 * getWriteCacheLine() must return the corresponding position in that
+	 * block. Where the device is currently visible and nothing else
+	 * prevents caching, the CPU cache is directly filled in, elsewhere
+	 * the cache is only invalidated (see MSXCPU::invalidateMemCache()).
+	 */
+	void fillMemCache(const MSXDevice& device, word start, unsigned size,
+	                  const byte* rData, byte* wData);
+
+	/**
+	 * Like getReadCacheLine()/getWriteCacheLine(), but for a cache line
+	 * that is only uncacheable because it contains memory watchpoints.
+	 * The CPU may directly access the bytes in the returned buffer that
+	 * are not watched (see isReadWatched()/isWriteWatched()), so that only
+	 * accesses to the watched bytes themselves take the slow path.
+	 */
+	inline const byte* getReadCacheLineWatched(word start) const {
+		if (disallowReadCache[start >> CacheLine::BITS] != MEMORY_WATCH_BIT) {
+			return nullptr;
+		}
+		return visibleDevices[start >> 14]->getReadCacheLine(start);
+	}
+	inline byte* getWriteCacheLineWatched(word start) const {
+		if (disallowWriteCache[start >> CacheLine::BITS] != MEMORY_WATCH_BIT) {
+			return nullptr;
+		}
+		return visibleDevices[start >> 14]->getWriteCacheLine(start);
+	}
+	inline bool isReadWatched(word address) const {
+		return readWatchSet[address >> CacheLine::BITS]
+		                   [address &  CacheLine::LOW];
+	}
+	inline bool isWriteWatched(word address) const {
+		return writeWatchSet[address >> CacheLine::BITS]
+		                    [address &  CacheLine::LOW];
+	}
+
 	/**
 	 * CPU uses this method to read 'extra' data from the databus
 	 * used in interrupt routines. In MSX this returns always 255.
@@ -209,6 +264,12 @@ public:
 	void unsetExpanded(int ps);
 	void testUnsetExpanded(int ps, std::vector<MSXDevice*> allowed) const;
 	inline bool isExpanded(int ps) const { return expanded[ps] != 0; }
+
+	/** The primary/secondary slot that is selected in the given page. */
+	byte getPrimarySlot  (int page) const { return primarySlotState  [page]; }
+	byte getSecondarySlot(int page) const { return secondarySlotState[page]; }
+	/** The device that is visible in the given page. */
+	MSXDevice& getVisibleDevice(int page) const { return *visibleDevices[page]; }
 	void changeExpanded(bool newExpanded);
 
 	DummyDevice& getDummyDevice() { return *dummyDevice; }
@@ -295,7 +356,7 @@ private:
 	void unregisterIOWatch(WatchPoint& watchPoint, MSXDevice** devices);
 	void updateMemWatch(WatchPoint::Type type);
 	void executeMemWatch(WatchPoint::Type type, unsigned address,
-	                     unsigned value = ~0u);
+	                     EmuTime::param time, unsigned value = ~0u);
 
 	void doContinue2();
 
@@ -374,6 +435,11 @@ private:
 
 	std::unique_ptr<VDPIODelay> delayDevice; // can be nullptr
 
+	// Bitfields used in the disallowReadCache and disallowWriteCache arrays
+	static const byte SECONDARY_SLOT_BIT = 0x01;
+	static const byte MEMORY_WATCH_BIT   = 0x02;
+	static const byte GLOBAL_RW_BIT      = 0x04;
+
 	byte disallowReadCache [CacheLine::NUM];
 	byte disallowWriteCache[CacheLine::NUM];
 	std::bitset<CacheLine::SIZE> readWatchSet [CacheLine::NUM];
@@ -389,6 +455,7 @@ private:
 	};
 	std::vector<GlobalRwInfo> globalReads;
 	std::vector<GlobalRwInfo> globalWrites;
+	std::vector<GlobalRwInfo> traps;
 
 	MSXDevice* IO_In [256];
 	MSXDevice* IO_Out[256];
@@ -2,6 +2,8 @@
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
 #include "MSXCPUInterface.hh"
+#include "MSXCPU.hh"
+#include "CPURegs.hh"
 #include "TclObject.hh"
 #include "Interpreter.hh"
 #include <cassert>
@@ -31,11 +33,27 @@ MSXWatchIODevice& WatchIO::getDevice(byte port)
 	return *ios[port - begin];
 }
 
-void WatchIO::doReadCallback(unsigned port)
+void WatchIO::doNative(unsigned port, byte value, EmuTime::param time)
+{
+	word pc = motherboard.getCPU().getRegisters().getPC();
+	if (executeNative(port, value, pc, time)) {
+		motherboard.getCPUInterface().doBreak();
+	}
+}
+
+void WatchIO::doReadCallback(unsigned port, EmuTime::param time)
 {
 	auto& cpuInterface = motherboard.getCPUInterface();
 	if (cpuInterface.isFastForward()) return;
 
+	if (getAction() != TCL) {
+		// for LOG, log the value that will be read
+		byte value = (getAction() == LOG)
+		           ? getDevice(port).getDevicePtr()->peekIO(port, time) : 0;
+		doNative(port, value, time);
+		return;
+	}
+
 	auto& cliComm = motherboard.getReactor().getGlobalCliComm();
 	auto& interp  = motherboard.getReactor().getInterpreter();
 	interp.setVariable(TclObject("wp_last_address"), TclObject(int(port)));
@@ -48,11 +66,16 @@ void WatchIO::doReadCallback(unsigned port)
 	interp.unsetVariable("wp_last_address");
 }
 
-void WatchIO::doWriteCallback(unsigned port, unsigned value)
+void WatchIO::doWriteCallback(unsigned port, unsigned value, EmuTime::param time)
 {
 	auto& cpuInterface = motherboard.getCPUInterface();
 	if (cpuInterface.isFastForward()) return;
 
+	if (getAction() != TCL) {
+		doNative(port, value, time);
+		return;
+	}
+
 	auto& cliComm = motherboard.getReactor().getGlobalCliComm();
 	auto& interp  = motherboard.getReactor().getInterpreter();
 	interp.setVariable(TclObject("wp_last_address"), TclObject(int(port)));
@@ -94,7 +117,7 @@ byte MSXWatchIODevice::readIO(word port, EmuTime::param time)
 	assert(device);
 
 	// first trigger watchpoint, then read from device
-	watchIO.doReadCallback(port);
+	watchIO.doReadCallback(port, time);
 	return device->readIO(port, time);
 }
 
@@ -104,7 +127,7 @@ void MSXWatchIODevice::writeIO(word port, byte value, EmuTime::param time)
 
 	// first write to device, then trigger watchpoint
 	device->writeIO(port, value, time);
-	watchIO.doWriteCallback(port, value);
+	watchIO.doWriteCallback(port, value, time);
 }
 
 } // namespace openmsx
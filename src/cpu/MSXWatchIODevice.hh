@@ -22,8 +22,9 @@ public:
 	MSXWatchIODevice& getDevice(byte port);
 
 private:
-	void doReadCallback(unsigned port);
-	void doWriteCallback(unsigned port, unsigned value);
+	void doReadCallback(unsigned port, EmuTime::param time);
+	void doWriteCallback(unsigned port, unsigned value, EmuTime::param time);
+	void doNative(unsigned port, byte value, EmuTime::param time);
 
 	MSXMotherBoard& motherboard;
 	std::vector<std::unique_ptr<MSXWatchIODevice>> ios;
@@ -11,8 +11,35 @@ WatchPoint::WatchPoint(TclObject command_, TclObject condition_,
 	: BreakPointBase(command_, condition_)
 	, id((newId == unsigned(-1)) ? ++lastId : newId)
 	, beginAddr(beginAddr_), endAddr(endAddr_), type(type_)
+	, action(TCL), hits(0), logPos(0), logWrapped(false)
 {
 	assert(beginAddr <= endAddr);
 }
 
+void WatchPoint::setAction(Action action_, unsigned logSize)
+{
+	assert((action_ != LOG) || (logSize != 0));
+	action = action_;
+	log.assign((action == LOG) ? logSize : 0,
+	           LogEntry{EmuTime::zero, 0, 0, 0});
+	clearHits();
+}
+
+std::vector<WatchPoint::LogEntry> WatchPoint::getLog() const
+{
+	std::vector<LogEntry> result;
+	if (logWrapped) {
+		result.insert(result.end(), log.begin() + logPos, log.end());
+	}
+	result.insert(result.end(), log.begin(), log.begin() + logPos);
+	return result;
+}
+
+void WatchPoint::clearHits()
+{
+	hits = 0;
+	logPos = 0;
+	logWrapped = false;
+}
+
 } // namespace openmsx
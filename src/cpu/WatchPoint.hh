@@ -2,6 +2,9 @@
 #define WATCHPOINT_HH
 
 #include "BreakPointBase.hh"
+#include "EmuTime.hh"
+#include <cstdint>
+#include <vector>
 
 namespace openmsx {
 
@@ -14,6 +17,20 @@ class WatchPoint : public BreakPointBase
 public:
 	enum Type { READ_IO, WRITE_IO, READ_MEM, WRITE_MEM };
 
+	/** What to do when the watchpoint triggers. TCL evaluates the
+	  * condition and executes the command. The other actions are
+	  * performed natively (without involving the Tcl interpreter), this
+	  * is a lot faster for watchpoints that trigger very often.
+	  */
+	enum Action { TCL, COUNT, LOG, BREAK };
+
+	struct LogEntry {
+		EmuTime time;
+		word pc;
+		word address;
+		byte value;
+	};
+
 	/** Begin and end address are inclusive (IOW range = [begin, end])
 	 */
 	WatchPoint(TclObject command, TclObject condition,
@@ -26,12 +43,50 @@ public:
 	unsigned getBeginAddress() const { return beginAddr; }
 	unsigned getEndAddress()   const { return endAddr; }
 
+	/** Perform a native action instead of the Tcl command. For LOG,
+	  * 'logSize' is the number of entries in the ring buffer.
+	  */
+	void setAction(Action action, unsigned logSize = 0);
+	Action   getAction()  const { return action; }
+	unsigned getLogSize() const { return unsigned(log.size()); }
+
+	/** Perform the native action (must not be TCL).
+	  * @return true iff the CPU should break.
+	  */
+	bool executeNative(unsigned address, byte value, word pc,
+	                   EmuTime::param time)
+	{
+		++hits;
+		if (action == LOG) {
+			log[logPos] = LogEntry{time, pc, word(address), value};
+			if (++logPos == log.size()) {
+				logPos = 0;
+				logWrapped = true;
+			}
+		}
+		return action == BREAK;
+	}
+
+	/** Number of times a native action was performed. */
+	uint64_t getHitCount() const { return hits; }
+
+	/** The logged entries, oldest first. */
+	std::vector<LogEntry> getLog() const;
+	/** Reset the hit counter and empty the log. */
+	void clearHits();
+
 private:
 	unsigned id;
 	unsigned beginAddr;
 	unsigned endAddr;
 	Type type;
 
+	Action action;
+	uint64_t hits;
+	std::vector<LogEntry> log; // ring buffer, only used for LOG
+	unsigned logPos;
+	bool logWrapped;
+
 	static unsigned lastId;
 };
 
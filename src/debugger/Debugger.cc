@@ -14,6 +14,7 @@
 #include "KeyRange.hh"
 #include "stl.hh"
 #include "unreachable.hh"
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <stdexcept>
@@ -147,6 +148,7 @@ void Debugger::removeProbeBreakPoint(ProbeBreakPoint& bp)
 unsigned Debugger::setWatchPoint(TclObject command, TclObject condition,
                                  WatchPoint::Type type,
                                  unsigned beginAddr, unsigned endAddr,
+                                 WatchPoint::Action action, unsigned logSize,
                                  unsigned newId /*= -1*/)
 {
 	shared_ptr<WatchPoint> wp;
@@ -158,6 +160,9 @@ unsigned Debugger::setWatchPoint(TclObject command, TclObject condition,
 		wp = make_shared<WatchPoint>(
 			command, condition, type, beginAddr, endAddr, newId);
 	}
+	if (action != WatchPoint::TCL) {
+		wp->setAction(action, logSize);
+	}
 	motherBoard.getCPUInterface().setWatchPoint(wp);
 	return wp->getId();
 }
@@ -169,7 +174,8 @@ void Debugger::transfer(Debugger& other)
 	for (auto& wp : other.motherBoard.getCPUInterface().getWatchPoints()) {
 		setWatchPoint(wp->getCommandObj(), wp->getConditionObj(),
 		              wp->getType(),       wp->getBeginAddress(),
-		              wp->getEndAddress(), wp->getId());
+		              wp->getEndAddress(), wp->getAction(),
+		              wp->getLogSize(),    wp->getId());
 	}
 
 	// Copy probes to new machine.
@@ -263,6 +269,10 @@ void Debugger::Cmd::execute(
 		removeWatchPoint(tokens, result);
 	} else if (subCmd == "list_watchpoints") {
 		listWatchPoints(tokens, result);
+	} else if (subCmd == "watchpoint_hits") {
+		watchPointHits(tokens, result);
+	} else if (subCmd == "watchpoint_log") {
+		watchPointLog(tokens, result);
 	} else if (subCmd == "set_condition") {
 		setCondition(tokens, result);
 	} else if (subCmd == "remove_condition") {
@@ -271,6 +281,10 @@ void Debugger::Cmd::execute(
 		listConditions(tokens, result);
 	} else if (subCmd == "probe") {
 		probe(tokens, result);
+	} else if (subCmd == "trace") {
+		trace(tokens, result);
+	} else if (subCmd == "profile") {
+		profile(tokens, result);
 	} else {
 		throw SyntaxError();
 	}
@@ -468,16 +482,46 @@ void Debugger::Cmd::setWatchPoint(array_ref<TclObject> tokens, TclObject& result
 	TclObject condition;
 	unsigned beginAddr, endAddr;
 	WatchPoint::Type type;
+	WatchPoint::Action action = WatchPoint::TCL;
+	unsigned logSize = 0;
 
-	switch (tokens.size()) {
-	case 6: // command
-		command = tokens[5];
+	auto& interp = getInterpreter();
+	array_ref<TclObject> args = tokens.substr(2);
+	if (!args.empty()) {
+		string_view option = args[0].getString();
+		if (option == "-count") {
+			action = WatchPoint::COUNT;
+			args.pop_front();
+		} else if (option == "-break") {
+			action = WatchPoint::BREAK;
+			args.pop_front();
+		} else if (option == "-log") {
+			if (args.size() < 2) {
+				throw CommandException("Missing log size.");
+			}
+			action = WatchPoint::LOG;
+			int size = args[1].getInt(interp);
+			if ((size <= 0) || (size > 0x100000)) {
+				throw CommandException("Invalid log size: ", size);
+			}
+			logSize = size;
+			args.remove_prefix(2);
+		}
+	}
+	if ((action != WatchPoint::TCL) && (args.size() > 2)) {
+		throw CommandException(
+			"Native watchpoint actions take no condition or command.");
+	}
+
+	switch (args.size()) {
+	case 4: // command
+		command = args[3];
 		// fall-through
-	case 5: // condition
-		condition = tokens[4];
+	case 3: // condition
+		condition = args[2];
 		// fall-through
-	case 4: { // address + type
-		string_view typeStr = tokens[2].getString();
+	case 2: { // address + type
+		string_view typeStr = args[0].getString();
 		unsigned max;
 		if (typeStr == "read_io") {
 			type = WatchPoint::READ_IO;
@@ -494,17 +538,16 @@ void Debugger::Cmd::setWatchPoint(array_ref<TclObject> tokens, TclObject& result
 		} else {
 			throw CommandException("Invalid type: ", typeStr);
 		}
-		auto& interp = getInterpreter();
-		if (tokens[3].getListLength(interp) == 2) {
-			beginAddr = tokens[3].getListIndex(interp, 0).getInt(interp);
-			endAddr   = tokens[3].getListIndex(interp, 1).getInt(interp);
+		if (args[1].getListLength(interp) == 2) {
+			beginAddr = args[1].getListIndex(interp, 0).getInt(interp);
+			endAddr   = args[1].getListIndex(interp, 1).getInt(interp);
 			if (endAddr < beginAddr) {
 				throw CommandException(
 					"Not a valid range: end address may "
 					"not be smaller than begin address.");
 			}
 		} else {
-			beginAddr = endAddr = tokens[3].getInt(interp);
+			beginAddr = endAddr = args[1].getInt(interp);
 		}
 		if (endAddr >= max) {
 			throw CommandException("Invalid address: out of range");
@@ -512,17 +555,146 @@ void Debugger::Cmd::setWatchPoint(array_ref<TclObject> tokens, TclObject& result
 		break;
 	}
 	default:
-		if (tokens.size() < 4) {
+		if (args.size() < 2) {
 			throw CommandException("Too few arguments.");
 		} else {
 			throw CommandException("Too many arguments.");
 		}
 	}
+	if (action != WatchPoint::TCL) {
+		command = TclObject();
+	}
 	unsigned id = debugger().setWatchPoint(
-		command, condition, type, beginAddr, endAddr);
+		command, condition, type, beginAddr, endAddr, action, logSize);
 	result.setString(strCat("wp#", id));
 }
 
+WatchPoint& Debugger::Cmd::getWatchPoint(string_view str)
+{
+	try {
+		if (str.starts_with("wp#")) {
+			unsigned id = fast_stou(str.substr(3));
+			auto& interface = debugger().motherBoard.getCPUInterface();
+			for (auto& wp : interface.getWatchPoints()) {
+				if (wp->getId() == id) return *wp;
+			}
+		}
+	} catch (std::invalid_argument&) {
+		// parse error in fast_stou()
+	}
+	throw CommandException("No such watchpoint: ", str);
+}
+
+void Debugger::Cmd::watchPointHits(
+	array_ref<TclObject> tokens, TclObject& result)
+{
+	if ((tokens.size() != 3) &&
+	    ((tokens.size() != 4) || (tokens[3] != "-clear"))) {
+		throw SyntaxError();
+	}
+	auto& wp = getWatchPoint(tokens[2].getString());
+	result.setString(strCat(wp.getHitCount()));
+	if (tokens.size() == 4) wp.clearHits();
+}
+
+void Debugger::Cmd::watchPointLog(
+	array_ref<TclObject> tokens, TclObject& result)
+{
+	if ((tokens.size() != 3) &&
+	    ((tokens.size() != 4) || (tokens[3] != "-clear"))) {
+		throw SyntaxError();
+	}
+	auto& wp = getWatchPoint(tokens[2].getString());
+	for (auto& e : wp.getLog()) {
+		TclObject entry;
+		entry.addListElement((e.time - EmuTime::zero).toDouble());
+		entry.addListElement(int(e.pc));
+		entry.addListElement(int(e.address));
+		entry.addListElement(int(e.value));
+		result.addListElement(entry);
+	}
+	if (tokens.size() == 4) wp.clearHits();
+}
+
+void Debugger::Cmd::trace(array_ref<TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 3) {
+		throw SyntaxError();
+	}
+	auto& cpu = *debugger().cpu;
+	auto& interp = getInterpreter();
+	string_view subCmd = tokens[2].getString();
+	if (subCmd == "start") {
+		int size = 100000;
+		if (tokens.size() == 4) {
+			size = tokens[3].getInt(interp);
+			if ((size <= 0) || (size > 0x1000000)) {
+				throw CommandException("Invalid trace size: ", size);
+			}
+		} else if (tokens.size() != 3) {
+			throw SyntaxError();
+		}
+		cpu.setTraceBufferSize(size);
+	} else if (subCmd == "stop") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.setTraceBufferSize(0);
+	} else if (subCmd == "clear") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.getTraceBuffer().clear();
+	} else if (subCmd == "dump") {
+		auto& buffer = cpu.getTraceBuffer();
+		unsigned count = buffer.getCount();
+		if (tokens.size() == 4) {
+			int n = tokens[3].getInt(interp);
+			if (n < 0) {
+				throw CommandException("Invalid count: ", n);
+			}
+			count = std::min<unsigned>(count, n);
+		} else if (tokens.size() != 3) {
+			throw SyntaxError();
+		}
+		result.setString(buffer.dump(count));
+	} else {
+		throw SyntaxError();
+	}
+}
+
+void Debugger::Cmd::profile(array_ref<TclObject> tokens, TclObject& /*result*/)
+{
+	if (tokens.size() < 3) {
+		throw SyntaxError();
+	}
+	auto& cpu = *debugger().cpu;
+	string_view subCmd = tokens[2].getString();
+	if (subCmd == "start") {
+		bool memory = false;
+		if (tokens.size() == 4) {
+			if (tokens[3].getString() != "-memory") throw SyntaxError();
+			memory = true;
+		} else if (tokens.size() != 3) {
+			throw SyntaxError();
+		}
+		cpu.setProfiling(true, memory);
+	} else if (subCmd == "stop") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.setProfiling(false, false);
+	} else if (subCmd == "clear") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.getProfiler().clear();
+	} else if (subCmd == "export") {
+		bool json = true;
+		if (tokens.size() == 5) {
+			if (tokens[4].getString() != "-binary") throw SyntaxError();
+			json = false;
+		} else if (tokens.size() != 4) {
+			throw SyntaxError();
+		}
+		cpu.getProfiler().save(tokens[3].getString().str(), json);
+	} else {
+		throw SyntaxError();
+	}
+}
+
 void Debugger::Cmd::removeWatchPoint(
 	array_ref<TclObject> tokens, TclObject& /*result*/)
 {
@@ -585,7 +757,20 @@ void Debugger::Cmd::listWatchPoints(
 			line.addListElement(range);
 		}
 		line.addListElement(wp->getCondition());
-		line.addListElement(wp->getCommand());
+		switch (wp->getAction()) {
+		case WatchPoint::TCL:
+			line.addListElement(wp->getCommand());
+			break;
+		case WatchPoint::COUNT:
+			line.addListElement("-count");
+			break;
+		case WatchPoint::LOG:
+			line.addListElement(strCat("-log ", wp->getLogSize()));
+			break;
+		case WatchPoint::BREAK:
+			line.addListElement("-break");
+			break;
+		}
 		strAppend(res, line.getString(), '\n');
 	}
 	result.setString(res);
@@ -772,6 +957,8 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    set_watchpoint    insert a new watchpoint\n"
 		"    remove_watchpoint remove a certain watchpoint\n"
 		"    list_watchpoints  list the active watchpoints\n"
+		"    watchpoint_hits   number of hits of a native watchpoint\n"
+		"    watchpoint_log    logged accesses of a native watchpoint\n"
 		"    set_condition     insert a new condition\n"
 		"    remove_condition  remove a certain condition\n"
 		"    list_conditions   list the active conditions\n"
@@ -781,6 +968,8 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    break             break CPU at current position\n"
 		"    breaked           query CPU breaked status\n"
 		"    disasm            disassemble instructions\n"
+		"    trace             record the executed instructions\n"
+		"    profile           count executed instructions and memory accesses\n"
 		"  The arguments are specific for each subcommand.\n"
 		"  Type 'help debug <subcommand>' for help about a specific subcommand.\n";
 
@@ -856,9 +1045,15 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"the command that will be executed (default is 'debug break').\n";
 	static const string setWatchPointHelp =
 		"debug set_watchpoint <type> <region> [<cond>] [<cmd>]\n"
+		"debug set_watchpoint -count|-break|-log <size> <type> <region>\n"
 		"  Insert a new watchpoint of given type on the given region, "
 		"there can be an optional condition and alternative command. See "
 		"the 'set_bp' subcommand for details about these last two.\n"
+		"  The second form doesn't execute a Tcl command, instead it "
+		"natively (much faster) counts the accesses (-count), also logs "
+		"them in a ring buffer with <size> entries (-log) or breaks the "
+		"CPU (-break). See the 'watchpoint_hits' and 'watchpoint_log' "
+		"subcommands.\n"
 		"  Type must be one of the following:\n"
 		"    read_io    break when CPU reads from given IO port(s)\n"
 		"    write_io   break when CPU writes to given IO port(s)\n"
@@ -881,6 +1076,17 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"debug remove_watchpoint <id>\n"
 		"  Remove the watchpoint with given ID again. You can use the "
 		"'list_watchpoints' subcommand to see all valid IDs.\n";
+	static const string watchPointHitsHelp =
+		"debug watchpoint_hits <id> [-clear]\n"
+		"  Returns how many times the native watchpoint with given ID was "
+		"hit. With -clear the counter (and log) is reset afterwards.\n";
+	static const string watchPointLogHelp =
+		"debug watchpoint_log <id> [-clear]\n"
+		"  Returns the accesses logged by the (-log) watchpoint with given "
+		"ID, oldest first. Each entry is a list of the emulation time (in "
+		"seconds), the value of the PC register, the address (or IO port) "
+		"and the value that was read or written. With -clear the log (and "
+		"counter) is emptied afterwards.\n";
 	static const string listWatchPointsHelp =
 		"debug list_watchpoints\n"
 		"  Lists all active watchpoints. The result is similar to the "
@@ -939,6 +1145,40 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"instruction).\n"
 		"  Note that openMSX comes with a 'disasm' Tcl script that is much "
 		"more convenient to use than this subcommand.";
+	static const string traceHelp =
+		"debug trace start [<size>]\n"
+		"debug trace stop\n"
+		"debug trace clear\n"
+		"debug trace dump [<count>]\n"
+		"  Record the executed instructions in a ring buffer with <size> "
+		"entries (default 100000). This is much faster than the "
+		"'cputrace' setting: the instructions are only disassembled when "
+		"the buffer is dumped. 'stop' stops recording and frees the "
+		"buffer, 'clear' empties it.\n"
+		"  'dump' returns the last <count> (default all) recorded "
+		"instructions, oldest first, one per line: the emulation time "
+		"(in seconds) at the end of the instruction, the slot of the "
+		"instruction, its address and disassembly, and the registers "
+		"after the instruction.\n"
+		"  To see how the CPU got to a certain point, use for example:\n"
+		"    debug set_bp 0x4000 {} {puts [debug trace dump 100]}\n";
+	static const string profileHelp =
+		"debug profile start [-memory]\n"
+		"debug profile stop\n"
+		"debug profile clear\n"
+		"debug profile export <filename> [-binary]\n"
+		"  Count for each address how often an instruction was executed "
+		"there and how many CPU cycles were spent in those instructions "
+		"(including HALT and accepting interrupts). The counters are kept "
+		"per slot and per segment of a memory mapper or MegaROM. With "
+		"'-memory' also the memory reads (including instruction fetches) "
+		"and writes are counted, this makes the emulation considerably "
+		"slower. 'stop' keeps the counters, 'clear' resets them.\n"
+		"  'export' writes all non-zero counters to a file, as JSON or, "
+		"with '-binary', in a compact binary format (see CPUProfiler.hh "
+		"in the openMSX sources). Each entry has the address, the primary "
+		"and secondary slot (-1 when not expanded), the segment (-1 when "
+		"unknown) and the exec, cycles, reads and writes counts.\n";
 	static const string unknownHelp =
 		"Unknown subcommand, use 'help debug' to see a list of valid "
 		"subcommands.\n";
@@ -971,6 +1211,10 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		return removeWatchPointHelp;
 	} else if (tokens[1] == "list_watchpoints") {
 		return listWatchPointsHelp;
+	} else if (tokens[1] == "watchpoint_hits") {
+		return watchPointHitsHelp;
+	} else if (tokens[1] == "watchpoint_log") {
+		return watchPointLogHelp;
 	} else if (tokens[1] == "set_condition") {
 		return setCondHelp;
 	} else if (tokens[1] == "remove_condition") {
@@ -989,6 +1233,10 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		return breakedHelp;
 	} else if (tokens[1] == "disasm") {
 		return disasmHelp;
+	} else if (tokens[1] == "trace") {
+		return traceHelp;
+	} else if (tokens[1] == "profile") {
+		return profileHelp;
 	} else {
 		return unknownHelp;
 	}
@@ -1034,8 +1282,8 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 	};
 	static const char* const otherCmds[] = {
 		"disasm", "set_bp", "remove_bp", "set_watchpoint",
-		"remove_watchpoint", "set_condition", "remove_condition",
-		"probe",
+		"remove_watchpoint", "watchpoint_hits", "watchpoint_log",
+		"set_condition", "remove_condition", "probe", "trace", "profile",
 	};
 	switch (tokens.size()) {
 	case 2: {
@@ -1055,7 +1303,9 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 			} else if (tokens[1] == "remove_bp") {
 				// this one takes a bp id
 				completeString(tokens, getBreakPointIds());
-			} else if (tokens[1] == "remove_watchpoint") {
+			} else if ((tokens[1] == "remove_watchpoint") ||
+			           (tokens[1] == "watchpoint_hits") ||
+			           (tokens[1] == "watchpoint_log")) {
 				// this one takes a wp id
 				completeString(tokens, getWatchPointIds());
 			} else if (tokens[1] == "remove_condition") {
@@ -1073,6 +1323,16 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 					"remove_bp", "list_bp",
 				};
 				completeString(tokens, subCmds);
+			} else if (tokens[1] == "trace") {
+				static const char* const subCmds[] = {
+					"start", "stop", "clear", "dump",
+				};
+				completeString(tokens, subCmds);
+			} else if (tokens[1] == "profile") {
+				static const char* const subCmds[] = {
+					"start", "stop", "clear", "export",
+				};
+				completeString(tokens, subCmds);
 			}
 		}
 		break;
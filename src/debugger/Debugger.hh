@@ -55,7 +55,8 @@ private:
 	unsigned setWatchPoint(TclObject command, TclObject condition,
 	                       WatchPoint::Type type,
 	                       unsigned beginAddr, unsigned endAddr,
-	                       unsigned newId = -1);
+	                       WatchPoint::Action action = WatchPoint::TCL,
+	                       unsigned logSize = 0, unsigned newId = -1);
 
 	MSXMotherBoard& motherBoard;
 
@@ -89,6 +90,11 @@ private:
 		void setWatchPoint(array_ref<TclObject> tokens, TclObject& result);
 		void removeWatchPoint(array_ref<TclObject> tokens, TclObject& result);
 		void listWatchPoints(array_ref<TclObject> tokens, TclObject& result);
+		void watchPointHits(array_ref<TclObject> tokens, TclObject& result);
+		void watchPointLog(array_ref<TclObject> tokens, TclObject& result);
+		WatchPoint& getWatchPoint(string_view str);
+		void trace(array_ref<TclObject> tokens, TclObject& result);
+		void profile(array_ref<TclObject> tokens, TclObject& result);
 		void setCondition(array_ref<TclObject> tokens, TclObject& result);
 		void removeCondition(array_ref<TclObject> tokens, TclObject& result);
 		void listConditions(array_ref<TclObject> tokens, TclObject& result);
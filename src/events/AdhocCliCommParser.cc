@@ -2,8 +2,10 @@
 #include "utf8_unchecked.hh"
 
 
-AdhocCliCommParser::AdhocCliCommParser(std::function<void(const std::string&)> callback_)
+AdhocCliCommParser::AdhocCliCommParser(
+		std::function<void(std::vector<Command>)> callback_)
 	: callback(std::move(callback_))
+	, inBatch(false)
 	, state(O0)
 {
 }
@@ -13,58 +15,115 @@ void AdhocCliCommParser::parse(const char* buf, size_t n)
 	for (size_t i = 0; i < n; ++i) parse(buf[i]);
 }
 
+static bool isSpace(char c)
+{
+	return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+// The only supported attribute is id="..." (or id='...') on <command>.
+static bool parseId(const std::string& attributes, std::string& id)
+{
+	id.clear();
+	size_t b = 0;
+	size_t e = attributes.size();
+	while ((b < e) && isSpace(attributes[b])) ++b;
+	while ((b < e) && isSpace(attributes[e - 1])) --e;
+	if (b == e) return true; // no attributes
+	if (((e - b) < 5) || (attributes.compare(b, 3, "id=") != 0)) return false;
+	char quote = attributes[b + 3];
+	if (((quote != '"') && (quote != '\'')) || (attributes[e - 1] != quote)) {
+		return false;
+	}
+	id = attributes.substr(b + 4, e - b - 5);
+	return id.find(quote) == std::string::npos;
+}
+
+void AdhocCliCommParser::handleTag()
+{
+	state = O0;
+	if (tag == "command") {
+		if (parseId(attributes, current.id)) {
+			current.command.clear();
+			state = C0;
+		}
+	} else if ((tag == "batch") && !inBatch) {
+		inBatch = true;
+		batch.clear();
+	} else if ((tag == "/batch") && inBatch) {
+		inBatch = false;
+		if (!batch.empty()) callback(std::move(batch));
+		batch.clear();
+	}
+	// other tags are ignored
+}
+
+void AdhocCliCommParser::endCommand()
+{
+	if (inBatch) {
+		batch.push_back(std::move(current));
+	} else {
+		std::vector<Command> single;
+		single.push_back(std::move(current));
+		callback(std::move(single));
+	}
+	current = Command();
+}
+
 void AdhocCliCommParser::parse(char c)
 {
 	// Whenever there is a parse error we return to the initial state
 	switch (state) {
 	case O0: // looking for opening tag
-		state = (c == '<') ? O1 : O0; break;
-	case O1: // matched <
-		state = (c == 'c') ? O2 : O0; break;
-	case O2: // matched <c
-		state = (c == 'o') ? O3 : O0; break;
-	case O3: // matched <co
-		state = (c == 'm') ? O4 : O0; break;
-	case O4: // matched <com
-		state = (c == 'm') ? O5 : O0; break;
-	case O5: // matched <comm
-		state = (c == 'a') ? O6 : O0; break;
-	case O6: // matched <comma
-		state = (c == 'n') ? O7 : O0; break;
-	case O7: // matched <comman
-		state = (c == 'd') ? O8 : O0; break;
-	case O8: // matched <command
+		if (c == '<') {
+			state = T0;
+			tag.clear();
+			attributes.clear();
+		}
+		break;
+	case T0: // matched <, parsing tag name
 		if (c == '>') {
-			state = C0;
-			command.clear();
+			handleTag();
+		} else if (c == '<') {
+			tag.clear();
+		} else if (isSpace(c)) {
+			state = T1;
 		} else {
-			state = O0;
+			tag += c;
+		}
+		break;
+	case T1: // parsing attributes
+		if (c == '>') {
+			handleTag();
+		} else if (c == '<') {
+			state = T0;
+			tag.clear();
+			attributes.clear();
+		} else {
+			attributes += c;
 		}
 		break;
 	case C0: // matched <command>, now parsing xml entities and </command>
-		if      (c == '<') state = C1;
-		else if (c == '&') state = A1;
-		else command += c;
+		if (c == '<') {
+			state = C1;
+			tag.clear();
+		} else if (c == '&') {
+			state = A1;
+		} else {
+			current.command += c;
+		}
 		break;
-	case C1: // matched <
-		state = (c == '/') ? C2 : O0; break;
-	case C2: // matched </
-		state = (c == 'c') ? C3 : O0; break;
-	case C3: // matched </c
-		state = (c == 'o') ? C4 : O0; break;
-	case C4: // matched </co
-		state = (c == 'm') ? C5 : O0; break;
-	case C5: // matched </com
-		state = (c == 'm') ? C6 : O0; break;
-	case C6: // matched </comm
-		state = (c == 'a') ? C7 : O0; break;
-	case C7: // matched </comma
-		state = (c == 'n') ? C8 : O0; break;
-	case C8: // matched </comman
-		state = (c == 'd') ? C9 : O0; break;
-	case C9: // matched </command
-		if (c == '>') callback(command);
-		state = O0;
+	case C1: // matched <, parsing closing tag
+		if (c == '>') {
+			// no nested tags allowed
+			if (tag == "/command") endCommand();
+			state = O0;
+		} else if (c == '<') {
+			state = T0; // error, but maybe the start of a new tag
+			tag.clear();
+			attributes.clear();
+		} else {
+			tag += c;
+		}
 		break;
 	case A1: // matched &
 		if      (c == 'l') state = L2;
@@ -83,7 +142,7 @@ void AdhocCliCommParser::parse(char c)
 		state = (c == 'p') ? A4 : O0; break;
 	case A4: // matched &amp
 		if (c == ';') {
-			command += '&';
+			current.command += '&';
 			state = C0;
 		} else {
 			state = O0; // error
@@ -95,7 +154,7 @@ void AdhocCliCommParser::parse(char c)
 		state = (c == 's') ? P5 : O0; break;
 	case P5: // matched &apos
 		if (c == ';') {
-			command += '\'';
+			current.command += '\'';
 			state = C0;
 		} else {
 			state = O0; // error
@@ -109,7 +168,7 @@ void AdhocCliCommParser::parse(char c)
 		state = (c == 't') ? Q5 : O0; break;
 	case Q5: // matched &quot
 		if (c == ';') {
-			command += '"';
+			current.command += '"';
 			state = C0;
 		} else {
 			state = O0; // error
@@ -119,7 +178,7 @@ void AdhocCliCommParser::parse(char c)
 		state = (c == 't') ? G3 : O0; break;
 	case G3: // matched &gt
 		if (c == ';') {
-			command += '>';
+			current.command += '>';
 			state = C0;
 		} else {
 			state = O0; // error
@@ -129,7 +188,7 @@ void AdhocCliCommParser::parse(char c)
 		state = (c == 't') ? L3 : O0; break;
 	case L3: // matched &lt
 		if (c == ';') {
-			command += '<';
+			current.command += '<';
 			state = C0;
 		} else {
 			state = O0; // error
@@ -139,7 +198,7 @@ void AdhocCliCommParser::parse(char c)
 		// This also parses invalid input like '&#12xab;' but let's
 		// ignore that. It also doesn't check for overflow etc.
 		if (c == ';') {
-			utf8::unchecked::append(unicode, back_inserter(command));
+			utf8::unchecked::append(unicode, back_inserter(current.command));
 			state = C0;
 		} else if (c == 'x') {
 			state = H3;
@@ -151,7 +210,7 @@ void AdhocCliCommParser::parse(char c)
 		break;
 	case H3: // matched &#x
 		if (c == ';') {
-			utf8::unchecked::append(unicode, back_inserter(command));
+			utf8::unchecked::append(unicode, back_inserter(current.command));
 			state = C0;
 		} else {
 			unicode *= 16;
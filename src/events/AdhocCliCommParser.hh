@@ -4,39 +4,42 @@
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 class AdhocCliCommParser
 {
 public:
-	explicit AdhocCliCommParser(std::function<void(const std::string&)> callback);
+	struct Command {
+		std::string command;
+		std::string id; // value of the (optional) 'id' attribute
+	};
+
+	/** The callback is called once for every <command> element, with a
+	  * single command, and once for every <batch> element, with all the
+	  * commands in that batch.
+	  */
+	explicit AdhocCliCommParser(
+		std::function<void(std::vector<Command>)> callback);
 	void parse(const char* buf, size_t n);
 
 private:
 	void parse(char c);
+	void handleTag();
+	void endCommand();
 
-	std::function<void(const std::string&)> callback;
-	std::string command;
+	std::function<void(std::vector<Command>)> callback;
+	Command current;
+	std::vector<Command> batch;
+	std::string tag;
+	std::string attributes;
 	uint32_t unicode;
+	bool inBatch;
 	enum State {
 		O0, // no tag char matched yet
-		O1, // matched <
-		O2, //         <c
-		O3, //         <co
-		O4, //         <com
-		O5, //         <comm
-		O6, //         <comma
-		O7, //         <comman
-		O8, //         <command
+		T0, // matched <, now parsing the tag name
+		T1, // parsing the attributes of the tag
 		C0, // matched <command>, now parsing xml entities and </command>
-		C1, // matched <
-		C2, //         </
-		C3, //         </c
-		C4, //         </co
-		C5, //         </com
-		C6, //         </comm
-		C7, //         </comma
-		C8, //         </comman
-		C9, //         </command
+		C1, // matched <, now parsing the closing tag
 		A1, // matched &
 		A2, //         &a
 		A3, //         &am
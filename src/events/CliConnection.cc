@@ -16,6 +16,7 @@
 #include "cstdiop.hh"
 #include "unistdp.hh"
 #include "openmsx.hh"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -30,17 +31,22 @@ namespace openmsx {
 
 // class CliCommandEvent
 
+// A single <command> or all commands of a <batch>. The latter are executed
+// in one go, so that a client that sends many (small) commands at once
+// doesn't need one round trip through the main thread per command.
 class CliCommandEvent final : public Event
 {
 public:
-	CliCommandEvent(string command_, const CliConnection* id_)
+	using Commands = std::vector<AdhocCliCommParser::Command>;
+
+	CliCommandEvent(Commands commands_, const CliConnection* id_)
 		: Event(OPENMSX_CLICOMMAND_EVENT)
-		, command(std::move(command_)), id(id_)
+		, commands(std::move(commands_)), id(id_)
 	{
 	}
-	const string& getCommand() const
+	const Commands& getCommands() const
 	{
-		return command;
+		return commands;
 	}
 	const CliConnection* getId() const
 	{
@@ -49,15 +55,24 @@ public:
 	void toStringImpl(TclObject& result) const override
 	{
 		result.addListElement("CliCmd");
-		result.addListElement(getCommand());
+		for (auto& c : commands) {
+			result.addListElement(c.command);
+		}
 	}
 	bool lessImpl(const Event& other) const override
 	{
 		auto& otherCmdEvent = checked_cast<const CliCommandEvent&>(other);
-		return getCommand() < otherCmdEvent.getCommand();
+		auto& otherCommands = otherCmdEvent.getCommands();
+		return std::lexicographical_compare(
+			commands.begin(), commands.end(),
+			otherCommands.begin(), otherCommands.end(),
+			[](const AdhocCliCommParser::Command& x,
+			   const AdhocCliCommParser::Command& y) {
+				return x.command < y.command;
+			});
 	}
 private:
-	const string command;
+	const Commands commands;
 	const CliConnection* id;
 };
 
@@ -66,7 +81,9 @@ private:
 
 CliConnection::CliConnection(CommandController& commandController_,
                              EventDistributor& eventDistributor_)
-	: parser([this](const std::string& cmd) { execute(cmd); })
+	: parser([this](std::vector<AdhocCliCommParser::Command> commands) {
+		execute(std::move(commands));
+	  })
 	, commandController(commandController_)
 	, eventDistributor(eventDistributor_)
 {
@@ -129,30 +146,40 @@ void CliConnection::end()
 	}
 }
 
-void CliConnection::execute(const string& command)
+void CliConnection::execute(std::vector<AdhocCliCommParser::Command> commands)
 {
 	eventDistributor.distributeEvent(
-		std::make_shared<CliCommandEvent>(command, this));
+		std::make_shared<CliCommandEvent>(std::move(commands), this));
 }
 
-static string reply(const string& message, bool status)
+static void appendReply(string& out, const string& message, bool status,
+                        const string& id)
 {
-	return strCat("<reply result=\"", (status ? "ok" : "nok"), "\">",
-	              XMLElement::XMLEscape(message), "</reply>\n");
+	strAppend(out, "<reply result=\"", (status ? "ok" : "nok"), '\"');
+	if (!id.empty()) {
+		strAppend(out, " id=\"", XMLElement::XMLEscape(id), '\"');
+	}
+	strAppend(out, '>', XMLElement::XMLEscape(message), "</reply>\n");
 }
 
 int CliConnection::signalEvent(const std::shared_ptr<const Event>& event)
 {
 	auto& commandEvent = checked_cast<const CliCommandEvent&>(*event);
 	if (commandEvent.getId() == this) {
-		try {
-			string result = commandController.executeCommand(
-				commandEvent.getCommand(), this).getString().str();
-			output(reply(result, true));
-		} catch (CommandException& e) {
-			string result = std::move(e).getMessage() + '\n';
-			output(reply(result, false));
+		// One reply per command (in order), but send all replies of
+		// a batch at once.
+		string replies;
+		for (auto& cmd : commandEvent.getCommands()) {
+			try {
+				string result = commandController.executeCommand(
+					cmd.command, this).getString().str();
+				appendReply(replies, result, true, cmd.id);
+			} catch (CommandException& e) {
+				string result = std::move(e).getMessage() + '\n';
+				appendReply(replies, result, false, cmd.id);
+			}
 		}
+		output(replies);
 	}
 	return 0;
 }
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace openmsx {
 
@@ -64,7 +65,7 @@ protected:
 private:
 	virtual void run() = 0;
 
-	void execute(const std::string& command);
+	void execute(std::vector<AdhocCliCommParser::Command> commands);
 
 	// CliListener
 	void log(CliComm::LogLevel level, string_view message) override;
@@ -41,6 +41,9 @@ enum EventType
 	/** Used to schedule 'taking reverse snapshots' between Z80 instructions. */
 	OPENMSX_TAKE_REVERSE_SNAPSHOT,
 
+	/** Used to schedule 'run ahead' between Z80 instructions. */
+	OPENMSX_RUN_AHEAD,
+
 	/** Command received on CliComm connection */
 	OPENMSX_CLICOMMAND_EVENT,
 
@@ -68,6 +71,9 @@ enum EventType
 	OPENMSX_MIDI_IN_COREMIDI_VIRTUAL_EVENT,
 	OPENMSX_RS232_TESTER_EVENT,
 
+	/** Sent (from another thread) when ScreenShotWriter wrote a file. */
+	OPENMSX_SCREENSHOT_WRITTEN_EVENT,
+
 	NUM_EVENT_TYPES // must be last
 };
 
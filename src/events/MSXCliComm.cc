@@ -12,12 +12,14 @@ MSXCliComm::MSXCliComm(MSXMotherBoard& motherBoard_, GlobalCliComm& cliComm_)
 
 void MSXCliComm::log(LogLevel level, string_view message)
 {
+	if (motherBoard.isHidden()) return;
 	cliComm.log(level, message);
 }
 
 void MSXCliComm::update(UpdateType type, string_view name, string_view value)
 {
 	assert(type < NUM_UPDATES);
+	if (motherBoard.isHidden()) return;
 	auto it = prevValues[type].find(name);
 	if (it != end(prevValues[type])) {
 		if (it->second == value) {
@@ -224,6 +224,13 @@ Sha1Sum DMKDiskImage::getSha1SumImpl(FilePool& filepool)
 	return filepool.getSha1Sum(*file);
 }
 
+void DMKDiskImage::enableWriteOverlay()
+{
+	// The FDC reads and writes whole tracks, which bypasses the sector
+	// overlay. So instead don't allow writes at all.
+	forceWriteProtect();
+}
+
 void DMKDiskImage::detectGeometryFallback()
 {
 	// The implementation in Disk::detectGeometryFallback() uses
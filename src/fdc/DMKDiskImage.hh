@@ -27,6 +27,7 @@ public:
 	size_t getNbSectorsImpl() const override;
 	bool isWriteProtectedImpl() const override;
 	Sha1Sum getSha1SumImpl(FilePool& filepool) override;
+	void enableWriteOverlay() override;
 
 private:
 	void detectGeometryFallback() override;
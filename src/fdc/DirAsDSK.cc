@@ -346,6 +346,13 @@ void DirAsDSK::checkCaches()
 	}
 }
 
+void DirAsDSK::sectorWritten(size_t /*sector*/)
+{
+	// Writing a FAT or directory sector can also change other sectors
+	// (e.g. when files on the host are updated), so flush everything.
+	flushCaches();
+}
+
 void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 {
 	assert(sector < nofSectors);
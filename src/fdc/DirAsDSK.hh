@@ -28,6 +28,7 @@ public:
 	void writeSectorImpl(size_t sector, const SectorBuffer& buf) override;
 	bool isWriteProtectedImpl() const override;
 	void checkCaches() override;
+	void sectorWritten(size_t sector) override;
 
 private:
 	struct DirIndex {
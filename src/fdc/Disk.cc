@@ -1,5 +1,6 @@
 #include "Disk.hh"
 #include "DiskExceptions.hh"
+#include "RawTrack.hh"
 
 using std::string;
 
@@ -19,6 +20,13 @@ void Disk::writeTrack(byte track, byte side, const RawTrack& input)
 	flushCaches();
 }
 
+std::shared_ptr<const RawTrack> Disk::readTrackShared(byte track, byte side)
+{
+	auto result = std::make_shared<RawTrack>();
+	readTrack(track, side, *result);
+	return result;
+}
+
 bool Disk::isDoubleSided()
 {
 	if (!nbSides) {
@@ -4,6 +4,7 @@
 #include "SectorAccessibleDisk.hh"
 #include "DiskName.hh"
 #include "openmsx.hh"
+#include <memory>
 
 namespace openmsx {
 
@@ -22,6 +23,11 @@ public:
 	/** Read a full track from this disk image. */
 	virtual void readTrack (byte track, byte side,       RawTrack& output) = 0;
 
+	/** Like readTrack(), but the result can be shared with a cache in this
+	  * disk image, so it must not be modified (make a copy first). This
+	  * avoids copying the track data. */
+	virtual std::shared_ptr<const RawTrack> readTrackShared(byte track, byte side);
+
 	bool isDoubleSided();
 
 protected:
@@ -57,6 +57,7 @@ DiskChanger::DiskChanger(MSXMotherBoard& board,
 	, preChangeCallback(std::move(preChangeCallback_))
 	, driveName(std::move(driveName_))
 	, doubleSidedDrive(doubleSidedDrive_)
+	, hidden(board.isHidden())
 {
 	init(board.getMachineID() + "::", createCmd);
 }
@@ -68,6 +69,7 @@ DiskChanger::DiskChanger(Reactor& reactor_, string driveName_)
 	, scheduler(nullptr)
 	, driveName(std::move(driveName_))
 	, doubleSidedDrive(true) // irrelevant, but needs a value
+	, hidden(false)
 {
 	init({}, true);
 }
@@ -190,6 +192,8 @@ void DiskChanger::changeDisk(std::unique_ptr<Disk> newDisk)
 {
 	if (preChangeCallback) preChangeCallback();
 	disk = std::move(newDisk);
+	// Changes made by a hidden machine must not end up in the image.
+	if (hidden) disk->enableWriteOverlay();
 	diskChangedFlag = true;
 	controller.getCliComm().update(CliComm::MEDIA, getDriveName(),
 	                               getDiskName().getResolved());
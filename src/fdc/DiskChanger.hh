@@ -79,6 +79,7 @@ private:
 	friend class DiskCommand;
 	std::unique_ptr<DiskCommand> diskCommand; // must come after driveName
 	const bool doubleSidedDrive; // for DirAsDSK
+	const bool hidden; // see MSXMotherBoard::isHidden()
 
 	bool diskChangedFlag;
 };
@@ -1,23 +1,46 @@
 #include "MSXFDC.hh"
 #include "RealDrive.hh"
+#include "SectorAccessibleDisk.hh"
+#include "DiskExceptions.hh"
 #include "Rom.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "CPURegs.hh"
+#include "CacheLine.hh"
+#include "Reactor.hh"
+#include "GlobalSettings.hh"
 #include "XMLElement.hh"
 #include "MSXException.hh"
 #include "serialize.hh"
+#include "likely.hh"
+#include <cassert>
 #include <memory>
 
 namespace openmsx {
 
+// Entry point of the DSKIO routine in the DiskROM ('JP <routine>'), the
+// PHYDIO BIOS call ends up here.
+static const word DSKIO = 0x4010;
+
 MSXFDC::MSXFDC(const DeviceConfig& config, const std::string& romId, bool needROM)
 	: MSXDevice(config)
 	, rom(needROM
 		? std::make_unique<Rom>(getName() + " ROM", "rom", config, romId)
 		: nullptr) // e.g. Spectravideo_SVI-328 doesn't have a diskrom
+	, fastDiskIOSetting(getReactor().getGlobalSettings().getFastDiskIOSetting())
+	, canPatch(false)
 {
 	if (needROM && (rom->getSize() == 0)) {
 		throw MSXException(
 			"Empty ROM not allowed for \"", getName(), "\".");
 	}
+	if (rom && (rom->getSize() >= 0x4000) &&
+	    ((*rom)[0x0000] == 'A') && ((*rom)[0x0001] == 'B') &&
+	    ((*rom)[DSKIO & 0x3FFF] == 0xC3)) { // JP nn
+		canPatch = true;
+		getCPUInterface().registerTrap(*this, DSKIO);
+		fastDiskIOSetting.attach(*this);
+	}
 	bool singleSided = config.findChild("singlesided") != nullptr;
 	int numDrives = config.getChildDataAsInt("drives", 1);
 	if ((0 > numDrives) || (numDrives >= 4)) {
@@ -38,7 +61,13 @@ MSXFDC::MSXFDC(const DeviceConfig& config, const std::string& romId, bool needRO
 	}
 }
 
-MSXFDC::~MSXFDC() = default;
+MSXFDC::~MSXFDC()
+{
+	if (canPatch) {
+		fastDiskIOSetting.detach(*this);
+		getCPUInterface().unregisterTrap(*this, DSKIO);
+	}
+}
 
 void MSXFDC::powerDown(EmuTime::param time)
 {
@@ -47,21 +76,123 @@ void MSXFDC::powerDown(EmuTime::param time)
 	}
 }
 
-byte MSXFDC::readMem(word address, EmuTime::param /*time*/)
+byte MSXFDC::readMem(word address, EmuTime::param time)
 {
-	return *MSXFDC::getReadCacheLine(address);
+	return MSXFDC::peekMem(address, time);
 }
 
 byte MSXFDC::peekMem(word address, EmuTime::param /*time*/) const
 {
-	return *MSXFDC::getReadCacheLine(address);
+	if (unlikely((DSKIO <= address) && (address < (DSKIO + 3)) &&
+	             isPatched())) {
+		// emulator trap (see executeTrap()), followed by RET
+		static const byte patch[3] = { 0xED, 0xFE, 0xC9 };
+		return patch[address - DSKIO];
+	}
+	return (*rom)[address & 0x3FFF];
 }
 
 const byte* MSXFDC::getReadCacheLine(word start) const
 {
+	if (unlikely((start == (DSKIO & CacheLine::HIGH)) && isPatched())) {
+		return nullptr; // see peekMem()
+	}
 	return &(*rom)[start & 0x3FFF];
 }
 
+bool MSXFDC::isPatched() const
+{
+	return canPatch && fastDiskIOSetting.getBoolean();
+}
+
+void MSXFDC::update(const Setting& setting)
+{
+	(void)setting;
+	assert(&setting == &fastDiskIOSetting);
+	invalidateMemCache(DSKIO & CacheLine::HIGH, CacheLine::SIZE);
+}
+
+void MSXFDC::executeTrap(word address, EmuTime::param time)
+{
+	(void)address;
+	assert(address == DSKIO);
+	auto& regs = getCPU().getRegisters();
+	if (!fastDiskIO(regs, time)) {
+		// continue in the original routine, so via the emulated FDC
+		regs.setPC((*rom)[(DSKIO + 1) & 0x3FFF] +
+		           (*rom)[(DSKIO + 2) & 0x3FFF] * 256);
+	}
+}
+
+// Replacement for the DSKIO routine, similar to what NowindHost does for the
+// nowind interface: the sectors are copied directly between the disk image
+// and the MSX memory. Returns false for the cases it doesn't handle, then the
+// routine in the ROM is used.
+//  input:  A = drive number, B = number of sectors, C = media descriptor,
+//          DE = first sector, HL = transfer address, carry set for write
+//  output: carry set on error, then A = error code
+//          B = number of sectors that were not transferred
+bool MSXFDC::fastDiskIO(CPURegs& regs, EmuTime::param time)
+{
+	unsigned driveNum = regs.getA();
+	if (driveNum >= 4) return false;
+	auto* drive = dynamic_cast<RealDrive*>(drives[driveNum].get());
+	if (!drive) {
+		// e.g. the 2nd (phantom) drive on a machine with only one
+		// drive, the ROM asks to swap disks
+		return false;
+	}
+
+	unsigned num  = regs.getB();
+	unsigned addr = regs.getHL();
+	unsigned end  = addr + num * SectorAccessibleDisk::SECTOR_SIZE;
+	if ((end > 0x10000) || ((addr < 0x8000) && (end > 0x4000))) {
+		// Page 1 is occupied by this ROM, the routine in the ROM
+		// transfers via a buffer in that case.
+		return false;
+	}
+
+	// no disk inserted: let the ROM report 'not ready'
+	// DMK images etc. can only be accessed via the FDC
+	auto* disk = drive->getSectorAccessibleDisk();
+	if (!disk) return false;
+
+	auto& cpuInterface = getCPUInterface();
+	bool write = (regs.getF() & 0x01) != 0; // carry flag
+	unsigned sector = regs.getDE();
+	unsigned i = 0;
+	byte error;
+	try {
+		SectorBuffer buf;
+		for (/**/; i < num; ++i) {
+			if (write) {
+				for (auto& b : buf.raw) {
+					b = cpuInterface.readMem(addr++, time);
+				}
+				disk->writeSector(sector + i, buf);
+			} else {
+				disk->readSector(sector + i, buf);
+				for (auto& b : buf.raw) {
+					cpuInterface.writeMem(addr++, b, time);
+				}
+			}
+		}
+		regs.setF(regs.getF() & ~0x01);
+		regs.setB(0);
+		return true;
+	} catch (WriteProtectedException&) {
+		error = 0;
+	} catch (NoSuchSectorException&) {
+		error = 8; // record not found
+	} catch (MSXException&) {
+		error = 12; // other error
+	}
+	regs.setA(error);
+	regs.setB(num - i);
+	regs.setF(regs.getF() | 0x01);
+	return true;
+}
+
 
 template<typename Archive>
 void MSXFDC::serialize(Archive& ar, unsigned /*version*/)
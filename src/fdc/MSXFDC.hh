@@ -2,6 +2,7 @@
 #define MSXFDC_HH
 
 #include "MSXDevice.hh"
+#include "Observer.hh"
 #include <memory>
 #include <string>
 
@@ -9,14 +10,18 @@ namespace openmsx {
 
 class DiskDrive;
 class Rom;
+class CPURegs;
+class BooleanSetting;
+class Setting;
 
-class MSXFDC : public MSXDevice
+class MSXFDC : public MSXDevice, private Observer<Setting>
 {
 public:
 	void powerDown(EmuTime::param time) override;
 	byte readMem(word address, EmuTime::param time) override;
 	byte peekMem(word address, EmuTime::param time) const override;
 	const byte* getReadCacheLine(word start) const override;
+	void executeTrap(word address, EmuTime::param time) override;
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -28,6 +33,16 @@ protected:
 
 	std::unique_ptr<Rom> rom;
 	std::unique_ptr<DiskDrive> drives[4];
+
+private:
+	bool isPatched() const;
+	bool fastDiskIO(CPURegs& regs, EmuTime::param time);
+
+	// Observer<Setting>
+	void update(const Setting& setting) override;
+
+	BooleanSetting& fastDiskIOSetting;
+	bool canPatch; // the ROM has the standard DSKIO entry point
 };
 
 REGISTER_BASE_NAME_HELPER(MSXFDC, "FDC");
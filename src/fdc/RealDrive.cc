@@ -28,6 +28,7 @@ RealDrive::RealDrive(MSXMotherBoard& motherBoard_, EmuDuration::param motorTimeo
 	, motorStatus(false)
 	, doubleSizedDrive(doubleSided)
 	, signalsNeedMotorOn(signalsNeedMotorOn_)
+	, track(std::make_shared<RawTrack>())
 	, trackValid(false), trackDirty(false)
 {
 	drivesInUse = motherBoard.getSharedStuff<DrivesInUse>("drivesInUse");
@@ -281,16 +282,29 @@ void RealDrive::getTrack()
 		return;
 	}
 	if (!trackValid) {
-		changer->getDisk().readTrack(headPos, side, track);
+		// This doesn't copy the track data (when the disk image
+		// supports it).
+		track = changer->getDisk().readTrackShared(headPos, side);
 		trackValid = true;
 		trackDirty = false;
 	}
 }
 
+RawTrack& RealDrive::getWritableTrack()
+{
+	// Copy-on-write: make a private copy when the track is (still) shared
+	// with the disk image. All tracks are created as non-const objects,
+	// so once we're the only owner it's fine to modify it.
+	if (track.use_count() != 1) {
+		track = std::make_shared<RawTrack>(*track);
+	}
+	return const_cast<RawTrack&>(*track);
+}
+
 unsigned RealDrive::getTrackLength()
 {
 	getTrack();
-	return track.getLength();
+	return track->getLength();
 }
 
 void RealDrive::writeTrackByte(int idx, byte val, bool addIdam)
@@ -298,14 +312,14 @@ void RealDrive::writeTrackByte(int idx, byte val, bool addIdam)
 	getTrack();
 	// It's possible 'trackValid==false', but that's fine because in that
 	// case track won't be flushed to disk anyway.
-	track.write(idx, val, addIdam);
+	getWritableTrack().write(idx, val, addIdam);
 	trackDirty = true;
 }
 
 byte RealDrive::readTrackByte(int idx)
 {
 	getTrack();
-	return trackValid ? track.read(idx) : 0;
+	return trackValid ? track->read(idx) : 0;
 }
 
 static inline unsigned divUp(unsigned a, unsigned b)
@@ -316,7 +330,7 @@ EmuTime RealDrive::getNextSector(EmuTime::param time, RawTrack::Sector& sector)
 {
 	getTrack();
 	int currentAngle = getCurrentAngle(time);
-	unsigned trackLen = track.getLength();
+	unsigned trackLen = track->getLength();
 	unsigned idx = divUp(currentAngle * trackLen, TICKS_PER_ROTATION);
 
 	// 'addrIdx' points to the 'FE' byte in the 'A1 A1 A1 FE' sequence.
@@ -326,7 +340,7 @@ EmuTime RealDrive::getNextSector(EmuTime::param time, RawTrack::Sector& sector)
 	// distance is only 3 bytes or less we need to skip to the next sector
 	// header. IOW we need a sector header that's at least 4 bytes removed
 	// from the current position.
-	if (!track.decodeNextSector(idx + 4, sector)) {
+	if (!track->decodeNextSector(idx + 4, sector)) {
 		return EmuTime::infinity;
 	}
 	int sectorAngle = divUp(sector.addrIdx * TICKS_PER_ROTATION, trackLen);
@@ -343,7 +357,7 @@ EmuTime RealDrive::getNextSector(EmuTime::param time, RawTrack::Sector& sector)
 void RealDrive::flushTrack()
 {
 	if (trackValid && trackDirty) {
-		changer->getDisk().writeTrack(headPos, side, track);
+		changer->getDisk().writeTrack(headPos, side, *track);
 		trackDirty = false;
 	}
 }
@@ -365,7 +379,7 @@ bool RealDrive::isDummyDrive() const
 
 void RealDrive::applyWd2793ReadTrackQuirk()
 {
-	track.applyWd2793ReadTrackQuirk();
+	getWritableTrack().applyWd2793ReadTrackQuirk();
 }
 
 void RealDrive::invalidateWd2793ReadTrackQuirk()
@@ -373,6 +387,12 @@ void RealDrive::invalidateWd2793ReadTrackQuirk()
 	trackValid = false;
 }
 
+SectorAccessibleDisk* RealDrive::getSectorAccessibleDisk()
+{
+	invalidateTrack();
+	return changer->getSectorAccessibleDisk();
+}
+
 
 // version 1: initial version
 // version 2: removed 'timeOut', added MOTOR_TIMEOUT schedulable
@@ -401,7 +421,8 @@ void RealDrive::serialize(Archive& ar, unsigned version)
 		startAngle = 0;
 	}
 	if (ar.versionAtLeast(version, 5)) {
-		ar.serialize("track", track);
+		// (when saving this makes the track private, that's harmless)
+		ar.serialize("track", getWritableTrack());
 		ar.serialize("trackValid" ,trackValid);
 		ar.serialize("trackDirty", trackDirty);
 	}
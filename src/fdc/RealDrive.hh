@@ -14,6 +14,7 @@ namespace openmsx {
 
 class MSXMotherBoard;
 class DiskChanger;
+class SectorAccessibleDisk;
 
 /** This class implements a real drive, single or double sided.
  */
@@ -47,6 +48,13 @@ public:
 	void applyWd2793ReadTrackQuirk() override;
 	void invalidateWd2793ReadTrackQuirk() override;
 
+	/** Direct access to the sectors of the inserted disk, bypassing the
+	  * FDC emulation (see MSXFDC::executeTrap()). Writes back the cached
+	  * track first. Returns nullptr when no disk is inserted or when the
+	  * disk is not sector based (e.g. DMK).
+	  */
+	SectorAccessibleDisk* getSectorAccessibleDisk();
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -78,6 +86,7 @@ private:
 	unsigned getCurrentAngle(EmuTime::param time) const;
 
 	void getTrack();
+	RawTrack& getWritableTrack();
 	void invalidateTrack();
 
 	static const unsigned MAX_TRACK = 85;
@@ -102,7 +111,9 @@ private:
 	using DrivesInUse = std::bitset<MAX_DRIVES>;
 	std::shared_ptr<DrivesInUse> drivesInUse;
 
-	RawTrack track;
+	// The track under the head. This is often shared with the track cache
+	// of the disk image, see getWritableTrack().
+	std::shared_ptr<const RawTrack> track;
 	bool trackValid;
 	bool trackDirty;
 };
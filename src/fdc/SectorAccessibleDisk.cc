@@ -34,6 +34,13 @@ void SectorAccessibleDisk::readSector(size_t sector, SectorBuffer& buf)
 	    (getNbSectors() <= sector)) {
 		throw NoSuchSectorException("No such sector");
 	}
+	if (writeOverlay) {
+		auto it = writeOverlay->find(sector);
+		if (it != end(*writeOverlay)) {
+			buf = it->second;
+			return;
+		}
+	}
 	try {
 		// in the end this calls readSectorImpl()
 		patch->copyBlock(sector * sizeof(buf), buf.raw, sizeof(buf));
@@ -51,11 +58,15 @@ void SectorAccessibleDisk::writeSector(size_t sector, const SectorBuffer& buf)
 		throw NoSuchSectorException("No such sector");
 	}
 	try {
-		writeSectorImpl(sector, buf);
+		if (writeOverlay) {
+			(*writeOverlay)[sector] = buf;
+		} else {
+			writeSectorImpl(sector, buf);
+		}
 	} catch (MSXException& e) {
 		throw DiskIOErrorException("Disk I/O error: ", e.getMessage());
 	}
-	flushCaches();
+	sectorWritten(sector);
 }
 
 size_t SectorAccessibleDisk::getNbSectors() const
@@ -142,6 +153,13 @@ void SectorAccessibleDisk::forceWriteProtect()
 	forcedWriteProtect = true;
 }
 
+void SectorAccessibleDisk::enableWriteOverlay()
+{
+	if (!writeOverlay) {
+		writeOverlay = std::make_unique<std::map<size_t, SectorBuffer>>();
+	}
+}
+
 bool SectorAccessibleDisk::isDummyDisk() const
 {
 	return false;
@@ -157,4 +175,9 @@ void SectorAccessibleDisk::flushCaches()
 	sha1cache.clear();
 }
 
+void SectorAccessibleDisk::sectorWritten(size_t /*sector*/)
+{
+	flushCaches();
+}
+
 } // namespace openmsx
@@ -4,8 +4,9 @@
 #include "DiskImageUtils.hh"
 #include "Filename.hh"
 #include "sha1.hh"
-#include <vector>
+#include <map>
 #include <memory>
+#include <vector>
 
 namespace openmsx {
 
@@ -26,6 +27,14 @@ public:
 	bool isWriteProtected() const;
 	void forceWriteProtect();
 
+	/** From now on keep all written sectors in memory: they are read back
+	  * from there, but the image (file or host directory) is not changed
+	  * anymore. Used for the disks of hidden machines, see
+	  * MSXMotherBoard::isHidden(). Images that can't support this become
+	  * write protected instead.
+	  */
+	virtual void enableWriteOverlay();
+
 	virtual bool isDummyDisk() const;
 
 	// patch stuff
@@ -59,6 +68,9 @@ protected:
 
 	virtual void checkCaches();
 	virtual void flushCaches();
+	/** Called after a sector was written. By default this flushes all
+	  * caches, subclasses can be more selective. */
+	virtual void sectorWritten(size_t sector);
 	virtual Sha1Sum getSha1SumImpl(FilePool& filepool);
 
 private:
@@ -68,6 +80,7 @@ private:
 	virtual bool isWriteProtectedImpl() const = 0;
 
 	std::unique_ptr<const PatchInterface> patch;
+	std::unique_ptr<std::map<size_t, SectorBuffer>> writeOverlay;
 	Sha1Sum sha1cache;
 	bool forcedWriteProtect;
 	bool peekMode;
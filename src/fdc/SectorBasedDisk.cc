@@ -1,5 +1,6 @@
 #include "SectorBasedDisk.hh"
 #include "MSXException.hh"
+#include <algorithm>
 #include <cassert>
 
 namespace openmsx {
@@ -7,7 +8,6 @@ namespace openmsx {
 SectorBasedDisk::SectorBasedDisk(DiskName name_)
 	: Disk(std::move(name_))
 	, nbSectors(size_t(-1)) // to detect misuse
-	, cachedTrackNum(-1)
 {
 }
 
@@ -29,24 +29,48 @@ void SectorBasedDisk::writeTrackImpl(byte track, byte side, const RawTrack& inpu
 	}
 }
 
+// Most software reads several sectors from the same track before moving on,
+// and e.g. during emulation of a WD2793 read sector, the disk rotates from
+// sector to sector and each time the track data is requested again. But
+// software also often alternates between the two sides of a track, or
+// between the FAT/directory and the data tracks (and some copy-protection
+// checks jump between tracks). So keep a few tracks.
+static const unsigned TRACK_CACHE_SIZE = 8;
+
 void SectorBasedDisk::readTrack(byte track, byte side, RawTrack& output)
 {
-	// Try to cache the last result of this method (the cache will be
-	// flushed on any write to the disk). This very simple cache mechanism
-	// will typically already have a very high hit-rate. For example during
-	// emulation of a WD2793 read sector, we also emulate the search for
-	// the correct sector. So the disk rotates from sector to sector, and
-	// each time we re-read the track data (because emutime has passed).
-	// Typically the software will also read several sectors from the same
-	// track before moving to the next.
+	output = *readTrackShared(track, side);
+}
+
+std::shared_ptr<const RawTrack> SectorBasedDisk::readTrackShared(byte track, byte side)
+{
+	// The cache is flushed on writes (only the written track, or
+	// everything, see sectorWritten() and flushCaches()).
 	checkCaches();
 	int num = track | (side << 8);
-	if (num == cachedTrackNum) {
-		output = cachedTrackData;
-		return;
+	auto it = std::find_if(begin(trackCache), end(trackCache),
+		[&](const CachedTrack& c) { return c.num == num; });
+	if (it != end(trackCache)) {
+		// move to front
+		std::rotate(begin(trackCache), it, it + 1);
+		return trackCache.front().data;
+	}
+
+	auto result = std::make_shared<RawTrack>();
+	if (encodeTrack(track, side, *result)) {
+		if (trackCache.size() == TRACK_CACHE_SIZE) {
+			trackCache.pop_back();
+		}
+		trackCache.insert(begin(trackCache),
+			CachedTrack{result, physToLog(track, side, 1), num});
 	}
-	cachedTrackNum = num;
+	return result;
+}
 
+// Returns false if the track couldn't be read (then 'output' contains an
+// empty track).
+bool SectorBasedDisk::encodeTrack(byte track, byte side, RawTrack& output)
+{
 	// This disk image only stores the actual sector data, not all the
 	// extra gap, sync and header information that is in reality stored
 	// in between the sectors. This function transforms the cooked sector
@@ -128,15 +152,29 @@ void SectorBasedDisk::readTrack(byte track, byte side, RawTrack& output)
 		// real disk, you simply read an 'empty' track. So we do the
 		// same here.
 		output.clear(RawTrack::STANDARD_SIZE);
-		cachedTrackNum = -1; // needed?
+		return false;
 	}
-	cachedTrackData = output;
+	return true;
 }
 
 void SectorBasedDisk::flushCaches()
 {
 	Disk::flushCaches();
-	cachedTrackNum = -1;
+	trackCache.clear();
+}
+
+void SectorBasedDisk::sectorWritten(size_t sector)
+{
+	Disk::flushCaches(); // e.g. sha1sum
+
+	// Only drop the tracks that contain this sector. A track always
+	// contains 9 sectors (see encodeTrack()), on disks with fewer sectors
+	// per track that overlaps with the next track.
+	trackCache.erase(std::remove_if(begin(trackCache), end(trackCache),
+		[&](const CachedTrack& c) {
+			return (c.firstSector <= sector) &&
+			       (sector < (c.firstSector + 9));
+		}), end(trackCache));
 }
 
 size_t SectorBasedDisk::getNbSectorsImpl() const
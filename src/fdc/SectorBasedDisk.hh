@@ -3,6 +3,8 @@
 
 #include "Disk.hh"
 #include "RawTrack.hh"
+#include <memory>
+#include <vector>
 
 namespace openmsx {
 
@@ -16,6 +18,7 @@ protected:
 	explicit SectorBasedDisk(DiskName name);
 	void detectGeometry() override;
 	void flushCaches() override;
+	void sectorWritten(size_t sector) override;
 
 	void setNbSectors(size_t num);
 
@@ -26,12 +29,20 @@ private:
 	// Disk
 	size_t getNbSectorsImpl() const override;
 	void readTrack(byte track, byte side, RawTrack& output) override;
+	std::shared_ptr<const RawTrack> readTrackShared(byte track, byte side) override;
 	void writeTrackImpl(byte track, byte side, const RawTrack& input) override;
 
+	bool encodeTrack(byte track, byte side, RawTrack& output);
+
 	size_t nbSectors;
 
-	RawTrack cachedTrackData;
-	int cachedTrackNum;
+	// The most recently read tracks, most recent first.
+	struct CachedTrack {
+		std::shared_ptr<const RawTrack> data;
+		size_t firstSector; // logical sector number of the 1st sector
+		int num; // track | (side << 8)
+	};
+	std::vector<CachedTrack> trackCache;
 };
 
 } // namespace openmsx
@@ -1,6 +1,7 @@
 #include "HD.hh"
 #include "FileContext.hh"
 #include "FileException.hh"
+#include "FileOperations.hh"
 #include "FilePool.hh"
 #include "DeviceConfig.hh"
 #include "CliComm.hh"
@@ -12,10 +13,12 @@
 #include "MSXException.hh"
 #include "HDCommand.hh"
 #include "Timer.hh"
+#include "tiger.hh"
 #include "serialize.hh"
 #include "xrange.hh"
 #include <cassert>
 #include <memory>
+#include <vector>
 
 namespace openmsx {
 
@@ -59,8 +62,10 @@ HD::HD(const DeviceConfig& config)
 		file.truncate(size_t(config.getChildDataAsInt("size")) * 1024 * 1024);
 		filesize = file.getSize();
 	}
-	tigerTree = std::make_unique<TigerTree>(
-		*this, filesize, filename.getResolved());
+	createTigerTree();
+	// Changes made by a hidden machine must not end up in the image. This
+	// also keeps them out of the (shared) tiger-tree.
+	if (motherBoard.isHidden()) enableWriteOverlay();
 
 	(*hdInUse)[id] = true;
 	hdCommand = std::make_unique<HDCommand>(
@@ -75,6 +80,10 @@ HD::HD(const DeviceConfig& config)
 
 HD::~HD()
 {
+	// The in-memory tree outlives this HD (it's shared with the HD of the
+	// next machine after a reverse or loadstate), so only save when it
+	// changed.
+	saveTigerTree();
 	motherBoard.getMSXCliComm().update(CliComm::HARDWARE, name, "remove");
 
 	unsigned id = name[2] - 'a';
@@ -84,15 +93,59 @@ HD::~HD()
 
 void HD::switchImage(const Filename& newFilename)
 {
-	file = File(newFilename);
+	File newFile(newFilename);
+	saveTigerTree();
+	file = std::move(newFile);
 	filename = newFilename;
 	filesize = file.getSize();
-	tigerTree = std::make_unique<TigerTree>(*this, filesize,
-			filename.getResolved());
+	createTigerTree();
 	motherBoard.getMSXCliComm().update(CliComm::MEDIA, getName(),
 	                                   filename.getResolved());
 }
 
+// The upper part of the tiger-tree is stored on disk (in the user data
+// directory, one file per image), so that after a restart the first
+// savestate of a large image doesn't need to hash the whole image again.
+static std::string getTigerTreeCacheFile(const std::string& imageName)
+{
+	TigerHash h;
+	tiger(reinterpret_cast<const uint8_t*>(imageName.data()),
+	      imageName.size(), h);
+	return FileOperations::join(
+		FileOperations::getUserDataDir(), "tthcache", h.toString());
+}
+
+void HD::createTigerTree()
+{
+	const auto& resolved = filename.getResolved();
+	tigerTree = std::make_unique<TigerTree>(*this, filesize, resolved);
+	// Only needed after a restart or when switching to another image.
+	if (motherBoard.isHidden() || !tigerTree->isEmpty()) return;
+	try {
+		File cacheFile(getTigerTreeCacheFile(resolved), File::LOAD_PERSISTENT);
+		size_t size;
+		const byte* data = cacheFile.mmap(size);
+		tigerTree->loadCache(data, size);
+	} catch (FileException&) {
+		// no (readable) cache, the hash is calculated from scratch
+	}
+}
+
+void HD::saveTigerTree()
+{
+	// Leave it to the actual machine.
+	if (motherBoard.isHidden()) return;
+	std::vector<uint8_t> buf;
+	if (!tigerTree || !tigerTree->saveCache(buf)) return;
+	try {
+		File cacheFile(getTigerTreeCacheFile(filename.getResolved()),
+		               File::SAVE_PERSISTENT);
+		cacheFile.write(buf.data(), buf.size());
+	} catch (FileException&) {
+		// ignore, the cache is only an optimization
+	}
+}
+
 size_t HD::getNbSectorsImpl() const
 {
 	return filesize / sizeof(SectorBuffer);
@@ -53,6 +53,8 @@ private:
 	uint8_t* getData(size_t offset, size_t size) override;
 	bool isCacheStillValid(time_t& time) override;
 
+	void createTigerTree();
+	void saveTigerTree();
 	void showProgress(size_t position, size_t maxPosition);
 
 	MSXMotherBoard& motherBoard;
@@ -334,7 +334,9 @@ unsigned SCSILS120::requestSense()
 
 bool SCSILS120::checkReadOnly()
 {
-	if (file.isReadOnly()) {
+	// The LS-120 accesses the file directly, bypassing the write overlay
+	// of SectorAccessibleDisk. So a hidden machine can't write at all.
+	if (file.isReadOnly() || motherBoard.isHidden()) {
 		keycode = SCSI::SENSE_WRITE_PROTECT;
 		return true;
 	}
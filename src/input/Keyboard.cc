@@ -690,6 +690,12 @@ void Keyboard::processCmd(Interpreter& interp, array_ref<TclObject> tokens, bool
 	if (mask >= 256) {
 		throw CommandException("Invalid mask");
 	}
+	changeCmdKeyMatrix(row, mask, up);
+}
+
+void Keyboard::changeCmdKeyMatrix(byte row, byte mask, bool up)
+{
+	assert(row < KeyMatrixPosition::NUM_ROWS);
 	if (up) {
 		cmdKeyMatrix[row] |= mask;
 	} else {
@@ -63,6 +63,12 @@ public:
 
 	void transferHostKeyMatrix(const Keyboard& source);
 
+	/** Same as the 'keymatrixup'/'keymatrixdown' commands (but it's not
+	  * recorded as a state change). Used to give the hidden machines of
+	  * CloneRunner their own input.
+	  */
+	void changeCmdKeyMatrix(byte row, byte mask, bool up);
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
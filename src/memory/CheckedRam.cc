@@ -56,6 +56,16 @@ byte* CheckedRam::getWriteCacheLine(unsigned addr) const
 	     ? const_cast<byte*>(&ram[addr]) : nullptr;
 }
 
+byte* CheckedRam::getRWCacheLines(unsigned addr, unsigned size) const
+{
+	unsigned first = addr >> CacheLine::BITS;
+	unsigned num = size >> CacheLine::BITS;
+	for (unsigned i = 0; i < num; ++i) {
+		if (!completely_initialized_cacheline[first + i]) return nullptr;
+	}
+	return const_cast<byte*>(&ram[addr]);
+}
+
 void CheckedRam::write(unsigned addr, const byte value)
 {
 	unsigned line = addr >> CacheLine::BITS;
@@ -37,6 +37,10 @@ public:
 
 	const byte* getReadCacheLine(unsigned addr) const;
 	byte* getWriteCacheLine(unsigned addr) const;
+	/** Like getWriteCacheLine(), but for the (cache line aligned)
+	  * interval [addr, addr + size). Only returns a pointer when all
+	  * lines in the interval are cacheable. */
+	byte* getRWCacheLines(unsigned addr, unsigned size) const;
 
 	unsigned getSize() const { return ram.getSize(); }
 	void clear();
@@ -69,10 +69,12 @@ byte MSXMapperIO::peekIO(word port, EmuTime::param time) const
 
 void MSXMapperIO::writeIO(word port, byte value, EmuTime::param time)
 {
+	// Invalidate first, the mapper that's visible in this page may then
+	// directly fill in the cache again (see MSXMemoryMapper::writeIO()).
+	invalidateMemCache(0x4000 * (port & 0x03), 0x4000);
 	for (auto* mapper : mappers) {
 		mapper->writeIO(port, value, time);
 	}
-	invalidateMemCache(0x4000 * (port & 0x03), 0x4000);
 }
 
 
@@ -25,6 +25,7 @@ MSXMemoryMapper::MSXMemoryMapper(const DeviceConfig& config)
 	, MSXMapperIOClient(getMotherBoard())
 	, checkedRam(config, getName(), "memory mapper", getRamSize())
 	, debuggable(getMotherBoard(), getName())
+	, segmentCache(true)
 {
 }
 
@@ -59,7 +60,15 @@ byte MSXMemoryMapper::peekIO(word port, EmuTime::param /*time*/) const
 void MSXMemoryMapper::writeIO(word port, byte value, EmuTime::param /*time*/)
 {
 	unsigned numSegments = checkedRam.getSize() / 0x4000;
-	registers[port & 0x03] = value & (Math::powerOfTwo(numSegments) - 1);
+	unsigned page = port & 0x03;
+	registers[page] = value & (Math::powerOfTwo(numSegments) - 1);
+	if (segmentCache) {
+		byte* data = checkedRam.getRWCacheLines(
+			calcAddress(0x4000 * page), 0x4000);
+		fillMemCache(0x4000 * page, 0x4000, data, data);
+	} else {
+		invalidateMemCache(0x4000 * page, 0x4000);
+	}
 }
 
 unsigned MSXMemoryMapper::calcAddress(word address) const
@@ -43,6 +43,13 @@ protected:
 	  */
 	unsigned calcAddress(word address) const;
 
+	/** By default writeIO() directly puts the newly selected segment in
+	  * the CPU cache (see MSXDevice::fillMemCache()). Subclasses that
+	  * override getReadCacheLine() or getWriteCacheLine() must call this
+	  * in their constructor.
+	  */
+	void disableSegmentCache() { segmentCache = false; }
+
 	CheckedRam checkedRam;
 	byte registers[4];
 
@@ -54,6 +61,8 @@ private:
 		byte read(unsigned address) override;
 		void write(unsigned address, byte value) override;
 	} debuggable;
+
+	bool segmentCache;
 };
 SERIALIZE_CLASS_VERSION(MSXMemoryMapper, 2);
 
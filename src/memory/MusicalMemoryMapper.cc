@@ -16,6 +16,7 @@ MusicalMemoryMapper::MusicalMemoryMapper(const DeviceConfig& config)
 	, sn76489(std::make_unique<SN76489>(config))
 	, controlReg(0x00)
 {
+	disableSegmentCache(); // see getReadCacheLine()/getWriteCacheLine()
 }
 
 MusicalMemoryMapper::~MusicalMemoryMapper() = default;
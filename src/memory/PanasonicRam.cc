@@ -9,6 +9,7 @@ PanasonicRam::PanasonicRam(const DeviceConfig& config)
 	: MSXMemoryMapper(config)
 	, panasonicMemory(getMotherBoard().getPanasonicMemory())
 {
+	disableSegmentCache(); // see getWriteCacheLine()
 	panasonicMemory.registerRam(checkedRam.getUncheckedRam());
 }
 
@@ -28,6 +28,7 @@ RomAscii8_8::RomAscii8_8(const DeviceConfig& config,
 	, sramPages(((subType == KOEI_8) || (subType == KOEI_32))
 	            ? 0x34 : 0x30)
 {
+	disableBankCache(); // SRAM banks are mirrored, see getReadCacheLine()
 	unsigned size = (subType == KOEI_32 || subType == ASCII8_32) ? 0x8000  // 32kB
 	              : (subType == ASCII8_2) ? 0x0800  //  2kB
 	                                      : 0x2000; //  8kB
@@ -24,6 +24,7 @@ RomBlocks<BANK_SIZE>::RomBlocks(
 	, romBlockDebug(
 		*this,  blockNr, 0x0000, 0x10000,
 		log2<BANK_SIZE>::value, debugBankSizeShift)
+	, bankCache(true)
 {
 	static_assert(Math::isPowerOfTwo(BANK_SIZE), "BANK_SIZE must be a power of two");
 	auto extendedSize = (rom.getSize() + BANK_SIZE - 1) & ~(BANK_SIZE - 1);
@@ -84,7 +85,11 @@ void RomBlocks<BANK_SIZE>::setBank(byte region, const byte* adr, int block)
 	        ((extraMem <= adr) && (adr <= &extraMem[extraSize - 1]))));
 	bankPtr[region] = adr;
 	blockNr[region] = block; // only for debuggable
-	invalidateMemCache(region * BANK_SIZE, BANK_SIZE);
+	if (bankCache) {
+		fillMemCache(region * BANK_SIZE, BANK_SIZE, adr, nullptr);
+	} else {
+		invalidateMemCache(region * BANK_SIZE, BANK_SIZE);
+	}
 }
 
 template <unsigned BANK_SIZE>
@@ -78,6 +78,15 @@ protected:
 	 */
 	void setExtraMemory(const byte* mem, unsigned size);
 
+	/** By default setBank() directly puts the newly selected bank in the
+	  * CPU cache (see MSXDevice::fillMemCache()), so that frequent bank
+	  * switches are cheap. Subclasses whose getReadCacheLine() doesn't
+	  * simply return the selected bank for all cache lines must call
+	  * this in their constructor, then setBank() only invalidates the
+	  * CPU cache.
+	  */
+	void disableBankCache() { bankCache = false; }
+
 	const byte* bankPtr[NUM_BANKS];
 	std::unique_ptr<SRAM> sram; // can be nullptr
 	byte blockNr[NUM_BANKS];
@@ -88,6 +97,7 @@ private:
 	unsigned extraSize;
 	/*const*/ unsigned nrBlocks;
 	int blockMask;
+	bool bankCache;
 };
 
 using Rom4kBBlocks  = RomBlocks<0x1000>;
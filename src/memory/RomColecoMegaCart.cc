@@ -11,6 +11,7 @@ namespace openmsx {
 RomColecoMegaCart::RomColecoMegaCart(const DeviceConfig& config, Rom&& rom_)
 	: Rom16kBBlocks(config, std::move(rom_))
 {
+	disableBankCache(); // mapper registers aren't cached
 	size_t size = rom.getSize() / 1024;
 	if ((size != 128) && (size != 256) && (size != 512) && (size != 1024)) {
 		throw MSXException(
@@ -161,6 +161,7 @@ RomFSA1FM2::RomFSA1FM2(const DeviceConfig& config, Rom&& rom_)
 	: Rom8kBBlocks(config, std::move(rom_))
 	, fsSram(getSram(config))
 {
+	disableBankCache(); // SRAM and IO area, see getReadCacheLine()
 	reset(EmuTime::dummy());
 }
 
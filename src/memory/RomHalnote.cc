@@ -35,6 +35,7 @@ namespace openmsx {
 RomHalnote::RomHalnote(const DeviceConfig& config, Rom&& rom_)
 	: Rom8kBBlocks(config, std::move(rom_))
 {
+	disableBankCache(); // sub-mapper, see getReadCacheLine()
 	if (rom.getSize() != 0x100000) {
 		throw MSXException(
 			"Rom for HALNOTE mapper must be exactly 1MB in size.");
@@ -46,6 +46,7 @@ void RomKonamiSCC::powerUp(EmuTime::param time)
 
 void RomKonamiSCC::reset(EmuTime::param time)
 {
+	sccEnabled = false;
 	setUnmapped(0);
 	setUnmapped(1);
 	for (int i = 2; i < 6; i++) {
@@ -54,7 +55,6 @@ void RomKonamiSCC::reset(EmuTime::param time)
 	setUnmapped(6);
 	setUnmapped(7);
 
-	sccEnabled = false;
 	scc.reset(time);
 }
 
@@ -103,7 +103,12 @@ void RomKonamiSCC::writeMem(word address, byte value, EmuTime::param time)
 	}
 	if ((address & 0x1800) == 0x1000) {
 		// page selection
-		setRom(address >> 13, value);
+		byte region = address >> 13;
+		setRom(region, value);
+		if (sccEnabled && (region == 4)) {
+			// setRom() also cached the SCC area
+			invalidateMemCache(0x9800, 0x0800);
+		}
 	}
 }
 
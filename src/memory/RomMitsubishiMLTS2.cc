@@ -10,6 +10,7 @@ RomMitsubishiMLTS2::RomMitsubishiMLTS2(const DeviceConfig& config, Rom&& rom_)
 	: Rom8kBBlocks(config, std::move(rom_))
 	, ram(config, getName() + " RAM", "ML-TS2 RAM", 0x2000)
 {
+	disableBankCache(); // RAM and IO area, see getReadCacheLine()
 	reset(EmuTime::dummy());
 }
 
@@ -9,6 +9,7 @@ namespace openmsx {
 RomNational::RomNational(const DeviceConfig& config, Rom&& rom_)
 	: Rom16kBBlocks(config, std::move(rom_))
 {
+	disableBankCache(); // mapper registers aren't cached
 	sram = std::make_unique<SRAM>(getName() + " SRAM", 0x1000, config);
 	reset(EmuTime::dummy());
 }
@@ -16,6 +16,7 @@ RomPanasonic::RomPanasonic(const DeviceConfig& config, Rom&& rom_)
 	: Rom8kBBlocks(config, std::move(rom_))
 	, panasonicMem(getMotherBoard().getPanasonicMemory())
 {
+	disableBankCache(); // mapper registers aren't cached
 	unsigned sramSize = config.getChildDataAsInt("sramsize", 0);
 	if (sramSize) {
 		sram = std::make_unique<SRAM>(
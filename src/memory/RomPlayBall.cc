@@ -12,6 +12,7 @@ RomPlayBall::RomPlayBall(const DeviceConfig& config, Rom&& rom_)
 		strCat(FileOperations::stripExtension(rom.getFilename()), '_'),
 		15, "playball/playball_")
 {
+	disableBankCache(); // DAC register isn't cached
 	setUnmapped(0);
 	setRom(1, 0);
 	setRom(2, 1);
@@ -4,6 +4,7 @@
 #include "FileContext.hh"
 #include "FileException.hh"
 #include "FileNotFoundException.hh"
+#include "MSXMotherBoard.hh"
 #include "Reactor.hh"
 #include "CliComm.hh"
 #include "serialize.hh"
@@ -39,7 +40,7 @@ SRAM::SRAM(const std::string& name, const std::string& description,
 
 SRAM::SRAM(const string& name, int size,
            const DeviceConfig& config_, const char* header_, bool* loaded)
-	: schedulable(std::make_unique<SRAMSchedulable>(config_.getReactor().getRTScheduler(), *this))
+	: schedulable(createSchedulable(config_))
 	, config(config_)
 	, ram(config, name, "sram", size)
 	, header(header_)
@@ -49,7 +50,7 @@ SRAM::SRAM(const string& name, int size,
 
 SRAM::SRAM(const string& name, const string& description, int size,
 	   const DeviceConfig& config_, const char* header_, bool* loaded)
-	: schedulable(std::make_unique<SRAMSchedulable>(config_.getReactor().getRTScheduler(), *this))
+	: schedulable(createSchedulable(config_))
 	, config(config_)
 	, ram(config, name, description, size)
 	, header(header_)
@@ -64,6 +65,18 @@ SRAM::~SRAM()
 	}
 }
 
+// A hidden machine (see RunAheadManager and CloneRunner) keeps its SRAM in
+// memory only: it gets the content from the savestate of the actual machine
+// and it must not overwrite the file with its speculative content. It may
+// also run on another thread, so it must not use the (global) RTScheduler.
+std::unique_ptr<SRAM::SRAMSchedulable> SRAM::createSchedulable(
+	const DeviceConfig& config_)
+{
+	if (config_.getMotherBoard().isHidden()) return nullptr;
+	return std::make_unique<SRAMSchedulable>(
+		config_.getReactor().getRTScheduler(), *this);
+}
+
 void SRAM::write(unsigned addr, byte value)
 {
 	if (schedulable && !schedulable->isPendingRT()) {
@@ -86,6 +99,7 @@ void SRAM::load(bool* loaded)
 {
 	assert(config.getXML());
 	if (loaded) *loaded = false;
+	if (config.getMotherBoard().isHidden()) return; // see createSchedulable()
 	const string& filename = config.getChildData("sramname");
 	try {
 		bool headerOk = true;
@@ -50,6 +50,8 @@ private:
 	};
 	std::unique_ptr<SRAMSchedulable> schedulable;
 
+	std::unique_ptr<SRAMSchedulable> createSchedulable(
+		const DeviceConfig& config);
 	void load(bool* loaded);
 	void save();
 
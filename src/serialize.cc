@@ -42,7 +42,7 @@ unsigned OutputArchiveBase2::generateID1(const void* p)
 	#endif
 	++lastId;
 	assert(polyIdMap.find(p) == end(polyIdMap));
-	polyIdMap[p] = lastId;
+	polyIdMap.emplace_noDuplicateCheck(p, lastId);
 	return lastId;
 }
 unsigned OutputArchiveBase2::generateID2(
@@ -55,7 +55,7 @@ unsigned OutputArchiveBase2::generateID2(
 	++lastId;
 	auto key = std::make_pair(p, std::type_index(typeInfo));
 	assert(idMap.find(key) == end(idMap));
-	idMap[key] = lastId;
+	idMap.emplace_noDuplicateCheck(key, lastId);
 	return lastId;
 }
 
@@ -67,7 +67,7 @@ unsigned OutputArchiveBase2::getID1(const void* p)
 unsigned OutputArchiveBase2::getID2(
 	const void* p, const std::type_info& typeInfo)
 {
-	auto it = idMap.find({p, std::type_index(typeInfo)});
+	auto it = idMap.find(std::make_pair(p, std::type_index(typeInfo)));
 	return it != end(idMap) ? it->second : 0;
 }
 
@@ -114,20 +114,33 @@ template class OutputArchiveBase<XmlOutputArchive>;
 
 void* InputArchiveBase2::getPointer(unsigned id)
 {
-	auto it = idMap.find(id);
-	return it != end(idMap) ? it->second : nullptr;
+	return (id < idMap.size()) ? idMap[id] : nullptr;
 }
 
 void InputArchiveBase2::addPointer(unsigned id, const void* p)
 {
-	assert(idMap.find(id) == end(idMap));
+	assert(p);
+	// The id comes from the archive, so don't trust it. IDs are assigned
+	// sequentially (starting at 1, 0 means nullptr). Only the IDs in
+	// skipped (e.g. obsolete) tags leave a gap, so an id far beyond the
+	// current size means the archive is corrupt.
+	static const size_t MAX_ID_GAP = 0x10000;
+	if ((id == 0) || (id > (idMap.size() + MAX_ID_GAP))) {
+		throw MSXException("Invalid object id in savestate: ", id);
+	}
+	if (id >= idMap.size()) {
+		idMap.resize(id + 1, nullptr);
+	}
+	if (idMap[id]) {
+		throw MSXException("Duplicate object id in savestate: ", id);
+	}
 	idMap[id] = const_cast<void*>(p);
 }
 
 unsigned InputArchiveBase2::getId(const void* ptr) const
 {
-	for (const auto& p : idMap) {
-		if (p.second == ptr) return p.first;
+	for (unsigned id = 1; id < idMap.size(); ++id) {
+		if (idMap[id] == ptr) return id;
 	}
 	return 0;
 }
@@ -245,7 +258,8 @@ void MemInputArchive::serialize_blob(const char* /*tag*/, void* data,
 		// is possible that certain blobs are stored in the savestate,
 		// but skipped while loading. That's why we do need the index.
 		unsigned deltaBlockIdx; load(deltaBlockIdx);
-		deltaBlocks[deltaBlockIdx]->apply(static_cast<uint8_t*>(data), len);
+		deltaBlocks[deltaBlockIdx]->apply(
+			static_cast<uint8_t*>(data), len, cache);
 	} else {
 		memcpy(data, buffer.getCurrentPos(), len);
 		buffer.skip(len);
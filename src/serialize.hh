@@ -5,6 +5,7 @@
 #include "SerializeBuffer.hh"
 #include "XMLElement.hh"
 #include "MemBuffer.hh"
+#include "hash_map.hh"
 #include "inline.hh"
 #include "strCat.hh"
 #include "unreachable.hh"
@@ -13,7 +14,6 @@
 #include <typeindex>
 #include <type_traits>
 #include <vector>
-#include <map>
 #include <sstream>
 #include <cassert>
 #include <memory>
@@ -22,6 +22,7 @@ namespace openmsx {
 
 class LastDeltaBlocks;
 class DeltaBlock;
+class DeltaBlockCache;
 
 template<typename T> struct SerializeClassVersion;
 
@@ -325,6 +326,21 @@ protected:
 	}
 };
 
+// Hash functions for the pointer->id maps in the archives. hash_map only uses
+// the lower bits of the hash value, but for (aligned) pointers those are
+// mostly zero, so mix all bits into the result.
+struct PointerHasher {
+	uint32_t operator()(const void* p) const {
+		auto v = uint64_t(reinterpret_cast<uintptr_t>(p));
+		return uint32_t((v * 0x9E3779B97F4A7C15ull) >> 32);
+	}
+};
+struct PointerTypeHasher {
+	uint32_t operator()(const std::pair<const void*, std::type_index>& k) const {
+		return PointerHasher()(k.first) ^ uint32_t(k.second.hash_code());
+	}
+};
+
 // The part of OutputArchiveBase that doesn't depend on the template parameter
 class OutputArchiveBase2
 {
@@ -402,8 +418,8 @@ private:
 	unsigned getID1(const void* p);
 	unsigned getID2(const void* p, const std::type_info& typeInfo);
 
-	std::map<std::pair<const void*, std::type_index>, unsigned> idMap;
-	std::map<const void*, unsigned> polyIdMap;
+	hash_map<std::pair<const void*, std::type_index>, unsigned, PointerTypeHasher> idMap;
+	hash_map<const void*, unsigned, PointerHasher> polyIdMap;
 	unsigned lastId;
 };
 
@@ -509,7 +525,7 @@ public:
 		auto it = sharedPtrMap.find(r);
 		if (it == end(sharedPtrMap)) {
 			s.reset(r);
-			sharedPtrMap[r] = s;
+			sharedPtrMap.emplace_noDuplicateCheck(r, s);
 		} else {
 			s = std::static_pointer_cast<T>(it->second);
 		}
@@ -519,8 +535,10 @@ protected:
 	InputArchiveBase2() {}
 
 private:
-	std::map<unsigned, void*> idMap;
-	std::map<void*, std::shared_ptr<void>> sharedPtrMap;
+	// The IDs are generated sequentially while saving, and the objects
+	// are loaded in the same order, so index this vector by ID.
+	std::vector<void*> idMap;
+	hash_map<void*, std::shared_ptr<void>, PointerHasher> sharedPtrMap;
 };
 
 template<typename Derived>
@@ -664,9 +682,11 @@ class MemInputArchive final : public InputArchiveBase<MemInputArchive>
 {
 public:
 	MemInputArchive(const byte* data, size_t size,
-	                const std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks_)
+	                const std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks_,
+	                DeltaBlockCache* cache_ = nullptr)
 		: buffer(data, size)
 		, deltaBlocks(deltaBlocks_)
+		, cache(cache_)
 	{
 	}
 
@@ -712,6 +732,7 @@ private:
 
 	InputBuffer buffer;
 	const std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks;
+	DeltaBlockCache* cache;
 };
 
 ////
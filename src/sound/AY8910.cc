@@ -12,6 +12,7 @@
 #include "AY8910Periphery.hh"
 #include "DeviceConfig.hh"
 #include "GlobalSettings.hh"
+#include "MSXMotherBoard.hh"
 #include "MSXException.hh"
 #include "Math.hh"
 #include "StringOp.hh"
@@ -478,6 +479,7 @@ AY8910::AY8910(const std::string& name_, AY8910Periphery& periphery_,
 		"frequency of detune effect in Hertz", 5.0, 1.0, 100.0)
 	, directionsCallback(
 		config.getGlobalSettings().getInvalidPsgDirectionsSetting())
+	, useCallbacks(!config.getMotherBoard().isHidden())
 	, amplitude(config)
 	, envelope(amplitude.getEnvVolTable())
 	, isAY8910(checkAY8910(config))
@@ -577,7 +579,7 @@ void AY8910::wrtReg(unsigned reg, byte value, EmuTime::param time)
 {
 	// Warn/force port directions
 	if (reg == AY_ENABLE) {
-		if (value & PORT_A_DIRECTION) {
+		if ((value & PORT_A_DIRECTION) && useCallbacks) {
 			directionsCallback.execute();
 		}
 		// portA -> input
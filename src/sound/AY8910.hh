@@ -180,6 +180,7 @@ private:
 	FloatSetting detunePercent;
 	FloatSetting detuneFrequency;
 	TclCallback directionsCallback;
+	const bool useCallbacks; // not in hidden machines
 	ToneGenerator tone[3];
 	NoiseGenerator noise;
 	Amplitude amplitude;
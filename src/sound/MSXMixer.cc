@@ -11,6 +11,7 @@
 #include "BooleanSetting.hh"
 #include "CommandException.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExporter.hh"
 #include "Filename.hh"
 #include "CliComm.hh"
 #include "Math.hh"
@@ -47,6 +48,7 @@ MSXMixer::MSXMixer(Mixer& mixer_, MSXMotherBoard& motherBoard_,
 	, prevTime(getCurrentTime(), 44100)
 	, soundDeviceInfo(commandController.getMachineInfoCommand())
 	, recorder(nullptr)
+	, exporter(nullptr)
 	, synchronousCounter(0)
 {
 	hostSampleRate = 44100;
@@ -67,6 +69,9 @@ MSXMixer::~MSXMixer()
 	if (recorder) {
 		recorder->stop();
 	}
+	if (exporter) {
+		exporter->stop();
+	}
 	assert(infos.empty());
 
 	throttleManager.detach(*this);
@@ -181,6 +186,9 @@ void MSXMixer::updateStream(EmuTime::param time)
 	if (recorder) {
 		recorder->addWave(count, mixBuffer);
 	}
+	if (exporter) {
+		exporter->addWave(count, mixBuffer, time);
+	}
 
 	prevTime += count;
 }
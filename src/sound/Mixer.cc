@@ -2,9 +2,11 @@
 #include "MSXMixer.hh"
 #include "NullSoundDriver.hh"
 #include "SDLSoundDriver.hh"
+#include "PipeSoundDriver.hh"
 #include "CommandController.hh"
 #include "CliComm.hh"
 #include "MSXException.hh"
+#include "FileOperations.hh"
 #include "stl.hh"
 #include "unreachable.hh"
 #include "components.hh"
@@ -27,6 +29,9 @@ static EnumSetting<Mixer::SoundDriverType>::Map getSoundDriverMap()
 	EnumSetting<Mixer::SoundDriverType>::Map soundDriverMap = {
 		{ "null", Mixer::SND_NULL },
 		{ "sdl",  Mixer::SND_SDL } };
+#ifndef _WIN32
+	soundDriverMap.emplace_back("pipe", Mixer::SND_PIPE);
+#endif
 	return soundDriverMap;
 }
 
@@ -49,12 +54,17 @@ Mixer::Mixer(Reactor& reactor_, CommandController& commandController_)
 	, samplesSetting(
 		commandController, "samples",
 		"mixer samples", defaultsamples, 64, 8192)
+	, pipeFilenameSetting(
+		commandController, "sound_pipe_filename",
+		"file or named pipe where the 'pipe' sound driver writes the "
+		"raw sound samples to", "openmsx.pcm")
 	, muteCount(0)
 {
-	muteSetting       .attach(*this);
-	frequencySetting  .attach(*this);
-	samplesSetting    .attach(*this);
-	soundDriverSetting.attach(*this);
+	muteSetting        .attach(*this);
+	frequencySetting   .attach(*this);
+	samplesSetting     .attach(*this);
+	soundDriverSetting .attach(*this);
+	pipeFilenameSetting.attach(*this);
 
 	// Set correct initial mute state.
 	if (muteSetting.getBoolean()) ++muteCount;
@@ -67,10 +77,11 @@ Mixer::~Mixer()
 	assert(msxMixers.empty());
 	driver.reset();
 
-	soundDriverSetting.detach(*this);
-	samplesSetting    .detach(*this);
-	frequencySetting  .detach(*this);
-	muteSetting       .detach(*this);
+	pipeFilenameSetting.detach(*this);
+	soundDriverSetting .detach(*this);
+	samplesSetting     .detach(*this);
+	frequencySetting   .detach(*this);
+	muteSetting        .detach(*this);
 }
 
 void Mixer::reloadDriver()
@@ -92,6 +103,16 @@ void Mixer::reloadDriver()
 				frequencySetting.getInt(),
 				samplesSetting.getInt());
 			break;
+#ifndef _WIN32
+		case SND_PIPE:
+			driver = std::make_unique<PipeSoundDriver>(
+				reactor,
+				FileOperations::expandTilde(
+					pipeFilenameSetting.getString()),
+				frequencySetting.getInt(),
+				samplesSetting.getInt());
+			break;
+#endif
 		default:
 			UNREACHABLE;
 		}
@@ -167,6 +188,10 @@ void Mixer::update(const Setting& setting)
 	           (&setting == &soundDriverSetting) ||
 	           (&setting == &frequencySetting)) {
 		reloadDriver();
+	} else if (&setting == &pipeFilenameSetting) {
+		if (soundDriverSetting.getEnum() == SND_PIPE) {
+			reloadDriver();
+		}
 	} else {
 		UNREACHABLE;
 	}
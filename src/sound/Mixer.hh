@@ -4,6 +4,7 @@
 #include "Observer.hh"
 #include "BooleanSetting.hh"
 #include "EnumSetting.hh"
+#include "FilenameSetting.hh"
 #include "IntegerSetting.hh"
 #include <vector>
 #include <memory>
@@ -18,7 +19,7 @@ class MSXMixer;
 class Mixer final : private Observer<Setting>
 {
 public:
-	enum SoundDriverType { SND_NULL, SND_SDL, SND_DIRECTX };
+	enum SoundDriverType { SND_NULL, SND_SDL, SND_DIRECTX, SND_PIPE };
 
 	Mixer(Reactor& reactor, CommandController& commandController);
 	~Mixer();
@@ -65,6 +66,7 @@ private:
 	IntegerSetting masterVolume;
 	IntegerSetting frequencySetting;
 	IntegerSetting samplesSetting;
+	FilenameSetting pipeFilenameSetting;
 
 	int muteCount;
 };
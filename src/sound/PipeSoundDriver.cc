@@ -0,0 +1,156 @@
+#include "PipeSoundDriver.hh"
+
+#ifndef _WIN32
+
+#include "Reactor.hh"
+#include "MSXMotherBoard.hh"
+#include "RealTime.hh"
+#include "GlobalSettings.hh"
+#include "ThrottleManager.hh"
+#include "CliComm.hh"
+#include "MSXException.hh"
+#include "Timer.hh"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace openmsx {
+
+PipeSoundDriver::PipeSoundDriver(
+		Reactor& reactor_, const std::string& filename_,
+		unsigned frequency_, unsigned samples_)
+	: reactor(reactor_)
+	, filename(filename_)
+	, frequency(frequency_)
+	, samples(samples_)
+	, partialSize(0)
+	, muted(true)
+{
+	// Open in non-blocking mode: for a named pipe that has no reader yet,
+	// this fails immediately instead of hanging the emulator.
+	fd = open(filename.c_str(),
+	          O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK | O_CLOEXEC, 0666);
+	if (fd == -1) {
+		if (errno == ENXIO) {
+			throw MSXException("Couldn't open ", filename,
+			                   ": no process is reading from this pipe.");
+		}
+		throw MSXException("Couldn't open ", filename, ": ",
+		                   strerror(errno));
+	}
+#ifdef F_SETPIPE_SZ
+	// Keep the latency low: only allow a few fragments in the pipe (this
+	// fails for regular files, that's fine).
+	fcntl(fd, F_SETPIPE_SZ, int(3 * samples * 2 * sizeof(int16_t)));
+#endif
+	// When the reader goes away, writing to the pipe raises SIGPIPE, which
+	// by default terminates the process. Instead let write() return EPIPE.
+	prevSigPipe = signal(SIGPIPE, SIG_IGN);
+}
+
+PipeSoundDriver::~PipeSoundDriver()
+{
+	if (fd != -1) close(fd);
+	signal(SIGPIPE, prevSigPipe);
+}
+
+void PipeSoundDriver::mute()
+{
+	muted = true;
+}
+
+void PipeSoundDriver::unmute()
+{
+	muted = false;
+}
+
+unsigned PipeSoundDriver::getFrequency() const
+{
+	return frequency;
+}
+
+unsigned PipeSoundDriver::getSamples() const
+{
+	return samples;
+}
+
+void PipeSoundDriver::uploadBuffer(int16_t* buffer, unsigned len)
+{
+	if ((fd == -1) || muted) return;
+
+	// Even when throttled, don't wait forever for a reader that is stuck.
+	static const uint64_t MAX_WAIT = 1000000; // in us
+	uint64_t deadline = Timer::getTime() + MAX_WAIT;
+	bool throttle = reactor.getGlobalSettings().getThrottleManager().isThrottled();
+
+	// First finish the sample that was cut off the previous time, otherwise
+	// the rest of the stream would be misaligned.
+	if (partialSize) {
+		const char* data = partial;
+		size_t size = partialSize;
+		bool done = writeData(data, size, throttle, deadline);
+		memmove(partial, data, size);
+		partialSize = unsigned(size);
+		if (!done) return; // drop this whole buffer
+	}
+
+	static const size_t FRAME = 2 * sizeof(int16_t); // stereo
+	auto* data = reinterpret_cast<const char*>(buffer);
+	size_t size = len * FRAME;
+	if (!writeData(data, size, throttle, deadline) && (fd != -1)) {
+		// The pipe is full (and we're not throttled or we waited too
+		// long). Drop the rest of this buffer, but remember the rest of
+		// the sample that was cut off.
+		partialSize = unsigned(size % FRAME);
+		memcpy(partial, data, partialSize);
+	}
+}
+
+// Returns true when all data was written. Otherwise 'data' and 'size' describe
+// the part that wasn't written.
+bool PipeSoundDriver::writeData(const char*& data, size_t& size,
+                                bool wait, uint64_t deadline)
+{
+	while (size) {
+		ssize_t written = write(fd, data, size);
+		if (written >= 0) {
+			data += written;
+			size -= written;
+		} else if (errno == EINTR) {
+			// try again
+		} else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			if (!wait || (Timer::getTime() >= deadline)) return false;
+			waitWritable();
+		} else {
+			reactor.getCliComm().printWarning(
+				"Stopped writing sound to ", filename, ": ",
+				strerror(errno));
+			close(fd);
+			fd = -1;
+			return false;
+		}
+	}
+	return true;
+}
+
+void PipeSoundDriver::waitWritable()
+{
+	pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLOUT;
+	pfd.revents = 0;
+	poll(&pfd, 1, 5); // at most 5ms
+
+	// The reader determines the speed now, RealTime shouldn't try to
+	// catch up for the time we waited here.
+	if (MSXMotherBoard* board = reactor.getMotherBoard()) {
+		board->getRealTime().resync();
+	}
+}
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PIPESOUNDDRIVER_HH
+#define PIPESOUNDDRIVER_HH
+
+#include "SoundDriver.hh"
+#include <string>
+
+namespace openmsx {
+
+class Reactor;
+
+/** Writes the sound as raw samples (signed 16-bit, host byte order, stereo,
+  * left first) to a file or a named pipe (FIFO). This doesn't need SDL or
+  * any sound hardware, so it's useful to feed the sound to an external
+  * encoder or to test tools.
+  *
+  * When throttling is enabled, the emulation waits for the reader of the
+  * pipe (so the reader determines the emulation speed), but at most one
+  * second per buffer. Otherwise, samples that don't fit in the pipe are
+  * dropped.
+  *
+  * While this driver exists, SIGPIPE is ignored for the whole process (so
+  * that a reader that goes away doesn't terminate openMSX). send() with
+  * MSG_NOSIGNAL would avoid that, but it only works for sockets. The
+  * previous handler is restored in the destructor.
+  */
+class PipeSoundDriver final : public SoundDriver
+{
+public:
+	PipeSoundDriver(const PipeSoundDriver&) = delete;
+	PipeSoundDriver& operator=(const PipeSoundDriver&) = delete;
+
+	PipeSoundDriver(Reactor& reactor, const std::string& filename,
+	                unsigned frequency, unsigned samples);
+	~PipeSoundDriver();
+
+	void mute() override;
+	void unmute() override;
+
+	unsigned getFrequency() const override;
+	unsigned getSamples() const override;
+
+	void uploadBuffer(int16_t* buffer, unsigned len) override;
+
+private:
+	bool writeData(const char*& data, size_t& size,
+	               bool wait, uint64_t deadline);
+	void waitWritable();
+
+	Reactor& reactor;
+	const std::string filename;
+	const unsigned frequency;
+	const unsigned samples;
+	void (*prevSigPipe)(int);
+	int fd; // -1 after a write error
+	char partial[2 * sizeof(int16_t)]; // rest of a sample that was cut off
+	unsigned partialSize;
+	bool muted;
+};
+
+} // namespace openmsx
+
+#endif
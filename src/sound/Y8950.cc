@@ -13,7 +13,10 @@
 #include "cstd.hh"
 #include "outer.hh"
 #include "serialize.hh"
+#include "unreachable.hh"
+#include "vla.hh"
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <iostream>
 
@@ -672,23 +675,32 @@ static inline int wave2_8pi(int e)
 	return (shift > 0) ? (e >> shift) : (e << -shift);
 }
 
+template<bool HAS_PM>
 unsigned Y8950::Slot::calc_phase(int lfo_pm)
 {
-	if (patch.PM) {
+	assert(patch.PM == HAS_PM);
+	if (HAS_PM) {
 		phase += (dphase * lfo_pm) >> PM_AMP_BITS;
 	} else {
 		phase += dphase;
 	}
 	return phase >> DP_BASE_BITS;
 }
+unsigned Y8950::Slot::calc_phase(int lfo_pm)
+{
+	return patch.PM ? calc_phase<true >(lfo_pm)
+	                : calc_phase<false>(lfo_pm);
+}
 
 #define S2E(x) Y8950::EnvPhaseIndex(int((x) / EG_STEP))
 static constexpr Y8950::EnvPhaseIndex SL[16] = {
 	S2E( 0), S2E( 3), S2E( 6), S2E( 9), S2E(12), S2E(15), S2E(18), S2E(21),
 	S2E(24), S2E(27), S2E(30), S2E(33), S2E(36), S2E(39), S2E(42), S2E(93)
 };
+template<bool HAS_AM>
 unsigned Y8950::Slot::calc_envelope(int lfo_am)
 {
+	assert(patch.AM == HAS_AM);
 	unsigned egout = 0;
 	switch (eg_mode) {
 	case ATTACK:
@@ -741,25 +753,33 @@ unsigned Y8950::Slot::calc_envelope(int lfo_am)
 	}
 
 	egout = ((egout + tll) * EG_PER_DB);
-	if (patch.AM) {
+	if (HAS_AM) {
 		egout += lfo_am;
 	}
 	return std::min<unsigned>(egout, DB_MUTE - 1);
 }
+unsigned Y8950::Slot::calc_envelope(int lfo_am)
+{
+	return patch.AM ? calc_envelope<true >(lfo_am)
+	                : calc_envelope<false>(lfo_am);
+}
 
+template<bool HAS_PM, bool HAS_AM>
 int Y8950::Slot::calc_slot_car(int lfo_pm, int lfo_am, int fm)
 {
-	unsigned egout = calc_envelope(lfo_am);
-	int pgout = calc_phase(lfo_pm) + wave2_8pi(fm);
+	unsigned egout = calc_envelope<HAS_AM>(lfo_am);
+	int pgout = calc_phase<HAS_PM>(lfo_pm) + wave2_8pi(fm);
 	return dB2Lin.tab[sin.table[pgout & PG_MASK] + egout];
 }
 
+template<bool HAS_PM, bool HAS_AM, bool HAS_FB>
 int Y8950::Slot::calc_slot_mod(int lfo_pm, int lfo_am)
 {
-	unsigned egout = calc_envelope(lfo_am);
-	unsigned pgout = calc_phase(lfo_pm);
+	assert((patch.FB != 0) == HAS_FB);
+	unsigned egout = calc_envelope<HAS_AM>(lfo_am);
+	unsigned pgout = calc_phase<HAS_PM>(lfo_pm);
 
-	if (patch.FB != 0) {
+	if (HAS_FB) {
 		pgout += wave2_8pi(feedback) >> patch.FB;
 	}
 	int newOutput = dB2Lin.tab[sin.table[pgout & PG_MASK] + egout];
@@ -832,6 +852,121 @@ bool Y8950::checkMuteHelper()
 	return adpcm.isMuted();
 }
 
+// Calculate a (2-operator) channel for all samples of the block. This is the
+// same calculation as in the per-sample loop, but specialized for the
+// features that are in use. 'factor' is 2 for the bass drum.
+template<unsigned FLAGS>
+void Y8950::calcChannel(Channel& channel, int* buf, const int* lfoAm,
+                        const int* lfoPm, unsigned num, int factor)
+{
+	const bool HAS_MOD_AM = (FLAGS &  1) != 0;
+	const bool HAS_CAR_AM = (FLAGS &  2) != 0;
+	const bool HAS_MOD_PM = (FLAGS &  4) != 0;
+	const bool HAS_CAR_PM = (FLAGS &  8) != 0;
+	const bool HAS_FB     = (FLAGS & 16) != 0;
+	const bool ALG        = (FLAGS & 32) != 0; // mod + car (instead of FM)
+
+	auto& mod = channel.slot[MOD];
+	auto& car = channel.slot[CAR];
+	for (unsigned sample = 0; sample < num; ++sample) {
+		// Once the carrier is finished, it only becomes active again
+		// by a register write (and the modulator isn't advanced till
+		// then).
+		if (!car.isActive()) break;
+		int lfo_pm = lfoPm[sample];
+		int lfo_am = lfoAm[sample];
+		int mo = mod.calc_slot_mod<HAS_MOD_PM, HAS_MOD_AM, HAS_FB>(
+			lfo_pm, lfo_am);
+		int out = ALG
+		        ? car.calc_slot_car<HAS_CAR_PM, HAS_CAR_AM>(lfo_pm, lfo_am, 0) + mo
+		        : car.calc_slot_car<HAS_CAR_PM, HAS_CAR_AM>(lfo_pm, lfo_am, mo);
+		buf[sample] += factor * out;
+	}
+}
+
+void Y8950::calcChannel(Channel& channel, bool alg, int* buf, const int* lfoAm,
+                        const int* lfoPm, unsigned num, int factor)
+{
+	// Below we choose between 64 specialized versions of calcChannel().
+	// This allows to move a lot of conditional code out of the
+	// inner-loop.
+	auto& mod = channel.slot[MOD];
+	auto& car = channel.slot[CAR];
+	unsigned flags = ( mod.patch.AM       << 0) |
+	                 ( car.patch.AM       << 1) |
+	                 ( mod.patch.PM       << 2) |
+	                 ( car.patch.PM       << 3) |
+	                 ((mod.patch.FB != 0) << 4) |
+	                 ( alg                << 5);
+	switch (flags) {
+	case  0: calcChannel< 0>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  1: calcChannel< 1>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  2: calcChannel< 2>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  3: calcChannel< 3>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  4: calcChannel< 4>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  5: calcChannel< 5>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  6: calcChannel< 6>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  7: calcChannel< 7>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  8: calcChannel< 8>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case  9: calcChannel< 9>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 10: calcChannel<10>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 11: calcChannel<11>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 12: calcChannel<12>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 13: calcChannel<13>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 14: calcChannel<14>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 15: calcChannel<15>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 16: calcChannel<16>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 17: calcChannel<17>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 18: calcChannel<18>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 19: calcChannel<19>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 20: calcChannel<20>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 21: calcChannel<21>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 22: calcChannel<22>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 23: calcChannel<23>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 24: calcChannel<24>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 25: calcChannel<25>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 26: calcChannel<26>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 27: calcChannel<27>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 28: calcChannel<28>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 29: calcChannel<29>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 30: calcChannel<30>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 31: calcChannel<31>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 32: calcChannel<32>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 33: calcChannel<33>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 34: calcChannel<34>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 35: calcChannel<35>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 36: calcChannel<36>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 37: calcChannel<37>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 38: calcChannel<38>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 39: calcChannel<39>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 40: calcChannel<40>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 41: calcChannel<41>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 42: calcChannel<42>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 43: calcChannel<43>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 44: calcChannel<44>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 45: calcChannel<45>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 46: calcChannel<46>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 47: calcChannel<47>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 48: calcChannel<48>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 49: calcChannel<49>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 50: calcChannel<50>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 51: calcChannel<51>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 52: calcChannel<52>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 53: calcChannel<53>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 54: calcChannel<54>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 55: calcChannel<55>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 56: calcChannel<56>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 57: calcChannel<57>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 58: calcChannel<58>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 59: calcChannel<59>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 60: calcChannel<60>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 61: calcChannel<61>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 62: calcChannel<62>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	case 63: calcChannel<63>(channel, buf, lfoAm, lfoPm, num, factor); break;
+	default: UNREACHABLE;
+	}
+}
+
 void Y8950::generateChannels(int** bufs, unsigned num)
 {
 	// TODO implement per-channel mute (instead of all-or-nothing)
@@ -845,6 +980,10 @@ void Y8950::generateChannels(int** bufs, unsigned num)
 		return;
 	}
 
+	// The LFOs are shared by all channels, calculate them upfront for the
+	// whole block.
+	VLA(int, lfoAm, num);
+	VLA(int, lfoPm, num);
 	for (unsigned sample = 0; sample < num; ++sample) {
 		// Amplitude modulation: 27 output levels (triangle waveform);
 		// 1 level takes one of: 192, 256 or 448 samples
@@ -853,11 +992,36 @@ void Y8950::generateChannels(int** bufs, unsigned num)
 		++am_phase;
 		if (am_phase == (LFO_AM_TAB_ELEMENTS * 64)) am_phase = 0;
 		unsigned tmp = lfo_am_table[am_phase / 64];
-		int lfo_am = am_mode ? tmp : tmp / 4;
+		lfoAm[sample] = am_mode ? tmp : tmp / 4;
 
 		pm_phase = (pm_phase + PM_DPHASE) & (PM_DP_WIDTH - 1);
-		int lfo_pm = pm.table[pm_mode][pm_phase >> (PM_DP_BITS - PM_PG_BITS)];
+		lfoPm[sample] = pm.table[pm_mode][pm_phase >> (PM_DP_BITS - PM_PG_BITS)];
+	}
+
+	// Apart from the LFOs, the melodic channels and the bass drum don't
+	// share any state with the other channels. So calculate all samples
+	// of one channel at a time. The result is exactly the same.
+	int m = rythm_mode ? 6 : 9;
+	for (int i = 0; i < m; ++i) {
+		calcChannel(ch[i], ch[i].alg, bufs[i], lfoAm, lfoPm, num, 1);
+	}
+	if (rythm_mode) {
+		//bufs[6][sample] += 0;
+		//bufs[7][sample] += 0;
+		//bufs[8][sample] += 0;
 
+		// bass drum: always FM, independent of the alg bit
+		calcChannel(ch[6], false, bufs[9], lfoAm, lfoPm, num, 2);
+	} else {
+		//bufs[ 9] += 0;
+		//bufs[10] += 0;
+		//bufs[11] += 0;
+		//bufs[12] += 0;
+		//bufs[13] += 0;
+	}
+
+	// The other rhythm instruments share the noise generators.
+	for (unsigned sample = 0; sample < num; ++sample) {
 		if (noise_seed & 1) {
 			noise_seed ^= 0x24000;
 		}
@@ -875,31 +1039,14 @@ void Y8950::generateChannels(int** bufs, unsigned num)
 		noiseB_phase &= (0x10 << 11) - 1;
 		int noiseB = noiseB_phase & (0x0A << 11) ? DB_POS(6) : DB_NEG(6);
 
-		int m = rythm_mode ? 6 : 9;
-		for (int i = 0; i < m; ++i) {
-			if (ch[i].slot[CAR].isActive()) {
-				bufs[i][sample] += ch[i].alg
-					? ch[i].slot[CAR].calc_slot_car(lfo_pm, lfo_am, 0) +
-					       ch[i].slot[MOD].calc_slot_mod(lfo_pm, lfo_am)
-					: ch[i].slot[CAR].calc_slot_car(lfo_pm, lfo_am,
-					       ch[i].slot[MOD].calc_slot_mod(lfo_pm, lfo_am));
-			} else {
-				//bufs[i][sample] += 0;
-			}
-		}
 		if (rythm_mode) {
-			//bufs[6][sample] += 0;
-			//bufs[7][sample] += 0;
-			//bufs[8][sample] += 0;
+			int lfo_am = lfoAm[sample];
+			int lfo_pm = lfoPm[sample];
 
 			// TODO wasn't in original source either
 			ch[7].slot[MOD].calc_phase(lfo_pm);
 			ch[8].slot[CAR].calc_phase(lfo_pm);
 
-			bufs[ 9][sample] += (ch[6].slot[CAR].isActive())
-				? 2 * ch[6].slot[CAR].calc_slot_car(lfo_pm, lfo_am,
-						    ch[6].slot[MOD].calc_slot_mod(lfo_pm, lfo_am))
-				: 0;
 			bufs[10][sample] += (ch[7].slot[CAR].isActive())
 				? 2 * ch[7].slot[CAR].calc_slot_snare(lfo_pm, lfo_am, whitenoise)
 				: 0;
@@ -912,12 +1059,6 @@ void Y8950::generateChannels(int** bufs, unsigned num)
 			bufs[13][sample] += (ch[8].slot[MOD].isActive())
 				? 2 * ch[8].slot[MOD].calc_slot_tom(lfo_pm, lfo_am)
 				: 0;
-		} else {
-			//bufs[ 9] += 0;
-			//bufs[10] += 0;
-			//bufs[11] += 0;
-			//bufs[12] += 0;
-			//bufs[13] += 0;
 		}
 
 		bufs[14][sample] += adpcm.calcSample();
@@ -144,9 +144,13 @@ private:
 		inline void slotOn (KeyPart part);
 		inline void slotOff(KeyPart part);
 
+		template<bool HAS_PM> inline unsigned calc_phase(int lfo_pm);
+		template<bool HAS_AM> inline unsigned calc_envelope(int lfo_am);
 		inline unsigned calc_phase(int lfo_pm);
 		inline unsigned calc_envelope(int lfo_am);
+		template<bool HAS_PM, bool HAS_AM>
 		inline int calc_slot_car(int lfo_pm, int lfo_am, int fm);
+		template<bool HAS_PM, bool HAS_AM, bool HAS_FB>
 		inline int calc_slot_mod(int lfo_pm, int lfo_am);
 		inline int calc_slot_tom(int lfo_pm, int lfo_am);
 		inline int calc_slot_snare(int lfo_pm, int lfo_am, int whitenoise);
@@ -198,6 +202,12 @@ private:
 		bool alg;
 	};
 
+	template<unsigned FLAGS>
+	inline void calcChannel(Channel& channel, int* buf, const int* lfoAm,
+	                        const int* lfoPm, unsigned num, int factor);
+	void calcChannel(Channel& channel, bool alg, int* buf, const int* lfoAm,
+	                 const int* lfoPm, unsigned num, int factor);
+
 	MSXMotherBoard& motherBoard;
 	Y8950Periphery& periphery;
 	Y8950Adpcm adpcm;
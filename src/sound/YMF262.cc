@@ -44,6 +44,9 @@
 #include "cstd.hh"
 #include "outer.hh"
 #include "serialize.hh"
+#include "unreachable.hh"
+#include "vla.hh"
+#include <cassert>
 #include <cmath>
 #include <cstring>
 #include <iostream>
@@ -622,9 +625,11 @@ void YMF262::Slot::advanceEnvelopeGenerator(unsigned egCnt)
 	}
 }
 
+template<bool HAS_VIB>
 void YMF262::Slot::advancePhaseGenerator(Channel& ch, unsigned lfo_pm)
 {
-	if (vib) {
+	assert(vib == HAS_VIB);
+	if (HAS_VIB) {
 		// LFO phase modulation active
 		unsigned block_fnum = ch.block_fnum;
 		unsigned fnum_lfo   = (block_fnum & 0x0380) >> 7;
@@ -637,21 +642,18 @@ void YMF262::Slot::advancePhaseGenerator(Channel& ch, unsigned lfo_pm)
 }
 
 // advance to next sample
-void YMF262::advance()
+void YMF262::Slot::advance(Channel& ch, unsigned egCnt, unsigned lfo_pm)
 {
-	// Vibrato: 8 output levels (triangle waveform);
-	// 1 level takes 1024 samples
-	lfo_pm_cnt.addQuantum();
-	unsigned lfo_pm = (lfo_pm_cnt.toInt() & 7) | lfo_pm_depth_range;
-
-	++eg_cnt;
-	for (auto& ch : channel) {
-		for (auto& op : ch.slot) {
-			op.advanceEnvelopeGenerator(eg_cnt);
-			op.advancePhaseGenerator(ch, lfo_pm);
-		}
+	advanceEnvelopeGenerator(egCnt);
+	if (vib) {
+		advancePhaseGenerator<true >(ch, lfo_pm);
+	} else {
+		advancePhaseGenerator<false>(ch, lfo_pm);
 	}
+}
 
+void YMF262::advanceNoise()
+{
 	// The Noise Generator of the YM3812 is 23-bit shift register.
 	// Period is equal to 2^23-2 samples.
 	// Register works at sampling frequency of the chip, so output
@@ -1554,6 +1556,206 @@ int YMF262::getAmplificationFactorImpl() const
 	return 1 << 3;
 }
 
+// Calculate a 2-operator channel (not part of a 4op channel or the rhythm).
+// This is the same calculation as in chan_calc(), but specialized for the
+// features that are in use, and for all samples of the block at once (the
+// slots of such a channel don't influence any other slot).
+template<unsigned FLAGS>
+void YMF262::calcChannel(unsigned chan, int* buf, const unsigned* lfoAm,
+                         const unsigned* lfoPm, unsigned num)
+{
+	const bool HAS_MOD_AM  = (FLAGS &  1) != 0;
+	const bool HAS_CAR_AM  = (FLAGS &  2) != 0;
+	const bool HAS_MOD_VIB = (FLAGS &  4) != 0;
+	const bool HAS_CAR_VIB = (FLAGS &  8) != 0;
+	const bool HAS_FB      = (FLAGS & 16) != 0;
+	const bool ADDITIVE    = (FLAGS & 32) != 0; // connection: mod + car
+
+	auto& ch = channel[chan];
+	auto& mod = ch.slot[MOD];
+	auto& car = ch.slot[CAR];
+	assert((mod.AMmask != 0) == HAS_MOD_AM);
+	assert((car.AMmask != 0) == HAS_CAR_AM);
+	assert((mod.fb_shift != 0) == HAS_FB);
+	assert((mod.connect == &chanout[chan]) == ADDITIVE);
+
+	unsigned panLeft  = pan[4 * chan + 0];
+	unsigned panRight = pan[4 * chan + 1];
+	unsigned egCnt = eg_cnt;
+	int out = 0;
+	for (unsigned j = 0; j < num; ++j) {
+		int fb = HAS_FB
+		       ? (mod.op1_out[0] + mod.op1_out[1]) >> mod.fb_shift
+		       : 0;
+		mod.op1_out[0] = mod.op1_out[1];
+		mod.op1_out[1] = mod.op_calc(mod.Cnt.toInt() + fb,
+		                             HAS_MOD_AM ? lfoAm[j] : 0);
+		int pm = ADDITIVE ? 0 : mod.op1_out[1];
+		out = car.op_calc(car.Cnt.toInt() + pm, HAS_CAR_AM ? lfoAm[j] : 0);
+		if (ADDITIVE) out += mod.op1_out[1];
+
+		buf[2 * j + 0] += out & panLeft;
+		buf[2 * j + 1] += out & panRight;
+
+		++egCnt;
+		mod.advanceEnvelopeGenerator(egCnt);
+		mod.advancePhaseGenerator<HAS_MOD_VIB>(ch, lfoPm[j]);
+		car.advanceEnvelopeGenerator(egCnt);
+		car.advancePhaseGenerator<HAS_CAR_VIB>(ch, lfoPm[j]);
+	}
+	chanout[chan] = out;
+}
+
+void YMF262::calcChannel(unsigned chan, int* buf, const unsigned* lfoAm,
+                         const unsigned* lfoPm, unsigned num)
+{
+	auto& ch = channel[chan];
+	auto& mod = ch.slot[MOD];
+	auto& car = ch.slot[CAR];
+	if ((car.connect != &chanout[chan]) ||
+	    ((mod.connect != &chanout[chan]) &&
+	     (mod.connect != &phase_modulation))) {
+		// The routing is still (partly) set up for 4op mode (the 0xC0
+		// register wasn't written since 4op mode was turned off). This
+		// is rare, use the generic code.
+		for (unsigned j = 0; j < num; ++j) {
+			chanout[chan] = 0;
+			ch.chan_calc(lfoAm[j]);
+			buf[2 * j + 0] += chanout[chan] & pan[4 * chan + 0];
+			buf[2 * j + 1] += chanout[chan] & pan[4 * chan + 1];
+			mod.advance(ch, eg_cnt + j + 1, lfoPm[j]);
+			car.advance(ch, eg_cnt + j + 1, lfoPm[j]);
+		}
+		return;
+	}
+
+	// Below we choose between 64 specialized versions of calcChannel().
+	// This allows to move a lot of conditional code out of the
+	// inner-loop.
+	unsigned flags = ((mod.AMmask   != 0)              << 0) |
+	                 ((car.AMmask   != 0)              << 1) |
+	                 ( mod.vib                         << 2) |
+	                 ( car.vib                         << 3) |
+	                 ((mod.fb_shift != 0)              << 4) |
+	                 ((mod.connect  == &chanout[chan]) << 5);
+	switch (flags) {
+	case  0: calcChannel< 0>(chan, buf, lfoAm, lfoPm, num); break;
+	case  1: calcChannel< 1>(chan, buf, lfoAm, lfoPm, num); break;
+	case  2: calcChannel< 2>(chan, buf, lfoAm, lfoPm, num); break;
+	case  3: calcChannel< 3>(chan, buf, lfoAm, lfoPm, num); break;
+	case  4: calcChannel< 4>(chan, buf, lfoAm, lfoPm, num); break;
+	case  5: calcChannel< 5>(chan, buf, lfoAm, lfoPm, num); break;
+	case  6: calcChannel< 6>(chan, buf, lfoAm, lfoPm, num); break;
+	case  7: calcChannel< 7>(chan, buf, lfoAm, lfoPm, num); break;
+	case  8: calcChannel< 8>(chan, buf, lfoAm, lfoPm, num); break;
+	case  9: calcChannel< 9>(chan, buf, lfoAm, lfoPm, num); break;
+	case 10: calcChannel<10>(chan, buf, lfoAm, lfoPm, num); break;
+	case 11: calcChannel<11>(chan, buf, lfoAm, lfoPm, num); break;
+	case 12: calcChannel<12>(chan, buf, lfoAm, lfoPm, num); break;
+	case 13: calcChannel<13>(chan, buf, lfoAm, lfoPm, num); break;
+	case 14: calcChannel<14>(chan, buf, lfoAm, lfoPm, num); break;
+	case 15: calcChannel<15>(chan, buf, lfoAm, lfoPm, num); break;
+	case 16: calcChannel<16>(chan, buf, lfoAm, lfoPm, num); break;
+	case 17: calcChannel<17>(chan, buf, lfoAm, lfoPm, num); break;
+	case 18: calcChannel<18>(chan, buf, lfoAm, lfoPm, num); break;
+	case 19: calcChannel<19>(chan, buf, lfoAm, lfoPm, num); break;
+	case 20: calcChannel<20>(chan, buf, lfoAm, lfoPm, num); break;
+	case 21: calcChannel<21>(chan, buf, lfoAm, lfoPm, num); break;
+	case 22: calcChannel<22>(chan, buf, lfoAm, lfoPm, num); break;
+	case 23: calcChannel<23>(chan, buf, lfoAm, lfoPm, num); break;
+	case 24: calcChannel<24>(chan, buf, lfoAm, lfoPm, num); break;
+	case 25: calcChannel<25>(chan, buf, lfoAm, lfoPm, num); break;
+	case 26: calcChannel<26>(chan, buf, lfoAm, lfoPm, num); break;
+	case 27: calcChannel<27>(chan, buf, lfoAm, lfoPm, num); break;
+	case 28: calcChannel<28>(chan, buf, lfoAm, lfoPm, num); break;
+	case 29: calcChannel<29>(chan, buf, lfoAm, lfoPm, num); break;
+	case 30: calcChannel<30>(chan, buf, lfoAm, lfoPm, num); break;
+	case 31: calcChannel<31>(chan, buf, lfoAm, lfoPm, num); break;
+	case 32: calcChannel<32>(chan, buf, lfoAm, lfoPm, num); break;
+	case 33: calcChannel<33>(chan, buf, lfoAm, lfoPm, num); break;
+	case 34: calcChannel<34>(chan, buf, lfoAm, lfoPm, num); break;
+	case 35: calcChannel<35>(chan, buf, lfoAm, lfoPm, num); break;
+	case 36: calcChannel<36>(chan, buf, lfoAm, lfoPm, num); break;
+	case 37: calcChannel<37>(chan, buf, lfoAm, lfoPm, num); break;
+	case 38: calcChannel<38>(chan, buf, lfoAm, lfoPm, num); break;
+	case 39: calcChannel<39>(chan, buf, lfoAm, lfoPm, num); break;
+	case 40: calcChannel<40>(chan, buf, lfoAm, lfoPm, num); break;
+	case 41: calcChannel<41>(chan, buf, lfoAm, lfoPm, num); break;
+	case 42: calcChannel<42>(chan, buf, lfoAm, lfoPm, num); break;
+	case 43: calcChannel<43>(chan, buf, lfoAm, lfoPm, num); break;
+	case 44: calcChannel<44>(chan, buf, lfoAm, lfoPm, num); break;
+	case 45: calcChannel<45>(chan, buf, lfoAm, lfoPm, num); break;
+	case 46: calcChannel<46>(chan, buf, lfoAm, lfoPm, num); break;
+	case 47: calcChannel<47>(chan, buf, lfoAm, lfoPm, num); break;
+	case 48: calcChannel<48>(chan, buf, lfoAm, lfoPm, num); break;
+	case 49: calcChannel<49>(chan, buf, lfoAm, lfoPm, num); break;
+	case 50: calcChannel<50>(chan, buf, lfoAm, lfoPm, num); break;
+	case 51: calcChannel<51>(chan, buf, lfoAm, lfoPm, num); break;
+	case 52: calcChannel<52>(chan, buf, lfoAm, lfoPm, num); break;
+	case 53: calcChannel<53>(chan, buf, lfoAm, lfoPm, num); break;
+	case 54: calcChannel<54>(chan, buf, lfoAm, lfoPm, num); break;
+	case 55: calcChannel<55>(chan, buf, lfoAm, lfoPm, num); break;
+	case 56: calcChannel<56>(chan, buf, lfoAm, lfoPm, num); break;
+	case 57: calcChannel<57>(chan, buf, lfoAm, lfoPm, num); break;
+	case 58: calcChannel<58>(chan, buf, lfoAm, lfoPm, num); break;
+	case 59: calcChannel<59>(chan, buf, lfoAm, lfoPm, num); break;
+	case 60: calcChannel<60>(chan, buf, lfoAm, lfoPm, num); break;
+	case 61: calcChannel<61>(chan, buf, lfoAm, lfoPm, num); break;
+	case 62: calcChannel<62>(chan, buf, lfoAm, lfoPm, num); break;
+	case 63: calcChannel<63>(chan, buf, lfoAm, lfoPm, num); break;
+	default: UNREACHABLE;
+	}
+}
+
+// Calculate a 4op channel, this combines the channels 'chan' and 'chan + 3'.
+void YMF262::calc4OpChannel(unsigned chan, int** bufs, const unsigned* lfoAm,
+                            const unsigned* lfoPm, unsigned num)
+{
+	auto& ch0 = channel[chan + 0];
+	auto& ch3 = channel[chan + 3];
+	assert(ch0.extended);
+	for (unsigned j = 0; j < num; ++j) {
+		chanout[chan + 0] = 0;
+		chanout[chan + 3] = 0;
+		// extended 4op ch#0 part 1
+		ch0.chan_calc(lfoAm[j]);
+		// extended 4op ch#0 part 2
+		ch3.chan_calc_ext(lfoAm[j]);
+		for (unsigned i : {chan + 0, chan + 3}) {
+			bufs[i][2 * j + 0] += chanout[i] & pan[4 * i + 0];
+			bufs[i][2 * j + 1] += chanout[i] & pan[4 * i + 1];
+		}
+		unsigned egCnt = eg_cnt + j + 1;
+		for (auto* ch : {&ch0, &ch3}) {
+			for (auto& op : ch->slot) {
+				op.advance(*ch, egCnt, lfoPm[j]);
+			}
+		}
+	}
+}
+
+// Calculate the rhythm channels 6, 7 and 8 (these share the noise generator
+// and some phase generators). This also advances the noise generator.
+void YMF262::calcRhythm(int** bufs, const unsigned* lfoAm,
+                        const unsigned* lfoPm, unsigned num)
+{
+	for (unsigned j = 0; j < num; ++j) {
+		chanout[6] = chanout[7] = chanout[8] = 0;
+		chan_calc_rhythm(lfoAm[j]);
+		for (unsigned i = 6; i <= 8; ++i) {
+			bufs[i][2 * j + 0] += chanout[i] & pan[4 * i + 0];
+			bufs[i][2 * j + 1] += chanout[i] & pan[4 * i + 1];
+		}
+		unsigned egCnt = eg_cnt + j + 1;
+		for (unsigned i = 6; i <= 8; ++i) {
+			for (auto& op : channel[i].slot) {
+				op.advance(channel[i], egCnt, lfoPm[j]);
+			}
+		}
+		advanceNoise();
+	}
+}
+
 void YMF262::generateChannels(int** bufs, unsigned num)
 {
 	// TODO implement per-channel mute (instead of all-or-nothing)
@@ -1566,8 +1768,10 @@ void YMF262::generateChannels(int** bufs, unsigned num)
 		return;
 	}
 
-	bool rhythmEnabled = (rhythm & 0x20) != 0;
-
+	// The LFOs are shared by all channels, calculate them upfront for the
+	// whole block.
+	VLA(unsigned, lfoAm, num);
+	VLA(unsigned, lfoPm, num);
 	for (unsigned j = 0; j < num; ++j) {
 		// Amplitude modulation: 27 output levels (triangle waveform);
 		// 1 level takes one of: 192, 256 or 448 samples
@@ -1578,53 +1782,51 @@ void YMF262::generateChannels(int** bufs, unsigned num)
 			lfo_am_cnt = LFOAMIndex(0);
 		}
 		unsigned tmp = lfo_am_table[lfo_am_cnt.toInt()];
-		unsigned lfo_am = lfo_am_depth ? tmp : tmp / 4;
-
-		// clear channel outputs
-		memset(chanout, 0, sizeof(chanout));
-
-		// channels 0,3 1,4 2,5  9,12 10,13 11,14
-		// in either 2op or 4op mode
-		for (int k = 0; k <= 9; k += 9) {
-			for (int i = 0; i < 3; ++i) {
-				auto& ch0 = channel[k + i + 0];
-				auto& ch3 = channel[k + i + 3];
-				// extended 4op ch#0 part 1 or 2op ch#0
-				ch0.chan_calc(lfo_am);
-				if (ch0.extended) {
-					// extended 4op ch#0 part 2
-					ch3.chan_calc_ext(lfo_am);
-				} else {
-					// standard 2op ch#3
-					ch3.chan_calc(lfo_am);
-				}
+		lfoAm[j] = lfo_am_depth ? tmp : tmp / 4;
+
+		// Vibrato: 8 output levels (triangle waveform);
+		// 1 level takes 1024 samples
+		lfo_pm_cnt.addQuantum();
+		lfoPm[j] = (lfo_pm_cnt.toInt() & 7) | lfo_pm_depth_range;
+	}
+
+	// Apart from the LFOs and the envelope generator counter, the channels
+	// don't share any state (a 4op channel or the rhythm section is
+	// treated as a single channel). So instead of calculating one sample
+	// of all channels at a time, we can calculate all samples of one
+	// channel at a time. The result is exactly the same.
+
+	// channels 0,3 1,4 2,5  9,12 10,13 11,14
+	// in either 2op or 4op mode
+	for (unsigned k = 0; k <= 9; k += 9) {
+		for (unsigned i = k; i < (k + 3); ++i) {
+			if (channel[i].extended) {
+				calc4OpChannel(i, bufs, lfoAm, lfoPm, num);
+			} else {
+				calcChannel(i + 0, bufs[i + 0], lfoAm, lfoPm, num);
+				calcChannel(i + 3, bufs[i + 3], lfoAm, lfoPm, num);
 			}
 		}
+	}
 
-		// channels 6,7,8 rhythm or 2op mode
-		if (!rhythmEnabled) {
-			channel[6].chan_calc(lfo_am);
-			channel[7].chan_calc(lfo_am);
-			channel[8].chan_calc(lfo_am);
-		} else {
-			// Rhythm part
-			chan_calc_rhythm(lfo_am);
+	// channels 6,7,8 rhythm or 2op mode
+	if (rhythm & 0x20) {
+		calcRhythm(bufs, lfoAm, lfoPm, num);
+	} else {
+		for (unsigned i = 6; i <= 8; ++i) {
+			calcChannel(i, bufs[i], lfoAm, lfoPm, num);
 		}
-
-		// channels 15,16,17 are fixed 2-operator channels only
-		channel[15].chan_calc(lfo_am);
-		channel[16].chan_calc(lfo_am);
-		channel[17].chan_calc(lfo_am);
-
-		for (int i = 0; i < 18; ++i) {
-			bufs[i][2 * j + 0] += chanout[i] & pan[4 * i + 0];
-			bufs[i][2 * j + 1] += chanout[i] & pan[4 * i + 1];
-			// unused c        += chanout[i] & pan[4 * i + 2];
-			// unused d        += chanout[i] & pan[4 * i + 3];
+		for (unsigned j = 0; j < num; ++j) {
+			advanceNoise();
 		}
+	}
 
-		advance();
+	// channels 15,16,17 are fixed 2-operator channels only
+	for (unsigned i = 15; i <= 17; ++i) {
+		calcChannel(i, bufs[i], lfoAm, lfoPm, num);
 	}
+
+	eg_cnt += num;
 }
 
 
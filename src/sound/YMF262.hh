@@ -54,7 +54,9 @@ private:
 		inline void FM_KEYON(byte key_set);
 		inline void FM_KEYOFF(byte key_clr);
 		inline void advanceEnvelopeGenerator(unsigned egCnt);
+		template<bool HAS_VIB>
 		inline void advancePhaseGenerator(Channel& ch, unsigned lfo_pm);
+		inline void advance(Channel& ch, unsigned egCnt, unsigned lfo_pm);
 		void update_ar_dr();
 		void update_rr();
 		void calc_fc(const Channel& ch);
@@ -152,7 +154,17 @@ private:
 	void setStatus(byte flag);
 	void resetStatus(byte flag);
 	void changeStatusMask(byte flag);
-	void advance();
+	inline void advanceNoise();
+
+	template<unsigned FLAGS>
+	inline void calcChannel(unsigned chan, int* buf, const unsigned* lfoAm,
+	                        const unsigned* lfoPm, unsigned num);
+	void calcChannel(unsigned chan, int* buf, const unsigned* lfoAm,
+	                 const unsigned* lfoPm, unsigned num);
+	void calc4OpChannel(unsigned chan, int** bufs, const unsigned* lfoAm,
+	                    const unsigned* lfoPm, unsigned num);
+	void calcRhythm(int** bufs, const unsigned* lfoAm,
+	                const unsigned* lfoPm, unsigned num);
 
 	inline int genPhaseHighHat();
 	inline int genPhaseSnare();
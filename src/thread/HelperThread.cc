@@ -0,0 +1,53 @@
+#include "HelperThread.hh"
+#include <cassert>
+
+namespace openmsx {
+
+HelperThread::~HelperThread()
+{
+	if (!thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(!busy);
+		exitLoop = true;
+	}
+	condition.notify_all();
+	thread.join();
+}
+
+void HelperThread::startImpl(JobFunc func, void* data)
+{
+	if (!thread.joinable()) {
+		thread = std::thread([this]() { run(); });
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(!busy);
+		jobFunc = func;
+		jobData = data;
+		busy = true;
+	}
+	condition.notify_all();
+}
+
+void HelperThread::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [this]() { return !busy; });
+}
+
+void HelperThread::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [this]() { return busy || exitLoop; });
+		if (exitLoop) return;
+		lock.unlock();
+		jobFunc(jobData);
+		lock.lock();
+		busy = false;
+		condition.notify_all();
+	}
+}
+
+} // namespace openmsx
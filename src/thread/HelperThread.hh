@@ -0,0 +1,49 @@
+#ifndef HELPERTHREAD_HH
+#define HELPERTHREAD_HH
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace openmsx {
+
+/** A thread that executes one job at a time, concurrently with the thread
+  * that started it. The typical use is to split some work in two halves:
+  * start() the second half on the helper thread, execute the first half
+  * directly and then wait() till the helper is done as well.
+  * The thread itself is only created on the first start().
+  */
+class HelperThread
+{
+public:
+	HelperThread() = default;
+	~HelperThread();
+
+	/** Start executing the given job (a functor without parameters).
+	  * The job object must stay alive till wait() returns.
+	  */
+	template<typename Job> void start(Job& job) {
+		startImpl([](void* j) { (*static_cast<Job*>(j))(); }, &job);
+	}
+
+	/** Wait till the job that was started last is finished.
+	  */
+	void wait();
+
+private:
+	using JobFunc = void (*)(void*);
+	void startImpl(JobFunc func, void* data);
+	void run();
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	JobFunc jobFunc = nullptr;
+	void* jobData = nullptr;
+	bool busy = false;
+	bool exitLoop = false;
+};
+
+} // namespace openmsx
+
+#endif
@@ -1,6 +1,10 @@
 #include "Timer.hh"
 #include <chrono>
 #include <thread>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
 
 namespace openmsx {
 namespace Timer {
@@ -31,5 +35,33 @@ void sleep(uint64_t us)
 	std::this_thread::sleep_for(std::chrono::microseconds(us));
 }
 
+void sleepPrecise(uint64_t us)
+{
+	if (us == 0) return; // (a zero timeout would disarm the timerfd)
+#ifdef __linux__
+	static int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (fd != -1) {
+		itimerspec spec = {};
+		spec.it_value.tv_sec  = us / 1000000;
+		spec.it_value.tv_nsec = (us % 1000000) * 1000;
+		if (timerfd_settime(fd, 0, &spec, nullptr) == 0) {
+			uint64_t expirations;
+			// When interrupted (by a signal) we return too early,
+			// that's allowed.
+			(void)!read(fd, &expirations, sizeof(expirations));
+			return;
+		}
+	}
+#endif
+	sleep(us);
+}
+
+void busyWaitUntil(uint64_t time)
+{
+	while (getTime() < time) {
+		std::this_thread::yield();
+	}
+}
+
 } // namespace Timer
 } // namespace openmsx
@@ -15,6 +15,16 @@ namespace Timer {
 	  */
 	void sleep(uint64_t us);
 
+	/** Like sleep(), but try harder to not oversleep (on Linux a timerfd
+	  * is used, that one isn't subject to the kernel's 'timer slack').
+	  * Still the OS may wake us up (much) later than requested.
+	  */
+	void sleepPrecise(uint64_t us);
+
+	/** Busy-wait (without sleeping) till getTime() reaches the given time.
+	  */
+	void busyWaitUntil(uint64_t time);
+
 } // namespace Timer
 } // namespace openmsx
 
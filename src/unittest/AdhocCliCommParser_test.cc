@@ -8,7 +8,26 @@ using namespace std;
 static vector<string> parse(const string& stream)
 {
 	vector<string> result;
-	AdhocCliCommParser parser([&](const string& cmd) { result.push_back(cmd); });
+	AdhocCliCommParser parser([&](vector<AdhocCliCommParser::Command> cmds) {
+		for (auto& cmd : cmds) result.push_back(cmd.command);
+	});
+	parser.parse(stream.data(), stream.size());
+	return result;
+}
+
+// Returns one string per callback: "id:command" for each command in it,
+// separated by '|'.
+static vector<string> parseIds(const string& stream)
+{
+	vector<string> result;
+	AdhocCliCommParser parser([&](vector<AdhocCliCommParser::Command> cmds) {
+		string s;
+		for (auto& cmd : cmds) {
+			if (!s.empty()) s += '|';
+			s += cmd.id + ':' + cmd.command;
+		}
+		result.push_back(s);
+	});
 	parser.parse(stream.data(), stream.size());
 	return result;
 }
@@ -86,4 +105,29 @@ TEST_CASE("AdhocCliCommParser")
 		CHECK(parse("<command/>") ==
 		      vector<string>{});
 	}
+	SECTION("id attribute") {
+		CHECK(parseIds("<command id=\"1\">foo</command><command>bar</command>") ==
+		      vector<string>{"1:foo", ":bar"});
+		CHECK(parseIds("<command  id='a b' >foo</command>") ==
+		      vector<string>{"a b:foo"});
+		// other attributes are not accepted
+		CHECK(parseIds("<command id=\"1\" x=\"2\">foo</command>") ==
+		      vector<string>{});
+		CHECK(parseIds("<command id=1>foo</command>") ==
+		      vector<string>{});
+	}
+	SECTION("batch") {
+		CHECK(parseIds("<batch><command id=\"1\">foo</command> "
+		               "<command>bar</command></batch><command>baz</command>") ==
+		      vector<string>{"1:foo|:bar", ":baz"});
+		// empty batch, tags inside a batch other than <command> are ignored
+		CHECK(parseIds("<batch></batch><batch><foo/></batch>") ==
+		      vector<string>{});
+		// errors inside a batch only drop the faulty command
+		CHECK(parseIds("<batch><command>&bad;</command><command>foo</command></batch>") ==
+		      vector<string>{":foo"});
+		// nothing is executed till the end of the batch
+		CHECK(parseIds("<batch><command>foo</command>") ==
+		      vector<string>{});
+	}
 }
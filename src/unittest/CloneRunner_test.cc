@@ -0,0 +1,155 @@
+#include "catch.hpp"
+#include "Reactor.hh"
+#include "MSXMotherBoard.hh"
+#include "GlobalCommandController.hh"
+#include "Debugger.hh"
+#include "Debuggable.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "TclObject.hh"
+#include "strCat.hh"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+// The clones of 'run_clones' are hidden machines (see MSXMotherBoard::
+// isHidden()), they must not change the files of the actual machine. This
+// test runs clones that write to SRAM and to a disk, and checks that the
+// SRAM and disk image files stay unchanged.
+//
+// Like the tests in OPL_test.cc this starts a full Reactor, so it's hidden
+// ("[.]"). Run it explicitly with:
+//   derived/<platform>-unittest/bin/openmsx "[clones]"
+
+// RAM in slot 0, with page 1 switched to the FDC (registers at 0x7FF8).
+static std::string machineXML(const std::string& sramName)
+{
+	return strCat(
+		"<?xml version=\"1.0\" ?>\n"
+		"<!DOCTYPE msxconfig SYSTEM 'msxconfig2.dtd'>\n"
+		"<msxconfig>\n"
+		"  <info><type>MSX</type></info>\n"
+		"  <slotmap><map page=\"1\" slot=\"1\"/></slotmap>\n"
+		"  <devices>\n"
+		"    <S1985 id=\"S1985\"><sramname>", sramName, "</sramname></S1985>\n"
+		"    <primary slot=\"0\">\n"
+		"      <RAM id=\"ram\"><mem base=\"0x0000\" size=\"0x10000\"/></RAM>\n"
+		"    </primary>\n"
+		"    <primary slot=\"1\">\n"
+		"      <WD2793 id=\"fdc\">\n"
+		"        <connectionstyle>Philips</connectionstyle>\n"
+		"        <mem base=\"0x4000\" size=\"0x4000\"/>\n"
+		"        <rom><size>16</size></rom>\n" // no file: all 0xFF
+		"        <drives>1</drives>\n"
+		"      </WD2793>\n"
+		"    </primary>\n"
+		"  </devices>\n"
+		"</msxconfig>\n");
+}
+
+// Write 0x42 to the first SRAM byte of the S1985 and to all bytes of sector 1
+// (track 0, side 0) of drive A, then store the FDC status at 0xE000.
+static const uint8_t program[] = {
+	0xF3,             //       di
+	0x3E, 0xFE,       //       ld   a,0xFE
+	0xD3, 0x40,       //       out  (0x40),a    ; select the S1985
+	0xAF,             //       xor  a
+	0xD3, 0x41,       //       out  (0x41),a    ; SRAM address 0
+	0x3E, 0x42,       //       ld   a,0x42
+	0xD3, 0x42,       //       out  (0x42),a    ; SRAM data
+	0x3E, 0x80,       //       ld   a,0x80
+	0x32, 0xFD, 0x7F, //       ld   (0x7FFD),a  ; drive A, motor on
+	0xAF,             //       xor  a
+	0x32, 0xFC, 0x7F, //       ld   (0x7FFC),a  ; side 0
+	0x32, 0xF9, 0x7F, //       ld   (0x7FF9),a  ; track 0
+	0x3C,             //       inc  a
+	0x32, 0xFA, 0x7F, //       ld   (0x7FFA),a  ; sector 1
+	0x3E, 0xA0,       //       ld   a,0xA0
+	0x32, 0xF8, 0x7F, //       ld   (0x7FF8),a  ; write sector
+	0x3A, 0xFF, 0x7F, // wait: ld   a,(0x7FFF)
+	0x87,             //       add  a,a         ; !DRQ
+	0x38, 0x07,       //       jr   c,noDRQ
+	0x3E, 0x42,       //       ld   a,0x42
+	0x32, 0xFB, 0x7F, //       ld   (0x7FFB),a  ; data
+	0x18, 0xF3,       //       jr   wait
+	0x87,             // noDRQ:add  a,a         ; !IRQ
+	0x38, 0xF0,       //       jr   c,wait
+	0x3A, 0xF8, 0x7F, //       ld   a,(0x7FF8)  ; status
+	0x32, 0x00, 0xE0, //       ld   (0xE000),a
+	0x18, 0xFE,       //       jr   $
+};
+
+static const size_t DISK_SIZE = 720 * 1024;
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+	File file(filename);
+	std::vector<uint8_t> result(file.getSize());
+	file.read(result.data(), result.size());
+	return result;
+}
+
+TEST_CASE("CloneRunner: clones don't change files", "[.][clones]")
+{
+	std::string diskName;
+	{
+		auto f = FileOperations::openUniqueFile(
+			FileOperations::getTempDir(), diskName);
+		REQUIRE(f);
+		std::vector<uint8_t> zeros(DISK_SIZE);
+		REQUIRE(fwrite(zeros.data(), zeros.size(), 1, f.get()) == 1);
+	}
+	auto sramName = diskName + ".sram";
+	auto machineName = diskName + "-machine"; // loads <name>.xml
+	{
+		auto f = FileOperations::openFile(machineName + ".xml", "wb");
+		REQUIRE(f);
+		REQUIRE(fputs(machineXML(sramName).c_str(), f.get()) >= 0);
+	}
+
+	{
+		Reactor reactor;
+		reactor.init();
+		auto motherBoard = reactor.createEmptyMotherBoard();
+		motherBoard->loadMachine(machineName);
+		motherBoard->powerUp();
+
+		auto* memory = motherBoard->getDebugger().findDebuggable("memory");
+		REQUIRE(memory != nullptr);
+		for (unsigned i = 0; i < sizeof(program); ++i) {
+			memory->write(i, program[i]);
+		}
+		memory->write(0xE000, 0xFF);
+
+		auto& controller = reactor.getGlobalCommandController();
+		auto& interp = controller.getInterpreter();
+		auto prefix = strCat("::", motherBoard->getMachineID(), "::");
+		controller.executeCommand(strCat(prefix, "diska ", diskName));
+		auto result = controller.executeCommand(strCat(
+			prefix, "run_clones 1.0 {{} {}} "
+			"{{memory 0xE000} {{S1985 SRAM} 0}}"));
+
+		// The clones did write the sector (no 'not ready', 'write
+		// protect', 'record not found', 'CRC error' or 'lost data')
+		// and the SRAM ...
+		REQUIRE(result.getListLength(interp) == 2);
+		for (unsigned c = 0; c < 2; ++c) {
+			auto values = result.getListIndex(interp, c);
+			CHECK((values.getListIndex(interp, 0).getInt(interp) & 0xDC) == 0);
+			CHECK(values.getListIndex(interp, 1).getInt(interp) == 0x42);
+		}
+		// ... but the files are unchanged. Check this before the actual
+		// machine is deleted, because that does save its SRAM.
+		CHECK(!FileOperations::exists(sramName));
+		CHECK(readFile(diskName) == std::vector<uint8_t>(DISK_SIZE));
+		// And of course the actual machine didn't run.
+		CHECK(memory->read(0xE000) == 0xFF);
+	}
+
+	FileOperations::unlink(machineName + ".xml");
+	FileOperations::unlink(sramName);
+	FileOperations::unlink(diskName);
+}
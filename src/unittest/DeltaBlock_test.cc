@@ -0,0 +1,110 @@
+#include "catch.hpp"
+#include "DeltaBlock.hh"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace openmsx;
+
+static const size_t SIZE = 4096;
+
+// Compressible content that is different for each 'seed'.
+static std::vector<uint8_t> makeData(uint8_t seed)
+{
+	std::vector<uint8_t> result(SIZE);
+	for (size_t i = 0; i < SIZE; ++i) {
+		result[i] = uint8_t(seed + (i / 64));
+	}
+	return result;
+}
+
+static std::shared_ptr<DeltaBlockCopy> makeBlock(const std::vector<uint8_t>& data)
+{
+	auto block = std::make_shared<DeltaBlockCopy>(data.data(), data.size());
+	block->compress();
+	REQUIRE(block->compressed());
+	return block;
+}
+
+static bool inCache(DeltaBlockCache& cache, const DeltaBlockCopy& block,
+                    const std::vector<uint8_t>& expected)
+{
+	std::vector<uint8_t> buf(SIZE);
+	if (!cache.lookup(block, buf.data())) return false;
+	CHECK(buf == expected);
+	return true;
+}
+
+TEST_CASE("DeltaBlockCache: hit")
+{
+	DeltaBlockCache cache(4 * SIZE);
+	auto data = makeData(1);
+	auto block = makeBlock(data);
+	CHECK(!inCache(cache, *block, data));
+
+	// apply() decompresses the block and adds it to the cache
+	std::vector<uint8_t> buf(SIZE);
+	block->apply(buf.data(), SIZE, &cache);
+	CHECK(buf == data);
+	CHECK(inCache(cache, *block, data));
+
+	// a block that no longer exists is never found
+	block.reset();
+	auto other = makeBlock(makeData(2));
+	CHECK(!inCache(cache, *other, makeData(2)));
+}
+
+TEST_CASE("DeltaBlockCache: eviction")
+{
+	// room for two blocks, but not for three
+	DeltaBlockCache cache(3 * SIZE - 1);
+	auto dataA = makeData(1);
+	auto dataB = makeData(2);
+	auto dataC = makeData(3);
+	auto a = makeBlock(dataA);
+	auto b = makeBlock(dataB);
+	auto c = makeBlock(dataC);
+
+	cache.insert(*a, dataA.data());
+	cache.insert(*b, dataB.data());
+	CHECK(inCache(cache, *a, dataA)); // 'b' is now least recently used
+	cache.insert(*c, dataC.data());
+	CHECK( inCache(cache, *a, dataA));
+	CHECK(!inCache(cache, *b, dataB));
+	CHECK( inCache(cache, *c, dataC));
+
+	// blocks bigger than the cache are not added
+	DeltaBlockCache small(SIZE - 1);
+	small.insert(*a, dataA.data());
+	CHECK(!inCache(small, *a, dataA));
+}
+
+TEST_CASE("DeltaBlockCache: prefetch")
+{
+	DeltaBlockCache cache(4 * SIZE);
+	auto dataA = makeData(1);
+	auto dataB = makeData(2);
+	auto dataC = makeData(3);
+	auto a = std::make_shared<DeltaBlockCopy>(dataA.data(), SIZE);
+	// prefetch() takes the base of a diff block
+	std::shared_ptr<DeltaBlock> diff =
+		std::make_shared<DeltaBlockDiff>(a, dataB.data(), SIZE);
+	a->compress();
+	REQUIRE(a->compressed());
+	// uncompressed blocks are not prefetched
+	auto c = std::make_shared<DeltaBlockCopy>(dataC.data(), SIZE);
+
+	cache.prefetch({diff, c});
+	// wait (at most 10s) till the background thread is done
+	for (int i = 0; (i < 10000) && !inCache(cache, *a, dataA); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(inCache(cache, *a, dataA));
+	CHECK(!inCache(cache, *c, dataC));
+
+	std::vector<uint8_t> buf(SIZE);
+	diff->apply(buf.data(), SIZE, &cache);
+	CHECK(buf == dataB);
+}
@@ -0,0 +1,276 @@
+#include "catch.hpp"
+#include "YMF262.hh"
+#include "YMF278.hh"
+#include "MSXAudio.hh"
+#include "ResampledSoundDevice.hh"
+#include "MSXMixer.hh"
+#include "MSXMotherBoard.hh"
+#include "HardwareConfig.hh"
+#include "DeviceConfig.hh"
+#include "XMLElement.hh"
+#include "Reactor.hh"
+#include "EmuTime.hh"
+#include "aligned.hh"
+#include "sha1.hh"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+using namespace openmsx;
+
+// The channel calculation of the YMF262 and the Y8950 is specialized for
+// the features (AM, vibrato, feedback, connection) that are in use, and the
+// YMF278 calculates all samples of one slot at a time. These tests feed a
+// stream of register writes to the chips and check that the generated sound
+// is bit-exact.
+//
+// The chips can only be instantiated in a (hidden) machine, so these tests
+// start a full Reactor, which depends on the installed openMSX data files and
+// is slow. That's why they are hidden ("[.]"): a plain run of the unittest
+// executable skips them. Run them explicitly with:
+//   derived/<platform>-unittest/bin/openmsx "[opl]"
+//
+// The register streams only depend on the seeds below (0-3 for the register
+// writes and block lengths, 1000-1003 for the YMF278 sample RAM) and on the
+// Random generator, not on the standard library. The expected hashes were
+// produced by the generic calculation (one sample of all channels/slots at a
+// time), which these chips used before. To regenerate them, restore the
+// generic calculation with
+//   git checkout <commit>^ -- src/sound/YMF262.* src/sound/Y8950.* src/sound/YMF278.*
+// where <commit> is the oldest commit that specialized one of these chips,
+// then build the unittest flavour and run it as shown above. Each failing
+// CHECK prints the actual hash, in the order of the arrays below.
+
+// Deterministic pseudo random numbers, so that the register streams (and
+// thus the expected hashes) don't depend on the standard library.
+struct Random
+{
+	explicit Random(uint32_t seed) : x(seed) {}
+	unsigned operator()(unsigned range)
+	{
+		x = x * 1664525 + 1013904223;
+		return (x >> 8) % range;
+	}
+	uint32_t x;
+};
+
+// Alternately write a few registers (chosen by 'writeRegs') and generate a
+// block of samples of random length. Returns the sha1sum of all samples.
+template<typename WriteRegs>
+static std::string render(ResampledSoundDevice& device, unsigned outChannels,
+                          uint32_t seed, WriteRegs writeRegs)
+{
+	static const unsigned MAX_SAMPLES = 400;
+	Random random(seed);
+	SHA1 sha1;
+	for (int block = 0; block < 500; ++block) {
+		writeRegs(random);
+		unsigned num = 1 + random(MAX_SAMPLES);
+		// +4 because generateInput() may write up to 3 extra samples
+		SSE_ALIGNED(int buf[2 * MAX_SAMPLES + 4]);
+		if (!device.generateInput(buf, num)) {
+			std::fill(buf, buf + outChannels * num, 0);
+		}
+		for (unsigned i = 0; i < outChannels * num; ++i) {
+			auto s = uint32_t(buf[i]);
+			uint8_t bytes[4] = { uint8_t(s >>  0), uint8_t(s >>  8),
+			                     uint8_t(s >> 16), uint8_t(s >> 24) };
+			sha1.update(bytes, sizeof(bytes));
+		}
+	}
+	return sha1.digest().toString();
+}
+
+template<typename WriteReg>
+static void writeRegsYMF262(Random& random, WriteReg writeReg)
+{
+	static const unsigned bases[] = {
+		0x20, 0x40, 0x60, 0x80, 0xA0, 0xB0, 0xC0, 0xE0, 0xBD, 0x104, 0x08
+	};
+	for (unsigned n = random(12); n != 0; --n) {
+		unsigned base = bases[random(11)];
+		unsigned r = base;
+		if ((base < 0xA0) || (base == 0xE0)) {
+			r += random(0x16); // operator registers
+		} else if ((base == 0xA0) || (base == 0xB0) || (base == 0xC0)) {
+			r += random(9);    // channel registers
+		}
+		if ((base != 0x104) && random(2)) r += 0x100; // second register set
+		unsigned v = random(0x100);
+		if ((base == 0xBD) && random(4)) v &= 0xDF; // rhythm mostly off
+		if (base == 0x40) v &= 0x3F; // only attenuate with KSL
+		writeReg(r, v);
+	}
+}
+
+template<typename WriteReg>
+static void writeRegsY8950(Random& random, WriteReg writeReg)
+{
+	static const unsigned bases[] = {
+		0x20, 0x40, 0x60, 0x80, 0xA0, 0xB0, 0xC0, 0xBD
+	};
+	for (unsigned n = random(12); n != 0; --n) {
+		unsigned base = bases[random(8)];
+		unsigned r = base;
+		if (base < 0xA0) {
+			r += random(0x16); // operator registers
+		} else if (base != 0xBD) {
+			r += random(9);    // channel registers
+		}
+		unsigned v = random(0x100);
+		if ((base == 0xBD) && random(4)) v &= 0xDF; // rhythm mostly off
+		if (base == 0x40) v &= 0x3F; // only attenuate with KSL
+		writeReg(r, v);
+	}
+}
+
+// Fill the sample RAM with random data, and put wave table headers for 32
+// waves at the start of it (the waves 384-415 when R#2 selects this area).
+static void fillRamYMF278(YMF278& ymf278, uint32_t seed)
+{
+	static const unsigned RAM = 0x200000;
+	Random random(seed);
+	for (unsigned addr = RAM; addr < (RAM + 640 * 1024); ++addr) {
+		ymf278.writeMem(addr, random(0x100));
+	}
+	for (unsigned wave = 0; wave < 32; ++wave) {
+		unsigned bits  = random(3); // 8, 12 or 16 bit
+		unsigned start = RAM + 0x400 + random(0x60000);
+		unsigned len   = 0x100 + random(0x3F00);
+		unsigned loop  = random(len);
+		unsigned end   = 0x10000 - len; // stored negated
+		// the remaining 5 bytes (LFO, VIB, AR, D1R, DL, D2R, RC, RR, AM)
+		// keep their random value
+		byte header[7] = {
+			byte((bits << 6) | ((start >> 16) & 0x3F)),
+			byte(start >> 8), byte(start >> 0),
+			byte(loop  >> 8), byte(loop  >> 0),
+			byte(end   >> 8), byte(end   >> 0),
+		};
+		for (unsigned i = 0; i < 7; ++i) {
+			ymf278.writeMem(RAM + 12 * wave + i, header[i]);
+		}
+	}
+}
+
+template<typename WriteReg>
+static void writeRegsYMF278(Random& random, WriteReg writeReg)
+{
+	for (unsigned n = random(12); n != 0; --n) {
+		unsigned slot = random(24);
+		unsigned group = random(10);
+		unsigned v = random(0x100);
+		if (group == 0) v = (v & 0x1F) | 0x80; // wave 384-415 (low bits)
+		if (group == 1) v |= 0x01;             // wave 384-415 (bit 8)
+		writeReg(8 + slot + 24 * group, v);
+	}
+}
+
+static const char* const ymf262Hashes[] = {
+	"f61f7969e2da8a943f47c18319b3cc0e911593ee",
+	"2094bc650785f352a14988216ab83879372b9ee4",
+	"abcad7190122ef48aefa467c701abacd1fd8c80b",
+	"c5c5d1a47cf20494099cf11bd44a83bdf96481e3",
+};
+
+static const char* const y8950Hashes[] = {
+	"2860bd6a4561705eb27096789e9d3082628d0cfe",
+	"18c031b280db9ce008ad71383fb8a18582132f9b",
+	"49480cd0019bf77f26523f4f6d35cf941d04f95f",
+	"455f312d6c6febc5e2abac41aa6d72a0231518fa",
+};
+
+static const char* const ymf278Hashes[] = {
+	"4b4f5816260bfc35de37aed489f0cb3f6350af7a",
+	"d14e3f11e9e949ead1d7384d39b1d6f27d90b583",
+	"894dc57eaccd4fa6434989fc8febee73ee5c5829",
+	"49ed6605c00e4c1428b98cf5621927e610d31d14",
+};
+
+static ResampledSoundDevice& findDevice(MSXMotherBoard& motherBoard,
+                                        string_view name)
+{
+	auto* device = motherBoard.getMSXMixer().findDevice(name);
+	REQUIRE(device != nullptr);
+	return static_cast<ResampledSoundDevice&>(*device);
+}
+
+TEST_CASE("YMF262: channel calculation", "[.][opl]")
+{
+	Reactor reactor;
+	reactor.init();
+	auto motherBoard = reactor.createEmptyMotherBoard(true);
+	HardwareConfig hwConf(*motherBoard, "test");
+
+	XMLElement xml("YMF262");
+	xml.addChild("sound").addChild("volume", "12000");
+	DeviceConfig config(hwConf, xml);
+
+	uint32_t seed = 0;
+	for (auto* expected : ymf262Hashes) {
+		YMF262 ymf262("OPL3", config, false);
+		auto& device = findDevice(*motherBoard, "OPL3");
+		ymf262.writeReg512(0x105, 0x01, EmuTime::zero); // OPL3 mode
+		auto hash = render(device, 2, seed++, [&](Random& random) {
+			writeRegsYMF262(random, [&](unsigned r, unsigned v) {
+				ymf262.writeReg512(r, v, EmuTime::zero);
+			});
+		});
+		CHECK(hash == expected);
+	}
+}
+
+TEST_CASE("Y8950: channel calculation", "[.][opl]")
+{
+	Reactor reactor;
+	reactor.init();
+	auto motherBoard = reactor.createEmptyMotherBoard(true);
+	HardwareConfig hwConf(*motherBoard, "test");
+
+	XMLElement xml("MSX-AUDIO");
+	xml.addAttribute("id", "MSX-AUDIO");
+	xml.addChild("sound").addChild("volume", "12000");
+	DeviceConfig config(hwConf, xml);
+
+	uint32_t seed = 0;
+	for (auto* expected : y8950Hashes) {
+		MSXAudio audio(config);
+		auto& device = findDevice(*motherBoard, "MSX-AUDIO");
+		auto hash = render(device, 1, seed++, [&](Random& random) {
+			writeRegsY8950(random, [&](unsigned r, unsigned v) {
+				audio.writeIO(0, r, EmuTime::zero); // register latch
+				audio.writeIO(1, v, EmuTime::zero);
+			});
+		});
+		CHECK(hash == expected);
+	}
+}
+
+TEST_CASE("YMF278: wave channel calculation", "[.][opl]")
+{
+	Reactor reactor;
+	reactor.init();
+	auto motherBoard = reactor.createEmptyMotherBoard(true);
+	HardwareConfig hwConf(*motherBoard, "test");
+
+	XMLElement xml("YMF278");
+	xml.addChild("sound").addChild("volume", "12000");
+	xml.addChild("rom").addChild("size", "2048"); // no file: all 0xFF
+	DeviceConfig config(hwConf, xml);
+
+	uint32_t seed = 0;
+	for (auto* expected : ymf278Hashes) {
+		YMF278 ymf278("OPL4", 640, config);
+		fillRamYMF278(ymf278, seed + 1000);
+		ymf278.writeReg(0x02, 0x10, EmuTime::zero); // headers at 0x200000
+		for (unsigned slot = 0; slot < 24; ++slot) {
+			ymf278.writeReg(8 + slot + 24, 0x01, EmuTime::zero);
+		}
+		auto hash = render(ymf278, 2, seed++, [&](Random& random) {
+			writeRegsYMF278(random, [&](unsigned r, unsigned v) {
+				ymf278.writeReg(r, v, EmuTime::zero);
+			});
+		});
+		CHECK(hash == expected);
+	}
+}
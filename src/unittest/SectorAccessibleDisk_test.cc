@@ -0,0 +1,90 @@
+#include "catch.hpp"
+#include "DSKDiskImage.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "Filename.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+static const size_t NUM_SECTORS = 16;
+
+// Sector 'n' is filled with the value 'n'.
+static std::string createImage()
+{
+	std::string filename;
+	auto f = FileOperations::openUniqueFile(
+		FileOperations::getTempDir(), filename);
+	REQUIRE(f);
+	for (size_t n = 0; n < NUM_SECTORS; ++n) {
+		SectorBuffer buf;
+		memset(buf.raw, int(n), sizeof(buf));
+		REQUIRE(fwrite(buf.raw, sizeof(buf), 1, f.get()) == 1);
+	}
+	return filename;
+}
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+	File file(filename);
+	std::vector<uint8_t> result(file.getSize());
+	file.read(result.data(), result.size());
+	return result;
+}
+
+static uint8_t readSector(SectorAccessibleDisk& disk, size_t sector)
+{
+	SectorBuffer buf;
+	disk.readSector(sector, buf);
+	REQUIRE(std::all_of(std::begin(buf.raw), std::end(buf.raw),
+	                    [&](uint8_t b) { return b == buf.raw[0]; }));
+	return buf.raw[0];
+}
+
+static void writeSector(SectorAccessibleDisk& disk, size_t sector, uint8_t value)
+{
+	SectorBuffer buf;
+	memset(buf.raw, value, sizeof(buf));
+	disk.writeSector(sector, buf);
+}
+
+TEST_CASE("SectorAccessibleDisk: write overlay")
+{
+	auto filename = createImage();
+	auto original = readFile(filename);
+	REQUIRE(original.size() == NUM_SECTORS * sizeof(SectorBuffer));
+
+	SECTION("without overlay the image is changed") {
+		{
+			DSKDiskImage disk{Filename(filename)};
+			writeSector(disk, 3, 0xAA);
+			CHECK(readSector(disk, 3) == 0xAA);
+		}
+		CHECK(readFile(filename) != original);
+	}
+	SECTION("with overlay the image stays unchanged") {
+		{
+			DSKDiskImage disk{Filename(filename)};
+			disk.enableWriteOverlay();
+			CHECK(!disk.isWriteProtected());
+			writeSector(disk, 3, 0xAA);
+			writeSector(disk, 5, 0xBB);
+			writeSector(disk, 3, 0xCC); // overwrite again
+			CHECK(readSector(disk, 2) == 2);
+			CHECK(readSector(disk, 3) == 0xCC);
+			CHECK(readSector(disk, 4) == 4);
+			CHECK(readSector(disk, 5) == 0xBB);
+
+			disk.enableWriteOverlay(); // again, keeps the writes
+			CHECK(readSector(disk, 3) == 0xCC);
+		}
+		CHECK(readFile(filename) == original);
+	}
+
+	FileOperations::unlink(filename);
+}
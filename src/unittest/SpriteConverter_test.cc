@@ -0,0 +1,269 @@
+#include "catch.hpp"
+#include "SpriteConverter.hh"
+#include "SpriteChecker.hh"
+#include "DisplayMode.hh"
+#include "Math.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace openmsx;
+using SpriteInfo = SpriteChecker::SpriteInfo;
+using SpritePattern = SpriteChecker::SpritePattern;
+using Pixel = uint32_t;
+
+// Reference implementations: these are the straightforward pixel-per-pixel
+// (collision: pair-per-pair) algorithms the optimized routines must match.
+
+static void refDrawMode1(const SpriteInfo* visibleSprites, int visibleIndex,
+                         int minX, int maxX, const Pixel* palette,
+                         Pixel* pixelPtr)
+{
+	while (visibleIndex--) {
+		const SpriteInfo* sip = &visibleSprites[visibleIndex];
+		Pixel colIndex = sip->colorAttrib & 0x0F;
+		if (colIndex == 0) continue;
+		Pixel color = palette[colIndex];
+		SpritePattern pattern = sip->pattern;
+		int x = sip->x;
+		if (!SpriteConverter<Pixel>::clipPattern(x, pattern, minX, maxX)) continue;
+		Pixel* p = &pixelPtr[x];
+		while (pattern) {
+			if (pattern & 0x80000000) *p = color;
+			pattern <<= 1;
+			p++;
+		}
+	}
+}
+
+template<unsigned MODE>
+static void refDrawMode2(const SpriteInfo* visibleSprites, int visibleIndex,
+                         int minX, int maxX, bool transparency,
+                         const Pixel* palette, Pixel* pixelPtr)
+{
+	int first = 0;
+	do {
+		if ((visibleSprites[first].colorAttrib & 0x40) == 0) break;
+		++first;
+	} while (first < visibleIndex);
+	for (int i = visibleIndex - 1; i >= first; --i) {
+		const SpriteInfo& info = visibleSprites[i];
+		int x = info.x;
+		SpritePattern pattern = info.pattern;
+		if (!SpriteConverter<Pixel>::clipPattern(x, pattern, minX, maxX)) continue;
+		byte c = info.colorAttrib & 0x0F;
+		if (c == 0 && transparency) continue;
+		while (pattern) {
+			if (pattern & 0x80000000) {
+				byte color = c;
+				for (int j = i + 1; /*sentinel*/; ++j) {
+					const SpriteInfo& info2 = visibleSprites[j];
+					if (!(info2.colorAttrib & 0x40)) break;
+					unsigned shift2 = x - info2.x;
+					if ((shift2 < 32) &&
+					   ((info2.pattern << shift2) & 0x80000000)) {
+						color |= info2.colorAttrib & 0x0F;
+					}
+				}
+				if (MODE == DisplayMode::GRAPHIC5) {
+					pixelPtr[x * 2 + 0] = palette[color >> 2];
+					pixelPtr[x * 2 + 1] = palette[color & 3];
+				} else if (MODE == DisplayMode::GRAPHIC6) {
+					pixelPtr[x * 2 + 0] = palette[color];
+					pixelPtr[x * 2 + 1] = palette[color];
+				} else {
+					pixelPtr[x] = palette[color];
+				}
+			}
+			++x;
+			pattern <<= 1;
+		}
+	}
+}
+
+static int refCollision(const SpriteInfo* visibleSprites, int count, bool mode2)
+{
+	int minXCollision = 999;
+	for (int i = count; --i >= 1; /**/) {
+		if (mode2 && (visibleSprites[i].colorAttrib & 0x60)) continue;
+		int x_i = visibleSprites[i].x;
+		SpritePattern pattern_i = visibleSprites[i].pattern;
+		for (int j = i; --j >= 0; ) {
+			if (mode2 && (visibleSprites[j].colorAttrib & 0x60)) continue;
+			int x_j = visibleSprites[j].x;
+			int dist = x_j - x_i;
+			if ((-32 < dist) && (dist < 32)) {
+				SpritePattern pattern_j = visibleSprites[j].pattern;
+				if (dist < 0) {
+					pattern_j <<= -dist;
+				} else {
+					pattern_j >>= dist;
+				}
+				SpritePattern colPat = pattern_i & pattern_j;
+				if (x_i < 0) {
+					colPat &= (1 << (32 + x_i)) - 1;
+				}
+				if (colPat) {
+					int xCollision = x_i + Math::countLeadingZeros(colPat);
+					minXCollision = std::min(minXCollision, xCollision);
+				}
+			}
+		}
+	}
+	return (minXCollision < 256) ? minXCollision : -1;
+}
+
+
+// Small deterministic pseudo random generator, so that failures can be
+// reproduced.
+struct Random {
+	uint32_t next() {
+		state = state * 1664525 + 1013904223;
+		return state >> 8;
+	}
+	uint32_t state = 12345;
+};
+
+// Fill in a sprite line the way SpriteChecker does: 8, 16 or 32 (magnified
+// 16x16) pixels wide patterns, x-coordinates in range [-32, 256) and a
+// sentinel with CC=0 after the last sprite.
+static int randomLine(Random& random, SpriteInfo* sprites)
+{
+	static const SpritePattern widthMask[3] = {
+		0xFF000000, 0xFFFF0000, 0xFFFFFFFF
+	};
+	SpritePattern mask = widthMask[random.next() % 3];
+	int count = 1 + random.next() % 32;
+	// Often cluster the sprites to get more overlap (and collisions).
+	int base = int(random.next() % 288) - 32;
+	bool cluster = (random.next() % 2) != 0;
+	for (int i = 0; i < count; ++i) {
+		SpriteInfo& s = sprites[i];
+		s.pattern = random.next() & mask;
+		int x = cluster ? base + int(random.next() % 24) - 12
+		                : int(random.next() % 288) - 32;
+		s.x = std::min(255, std::max(-32, x));
+		s.colorAttrib = random.next() & 0x6F;
+	}
+	sprites[count].colorAttrib = 0; // sentinel
+	return count;
+}
+
+template<typename Draw, typename Ref>
+static void compareLines(Draw draw, Ref ref)
+{
+	static const int WIDTH = 512 + 64;
+	Pixel palette[16];
+	for (int i = 0; i < 16; ++i) palette[i] = 0x1000 + i;
+
+	Random random;
+	SpriteInfo sprites[32 + 1];
+	for (int n = 0; n < 10000; ++n) {
+		int count = randomLine(random, sprites);
+		int minX = 0;
+		int maxX = 256;
+		if (n & 1) {
+			minX = random.next() % 256;
+			maxX = minX + 1 + random.next() % (256 - minX);
+		}
+		Pixel expected[WIDTH];
+		Pixel actual  [WIDTH];
+		for (int i = 0; i < WIDTH; ++i) expected[i] = actual[i] = i;
+		ref (sprites, count, minX, maxX, palette, expected);
+		draw(sprites, count, minX, maxX, palette, actual);
+		REQUIRE(memcmp(expected, actual, sizeof(actual)) == 0);
+	}
+}
+
+TEST_CASE("SpriteConverter: drawMode1")
+{
+	auto draw = [](const SpriteInfo* s, int c, int mn, int mx,
+	               const Pixel* pal, Pixel* out) {
+		SpriteConverter<Pixel>::drawMode1(s, c, mn, mx, pal, out);
+	};
+	compareLines(draw, refDrawMode1);
+}
+
+TEST_CASE("SpriteConverter: drawMode2")
+{
+	for (bool transparency : {false, true}) {
+		auto draw4 = [&](const SpriteInfo* s, int c, int mn, int mx,
+		                 const Pixel* pal, Pixel* out) {
+			SpriteConverter<Pixel>::drawMode2<DisplayMode::GRAPHIC4>(
+				s, c, mn, mx, transparency, pal, out);
+		};
+		auto ref4 = [&](const SpriteInfo* s, int c, int mn, int mx,
+		                const Pixel* pal, Pixel* out) {
+			refDrawMode2<DisplayMode::GRAPHIC4>(
+				s, c, mn, mx, transparency, pal, out);
+		};
+		compareLines(draw4, ref4);
+
+		auto draw5 = [&](const SpriteInfo* s, int c, int mn, int mx,
+		                 const Pixel* pal, Pixel* out) {
+			SpriteConverter<Pixel>::drawMode2<DisplayMode::GRAPHIC5>(
+				s, c, mn, mx, transparency, pal, out);
+		};
+		auto ref5 = [&](const SpriteInfo* s, int c, int mn, int mx,
+		                const Pixel* pal, Pixel* out) {
+			refDrawMode2<DisplayMode::GRAPHIC5>(
+				s, c, mn, mx, transparency, pal, out);
+		};
+		compareLines(draw5, ref5);
+
+		auto draw6 = [&](const SpriteInfo* s, int c, int mn, int mx,
+		                 const Pixel* pal, Pixel* out) {
+			SpriteConverter<Pixel>::drawMode2<DisplayMode::GRAPHIC6>(
+				s, c, mn, mx, transparency, pal, out);
+		};
+		auto ref6 = [&](const SpriteInfo* s, int c, int mn, int mx,
+		                const Pixel* pal, Pixel* out) {
+			refDrawMode2<DisplayMode::GRAPHIC6>(
+				s, c, mn, mx, transparency, pal, out);
+		};
+		compareLines(draw6, ref6);
+	}
+}
+
+TEST_CASE("SpriteChecker: findCollision")
+{
+	SECTION("no sprites") {
+		SpriteInfo sprites[1];
+		CHECK(SpriteChecker::findCollision(sprites, 0, false) == -1);
+	}
+	SECTION("overlap left of the screen doesn't count") {
+		SpriteInfo sprites[2];
+		sprites[0] = SpriteInfo{0xFFFF0000, -20, 1};
+		sprites[1] = SpriteInfo{0xFFFF0000, -20, 1};
+		CHECK(SpriteChecker::findCollision(sprites, 2, false) == -1);
+		sprites[1].x = -18;
+		// pixels [-18, -4) overlap
+		CHECK(SpriteChecker::findCollision(sprites, 2, false) == -1);
+		sprites[0].pattern = 0xFFFFFF00;
+		sprites[1].pattern = 0xFFFFFF00;
+		// pixels [-18, 4) overlap
+		CHECK(SpriteChecker::findCollision(sprites, 2, false) == 0);
+	}
+	SECTION("CC and IC sprites don't collide in mode 2") {
+		SpriteInfo sprites[2];
+		sprites[0] = SpriteInfo{0xFF000000, 100, 1};
+		sprites[1] = SpriteInfo{0xFF000000, 104, 0x41};
+		CHECK(SpriteChecker::findCollision(sprites, 2, false) == 104);
+		CHECK(SpriteChecker::findCollision(sprites, 2, true) == -1);
+		sprites[1].colorAttrib = 0x21;
+		CHECK(SpriteChecker::findCollision(sprites, 2, true) == -1);
+	}
+	SECTION("random lines") {
+		Random random;
+		SpriteInfo sprites[32 + 1];
+		for (int n = 0; n < 10000; ++n) {
+			int count = randomLine(random, sprites);
+			int count1 = std::min(4, count);
+			int count2 = std::min(8, count);
+			REQUIRE(SpriteChecker::findCollision(sprites, count1, false) ==
+			        refCollision(sprites, count1, false));
+			REQUIRE(SpriteChecker::findCollision(sprites, count2, true) ==
+			        refCollision(sprites, count2, true));
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "TigerTree.hh"
+#include <vector>
 #include <cstring>
 
 using namespace openmsx;
@@ -78,3 +79,56 @@ TEST_CASE("TigerTree")
 		       "SJUYB3QVIJXNKZMSQZGIMHA7GA2MYU2UECDA26A");
 	}
 }
+
+TEST_CASE("TigerTree: large data and save/load cache")
+{
+	// Large enough to be hashed in parallel chunks, and with a partial last
+	// block (that part is never hashed in parallel).
+	const size_t size = 3 * 1024 * 1024 + 100;
+	std::vector<uint8_t> buffer_(size + 1);
+	uint8_t* buffer = buffer_.data() + 1;
+	for (size_t i = 0; i < size; ++i) {
+		buffer[i] = uint8_t(i ^ (i >> 8) ^ (i >> 16));
+	}
+	TTTestData data;
+	data.buffer = buffer;
+
+	std::string name = "large";
+	time_t dummyTime = 0;
+	auto dummyCallback = [](size_t, size_t) {};
+	auto freshHash = [&](size_t sz) {
+		// a different name, so it doesn't share the cache entry
+		TigerTree tt(data, sz, "reference");
+		return tt.calcHash(dummyCallback).toString();
+	};
+
+	std::vector<uint8_t> cache;
+	std::string hash1;
+	{
+		TigerTree tt(data, size, name);
+		hash1 = tt.calcHash(dummyCallback).toString();
+		CHECK(tt.saveCache(cache));
+		std::vector<uint8_t> cache2;
+		CHECK(!tt.saveCache(cache2)); // nothing changed
+	}
+
+	// restore the cache, then modify a few bytes
+	TigerTree tt(data, size, name);
+	tt.loadCache(cache.data(), cache.size());
+	CHECK(tt.calcHash(dummyCallback).toString() == hash1);
+
+	buffer[1000000] ^= 0xFF;
+	tt.notifyChange(1000000, 1, dummyTime);
+	buffer[size - 10] ^= 0xFF;
+	tt.notifyChange(size - 10, 1, dummyTime);
+	std::string hash2 = tt.calcHash(dummyCallback).toString();
+	CHECK(hash2 != hash1);
+	CHECK(hash2 == freshHash(size));
+	std::vector<uint8_t> cache3;
+	CHECK(tt.saveCache(cache3)); // changed
+
+	// a cache for different data is ignored
+	TigerTree tt2(data, size - 1, name);
+	tt2.loadCache(cache.data(), cache.size());
+	CHECK(tt2.calcHash(dummyCallback).toString() == freshHash(size - 1));
+}
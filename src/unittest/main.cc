@@ -1,2 +1,11 @@
-#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_RUNNER
 #include "catch.hpp"
+#include "Thread.hh"
+
+int main(int argc, char* argv[])
+{
+	// Some tests create a Reactor (see e.g. OPL_test.cc), that requires
+	// this, like in the real main().
+	openmsx::Thread::setMainThread();
+	return Catch::Session().run(argc, argv);
+}
@@ -254,8 +254,9 @@ DeltaBlock::~DeltaBlock()
 
 // class DeltaBlockCopy
 
-DeltaBlockCopy::DeltaBlockCopy(const uint8_t* data, size_t size)
-	: block(size)
+DeltaBlockCopy::DeltaBlockCopy(const uint8_t* data, size_t size_)
+	: block(size_)
+	, size(size_)
 	, compressedSize(0)
 {
 #ifdef DEBUG
@@ -271,21 +272,35 @@ DeltaBlockCopy::DeltaBlockCopy(const uint8_t* data, size_t size)
 #endif
 }
 
-void DeltaBlockCopy::apply(uint8_t* dst, size_t size) const
+void DeltaBlockCopy::apply(uint8_t* dst, size_t size_,
+                           DeltaBlockCache* cache) const
 {
-	if (compressed()) {
-		snappy::uncompress(
-			reinterpret_cast<const char*>(block.data()), compressedSize,
-			reinterpret_cast<char*>(dst), size);
-	} else {
+	assert(size_ == size); (void)size_;
+	if (!compressed()) {
 		memcpy(dst, block.data(), size);
+	} else if (!cache || !cache->lookup(*this, dst)) {
+		decompress(dst);
+		if (cache) cache->insert(*this, dst);
 	}
 #ifdef DEBUG
 	assert(SHA1::calc(dst, size) == sha1);
 #endif
 }
 
-void DeltaBlockCopy::compress(size_t size)
+std::shared_ptr<DeltaBlockCopy> DeltaBlockCopy::getBase()
+{
+	return shared_from_this();
+}
+
+void DeltaBlockCopy::decompress(uint8_t* dst) const
+{
+	assert(compressed());
+	snappy::uncompress(
+		reinterpret_cast<const char*>(block.data()), compressedSize,
+		reinterpret_cast<char*>(dst), size);
+}
+
+void DeltaBlockCopy::compress()
 {
 	if (compressed()) return;
 
@@ -303,7 +318,7 @@ void DeltaBlockCopy::compress(size_t size)
 	assert(compressed());
 #ifdef DEBUG
 	MemBuffer<uint8_t> buf3(size);
-	apply(buf3.data(), size);
+	apply(buf3.data(), size, nullptr);
 	assert(memcmp(buf3.data(), buf2.data(), size) == 0);
 #endif
 #if STATISTICS
@@ -334,7 +349,7 @@ DeltaBlockDiff::DeltaBlockDiff(
 	sha1 = SHA1::calc(data, size);
 
 	MemBuffer<uint8_t> buf(size);
-	apply(buf.data(), size);
+	apply(buf.data(), size, nullptr);
 	assert(memcmp(buf.data(), data, size) == 0);
 #endif
 #if STATISTICS
@@ -345,15 +360,21 @@ DeltaBlockDiff::DeltaBlockDiff(
 #endif
 }
 
-void DeltaBlockDiff::apply(uint8_t* dst, size_t size) const
+void DeltaBlockDiff::apply(uint8_t* dst, size_t size,
+                           DeltaBlockCache* cache) const
 {
-	prev->apply(dst, size);
+	prev->apply(dst, size, cache);
 	applyDeltaInPlace(dst, size, delta.data());
 #ifdef DEBUG
 	assert(SHA1::calc(dst, size) == sha1);
 #endif
 }
 
+std::shared_ptr<DeltaBlockCopy> DeltaBlockDiff::getBase()
+{
+	return prev;
+}
+
 size_t DeltaBlockDiff::getDeltaSize() const
 {
 	return delta.size();
@@ -380,7 +401,7 @@ std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
 		if (ref) {
 			// We will switch to a new DeltaBlockCopy object. So
 			// now is a good time to compress the old one.
-			ref->compress(size);
+			ref->compress();
 		}
 		// Heuristic: create a new block when too many small
 		// differences have accumulated.
@@ -430,10 +451,130 @@ void LastDeltaBlocks::clear()
 {
 	for (const Info& info : infos) {
 		if (auto ref = info.ref.lock()) {
-			ref->compress(info.size);
+			ref->compress();
 		}
 	}
 	infos.clear();
 }
 
+
+// class DeltaBlockCache
+
+DeltaBlockCache::DeltaBlockCache(size_t maxSize_)
+	: maxSize(maxSize_)
+	, totalSize(0)
+	, exitThread(false)
+{
+}
+
+DeltaBlockCache::~DeltaBlockCache()
+{
+	if (thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.clear();
+			exitThread = true;
+		}
+		condition.notify_all();
+		thread.join();
+	}
+}
+
+DeltaBlockCache::Entry* DeltaBlockCache::find(const DeltaBlockCopy& block)
+{
+	auto it = std::find_if(begin(entries), end(entries),
+		[&](const Entry& e) { return e.key == &block; });
+	if (it == end(entries)) return nullptr;
+	if (it->block.expired()) {
+		// Another block that happened to get the same address.
+		totalSize -= it->size;
+		entries.erase(it);
+		return nullptr;
+	}
+	// move to the back (most recently used)
+	std::rotate(it, it + 1, end(entries));
+	return &entries.back();
+}
+
+void DeltaBlockCache::add(const DeltaBlockCopy& block, MemBuffer<uint8_t> data)
+{
+	if (find(block)) return; // already added (by the other thread)
+
+	size_t size = block.getSize();
+	if (size > maxSize) return;
+	// Drop the blocks that no longer exist and then (if still needed) the
+	// least recently used ones.
+	auto it = std::remove_if(begin(entries), end(entries),
+		[&](const Entry& e) {
+			if (!e.block.expired()) return false;
+			totalSize -= e.size;
+			return true; });
+	entries.erase(it, end(entries));
+	auto n = begin(entries);
+	while ((totalSize + size) > maxSize) {
+		totalSize -= n->size;
+		++n;
+	}
+	entries.erase(begin(entries), n);
+
+	entries.push_back(Entry{&block, block.shared_from_this(),
+	                        std::move(data), size});
+	totalSize += size;
+}
+
+bool DeltaBlockCache::lookup(const DeltaBlockCopy& block, uint8_t* dst)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto* e = find(block);
+	if (!e) return false;
+	memcpy(dst, e->data.data(), e->size);
+	return true;
+}
+
+void DeltaBlockCache::insert(const DeltaBlockCopy& block, const uint8_t* data)
+{
+	MemBuffer<uint8_t> buf(block.getSize());
+	memcpy(buf.data(), data, block.getSize());
+	std::lock_guard<std::mutex> lock(mutex);
+	add(block, std::move(buf));
+}
+
+void DeltaBlockCache::prefetch(const vector<std::shared_ptr<DeltaBlock>>& blocks)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.clear();
+		for (auto& b : blocks) {
+			auto base = b->getBase();
+			// Only compressed blocks are immutable (and worth it).
+			if (!base->compressed() || find(*base)) continue;
+			if (std::find(begin(jobs), end(jobs), base) != end(jobs)) continue;
+			jobs.push_back(std::move(base));
+		}
+		if (jobs.empty()) return;
+	}
+	if (!thread.joinable()) {
+		thread = std::thread([this]() { run(); });
+	}
+	condition.notify_all();
+}
+
+void DeltaBlockCache::run()
+{
+	while (true) {
+		std::shared_ptr<DeltaBlockCopy> block;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&] { return !jobs.empty() || exitThread; });
+			if (exitThread) break;
+			block = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		MemBuffer<uint8_t> buf(block->getSize());
+		block->decompress(buf.data());
+		std::lock_guard<std::mutex> lock(mutex);
+		add(*block, std::move(buf));
+	}
+}
+
 } // namespace openmsx
@@ -4,8 +4,12 @@
 #define STATISTICS 0
 
 #include "MemBuffer.hh"
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #ifdef DEBUG
 #include "sha1.hh"
@@ -13,6 +17,9 @@
 
 namespace openmsx {
 
+class DeltaBlockCopy;
+class DeltaBlockCache;
+
 class DeltaBlock
 {
 public:
@@ -21,7 +28,15 @@ public:
 #else
 	virtual ~DeltaBlock() = default;
 #endif
-	virtual void apply(uint8_t* dst, size_t size) const = 0;
+	/** Reconstruct the content of this block in 'dst'.
+	  * When a cache is given, the decompressed content of the base block
+	  * is taken from (or added to) that cache.
+	  */
+	virtual void apply(uint8_t* dst, size_t size,
+	                   DeltaBlockCache* cache) const = 0;
+
+	/** The DeltaBlockCopy this block is based on (possibly itself). */
+	virtual std::shared_ptr<DeltaBlockCopy> getBase() = 0;
 
 protected:
 	DeltaBlock() = default;
@@ -40,17 +55,25 @@ protected:
 
 
 class DeltaBlockCopy final : public DeltaBlock
+                           , public std::enable_shared_from_this<DeltaBlockCopy>
 {
 public:
 	DeltaBlockCopy(const uint8_t* data, size_t size);
-	void apply(uint8_t* dst, size_t size) const override;
-	void compress(size_t size);
+	void apply(uint8_t* dst, size_t size,
+	           DeltaBlockCache* cache) const override;
+	std::shared_ptr<DeltaBlockCopy> getBase() override;
+	void compress();
 	const uint8_t* getData();
 
-private:
+	/** Once compressed, a block never changes anymore. So only then it's
+	  * safe to decompress it on another thread (see DeltaBlockCache). */
 	bool compressed() const { return compressedSize != 0; }
+	size_t getSize() const { return size; }
+	void decompress(uint8_t* dst) const;
 
+private:
 	MemBuffer<uint8_t> block;
+	size_t size; // uncompressed size
 	size_t compressedSize;
 };
 
@@ -60,7 +83,9 @@ class DeltaBlockDiff final : public DeltaBlock
 public:
 	DeltaBlockDiff(std::shared_ptr<DeltaBlockCopy> prev_,
 	               const uint8_t* data, size_t size);
-	void apply(uint8_t* dst, size_t size) const override;
+	void apply(uint8_t* dst, size_t size,
+	           DeltaBlockCache* cache) const override;
+	std::shared_ptr<DeltaBlockCopy> getBase() override;
 	size_t getDeltaSize() const;
 
 private:
@@ -93,6 +118,61 @@ private:
 	std::vector<Info> infos;
 };
 
+
+/** Keeps the decompressed content of the most recently used (compressed)
+  * DeltaBlockCopy objects. Restoring a snapshot decompresses all its base
+  * blocks. When seeking back and forth (e.g. in the reverse bar) the same
+  * few snapshots, and thus the same base blocks, are restored over and
+  * over again. With this cache that's (mostly) a memcpy.
+  *
+  * Blocks can also be decompressed in advance on a background thread, see
+  * prefetch(). The cache doesn't keep the blocks themselves alive.
+  */
+class DeltaBlockCache
+{
+public:
+	explicit DeltaBlockCache(size_t maxSize);
+	~DeltaBlockCache();
+
+	/** Copy the decompressed content of the given block to 'dst'.
+	  * @return false when the block is not in the cache.
+	  */
+	bool lookup(const DeltaBlockCopy& block, uint8_t* dst);
+
+	/** Add the decompressed content of the given block. */
+	void insert(const DeltaBlockCopy& block, const uint8_t* data);
+
+	/** Decompress the base blocks of the given blocks on a background
+	  * thread. This replaces the blocks that were queued before, but
+	  * not yet processed.
+	  */
+	void prefetch(const std::vector<std::shared_ptr<DeltaBlock>>& blocks);
+
+private:
+	struct Entry {
+		const DeltaBlockCopy* key;
+		std::weak_ptr<const DeltaBlockCopy> block;
+		MemBuffer<uint8_t> data;
+		size_t size;
+	};
+
+	// These must be called with 'mutex' locked.
+	Entry* find(const DeltaBlockCopy& block);
+	void add(const DeltaBlockCopy& block, MemBuffer<uint8_t> data);
+
+	void run();
+
+	const size_t maxSize;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<Entry> entries; // protected by mutex, least recently used first
+	size_t totalSize;           // protected by mutex
+	std::deque<std::shared_ptr<DeltaBlockCopy>> jobs; // protected by mutex
+	bool exitThread;                                  // protected by mutex
+};
+
 } // namespace openmsx
 
 #endif
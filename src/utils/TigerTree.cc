@@ -1,6 +1,10 @@
 #include "TigerTree.hh"
+#include "HelperThread.hh"
 #include "Math.hh"
+#include "xrange.hh"
+#include <algorithm>
 #include <map>
+#include <thread>
 #include <cstring>
 #include <cassert>
 
@@ -8,6 +12,25 @@ namespace openmsx {
 
 static const size_t BLOCK_SIZE = 1024;
 
+// Large images are hashed in chunks of this many blocks (must be a power of
+// 2), each chunk on one of (at most) MAX_THREADS helper threads.
+static const size_t CHUNK_BLOCKS = 256;
+static const unsigned MAX_THREADS = 8;
+
+// Only the nodes at or above this level (see below) are stored by
+// saveCache(). Recalculating such a subtree takes 64 leaf hashes, for a
+// 4GB image the stored data is about 3MB. Must be a power of 2.
+static const size_t PERSIST_LEVEL = 64;
+
+struct TTPersistHeader
+{
+	char magic[8];
+	uint64_t dataSize;
+	int64_t time;
+	uint64_t numNodes;
+};
+static const char TT_PERSIST_MAGIC[8] = { 'o', 'M', 'S', 'X', 'T', 'T', 'H', '1' };
+
 struct TTCacheEntry
 {
 	MemBuffer<TigerHash> hash;
@@ -15,6 +38,7 @@ struct TTCacheEntry
 	size_t numNodes;
 	time_t time = -1;
 	size_t numNodesValid;
+	bool dirty = false; // changed since the last saveCache()/loadCache()
 };
 // Typically contains 0 or 1 element, and only rarely 2 or more. But we need
 // the address of existing elements to remain stable when new elements are
@@ -38,6 +62,7 @@ static TTCacheEntry& getCacheEntry(
 		result.numNodes = numNodes;
 		memset(result.valid.data(), 0, numNodes); // all invalid
 		result.numNodesValid = 0;
+		result.dirty = false; // nothing worth saving
 	}
 	return result;
 }
@@ -51,12 +76,17 @@ TigerTree::TigerTree(TTData& data_, size_t dataSize_, const std::string& name)
 
 const TigerHash& TigerTree::calcHash(const std::function<void(size_t, size_t)>& progressCallback)
 {
-	return calcHash(getTop(), progressCallback);
+	auto top = getTop();
+	if (!entry.valid[top.n]) {
+		calcChunks(progressCallback);
+	}
+	return calcHash(top, progressCallback);
 }
 
 void TigerTree::notifyChange(size_t offset, size_t len, time_t time)
 {
 	entry.time = time;
+	entry.dirty = true;
 
 	assert((offset + len) <= dataSize);
 	if (len == 0) return;
@@ -65,19 +95,182 @@ void TigerTree::notifyChange(size_t offset, size_t len, time_t time)
 		entry.valid[getTop().n] = false; // set sentinel
 		entry.numNodesValid--;
 	}
+	auto top = getTop();
 	auto first = offset / BLOCK_SIZE;
 	auto last = (offset + len - 1) / BLOCK_SIZE;
 	assert(first <= last); // requires len != 0
 	do {
 		auto node = getLeaf(first);
-		while (entry.valid[node.n]) {
-			entry.valid[node.n] = false;
-			entry.numNodesValid--;
+		while (true) {
+			if (entry.valid[node.n]) {
+				entry.valid[node.n] = false;
+				entry.numNodesValid--;
+			} else if (node.l >= PERSIST_LEVEL) {
+				// All parents are invalid as well. Below this level
+				// that's not guaranteed: after loadCache() only the
+				// upper part of the tree is valid.
+				break;
+			}
+			if (node.n == top.n) break;
 			node = getParent(node);
 		}
 	} while (++first <= last);
 }
 
+bool TigerTree::saveCache(std::vector<uint8_t>& buf)
+{
+	if (!entry.dirty || (entry.numNodes < PERSIST_LEVEL) ||
+	    (entry.numNodesValid == 0)) {
+		return false;
+	}
+	entry.dirty = false;
+	TTPersistHeader header;
+	memcpy(header.magic, TT_PERSIST_MAGIC, sizeof(header.magic));
+	header.dataSize = dataSize;
+	header.time = entry.time;
+	header.numNodes = entry.numNodes;
+
+	auto num = entry.numNodes / PERSIST_LEVEL;
+	buf.resize(sizeof(header) + num * (1 + sizeof(TigerHash)));
+	auto* p = buf.data();
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+	for (size_t n = PERSIST_LEVEL - 1; n < entry.numNodes; n += PERSIST_LEVEL) {
+		*p++ = entry.valid[n];
+		memcpy(p, entry.hash[n].h8, sizeof(TigerHash));
+		p += sizeof(TigerHash);
+	}
+	assert(p == buf.data() + buf.size());
+	return true;
+}
+
+bool TigerTree::isEmpty() const
+{
+	return entry.numNodesValid == 0;
+}
+
+void TigerTree::loadCache(const uint8_t* buf, size_t size)
+{
+	if (!isEmpty()) return; // keep what's already calculated
+
+	TTPersistHeader header;
+	if (size < sizeof(header)) return;
+	memcpy(&header, buf, sizeof(header));
+	auto num = entry.numNodes / PERSIST_LEVEL;
+	if ((memcmp(header.magic, TT_PERSIST_MAGIC, sizeof(header.magic)) != 0) ||
+	    (header.dataSize != dataSize) ||
+	    (header.time != entry.time) ||
+	    (header.numNodes != entry.numNodes) ||
+	    (size != sizeof(header) + num * (1 + sizeof(TigerHash)))) {
+		return; // different (version of the) data
+	}
+	buf += sizeof(header);
+	for (size_t n = PERSIST_LEVEL - 1; n < entry.numNodes; n += PERSIST_LEVEL) {
+		if (*buf++) {
+			memcpy(entry.hash[n].h8, buf, sizeof(TigerHash));
+			entry.valid[n] = true;
+			entry.numNodesValid++;
+		}
+		buf += sizeof(TigerHash);
+	}
+	entry.dirty = false;
+}
+
+// Calculate all full, aligned subtrees of CHUNK_BLOCKS leafs in parallel.
+// Fetching the data (TTData isn't thread-safe) is done in this thread,
+// while the helper threads hash the previously fetched chunks. Everything
+// that remains (the top of the tree and the partial last chunk) is later
+// calculated by calcHash(Node).
+void TigerTree::calcChunks(const std::function<void(size_t, size_t)>& progressCallback)
+{
+	auto numChunks = dataSize / (CHUNK_BLOCKS * BLOCK_SIZE);
+	auto numThreads = unsigned(std::min<size_t>(
+		std::min(std::thread::hardware_concurrency(), MAX_THREADS),
+		numChunks));
+	if (numThreads < 2) return; // not worth it
+
+	struct Job {
+		void operator()() {
+			count = tree->calcSubTree(root, buffer.data() + 1, offset);
+		}
+		TigerTree* tree = nullptr;
+		Node root{0, 0};
+		size_t offset = 0;
+		size_t count = 0;
+		// one extra byte in front, see tiger_leaf()
+		MemBuffer<uint8_t> buffer{CHUNK_BLOCKS * BLOCK_SIZE + 1};
+		bool busy = false;
+	};
+	std::vector<HelperThread> threads(numThreads);
+	std::vector<Job> jobs(numThreads);
+	auto finish = [&](unsigned i) {
+		if (!jobs[i].busy) return;
+		threads[i].wait();
+		jobs[i].busy = false;
+		entry.numNodesValid += jobs[i].count;
+		if (jobs[i].count) entry.dirty = true;
+		if (progressCallback) {
+			progressCallback(entry.numNodesValid, entry.numNodes);
+		}
+	};
+	auto finishAll = [&] {
+		for (auto i : xrange(numThreads)) finish(i);
+	};
+
+	try {
+		unsigned i = 0;
+		for (auto c : xrange(numChunks)) {
+			Node root(c * 2 * CHUNK_BLOCKS + CHUNK_BLOCKS - 1, CHUNK_BLOCKS);
+			if (entry.valid[root.n]) continue;
+
+			finish(i);
+			auto& job = jobs[i];
+			job.tree = this;
+			job.root = root;
+			job.offset = c * CHUNK_BLOCKS * BLOCK_SIZE;
+			for (auto b : xrange(CHUNK_BLOCKS)) {
+				if (entry.valid[getLeaf(c * CHUNK_BLOCKS + b).n]) continue;
+				auto offset = b * BLOCK_SIZE;
+				memcpy(job.buffer.data() + 1 + offset,
+				       data.getData(job.offset + offset, BLOCK_SIZE),
+				       BLOCK_SIZE);
+			}
+			job.busy = true;
+			threads[i].start(job);
+			i = (i + 1) % numThreads;
+		}
+	} catch (...) {
+		finishAll();
+		throw;
+	}
+	finishAll();
+}
+
+// Executed on a helper thread: only touches the nodes of the given subtree
+// and doesn't update 'numNodesValid' (instead returns the number of newly
+// calculated nodes).
+size_t TigerTree::calcSubTree(Node node, uint8_t* buf, size_t offset)
+{
+	auto n = node.n;
+	if (entry.valid[n]) return 0;
+
+	size_t count = 1;
+	if (n & 1) {
+		// interior node
+		auto left  = getLeftChild (node);
+		auto right = getRightChild(node);
+		count += calcSubTree(left,  buf, offset);
+		count += calcSubTree(right, buf, offset);
+		tiger_int(entry.hash[left.n], entry.hash[right.n], entry.hash[n]);
+	} else {
+		// leaf node (always a full block)
+		size_t b = n * (BLOCK_SIZE / 2);
+		tiger_leaf(buf + (b - offset), entry.hash[n]);
+	}
+	entry.valid[n] = true;
+	return count;
+}
+
 const TigerHash& TigerTree::calcHash(Node node, const std::function<void(size_t, size_t)>& progressCallback)
 {
 	auto n = node.n;
@@ -108,6 +301,7 @@ const TigerHash& TigerTree::calcHash(Node node, const std::function<void(size_t,
 		}
 		entry.valid[n] = true;
 		entry.numNodesValid++;
+		entry.dirty = true;
 		if (progressCallback) {
 			progressCallback(entry.numNodesValid, entry.numNodes);
 		}
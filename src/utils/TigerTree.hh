@@ -31,6 +31,7 @@
 #include "tiger.hh"
 #include "MemBuffer.hh"
 #include <string>
+#include <vector>
 #include <cstdint>
 #include <ctime>
 #include <functional>
@@ -88,6 +89,27 @@ public:
 	 */
 	void notifyChange(size_t offset, size_t len, time_t time);
 
+	/** Store the upper part of the tree (see PERSIST_LEVEL) in the given
+	 * buffer. This can be written to disk and given to loadCache() (e.g.
+	 * after a restart of openMSX), so that the hash of a large (harddisk)
+	 * image doesn't have to be fully recalculated. Returns false when
+	 * there's nothing worth storing, or nothing changed since the last
+	 * saveCache() or loadCache().
+	 */
+	bool saveCache(std::vector<uint8_t>& buf);
+
+	/** Restore the state that was stored with saveCache(). This is only
+	 * done when the stored data belongs to the current content of the
+	 * input data (same size and same time, see TTData::isCacheStillValid())
+	 * and when nothing was calculated yet.
+	 */
+	void loadCache(const uint8_t* buf, size_t size);
+
+	/** Is nothing calculated (or loaded) yet? Only then loadCache() has
+	 * any effect.
+	 */
+	bool isEmpty() const;
+
 private:
 	// functions to navigate in binary tree
 	struct Node {
@@ -102,6 +124,8 @@ private:
 	Node getRightChild(Node node) const;
 
 	const TigerHash& calcHash(Node node, const std::function<void(size_t, size_t)>& progressCallback);
+	void calcChunks(const std::function<void(size_t, size_t)>& progressCallback);
+	size_t calcSubTree(Node node, uint8_t* buf, size_t offset);
 
 	TTData& data;
 	const size_t dataSize;
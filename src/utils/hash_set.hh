@@ -223,7 +223,10 @@ private:
 		//  we implement that 'if' via template specialization. So only
 		//  the code path that will be executed gets instantiated. In
 		//  C++17 we can simply that by using 'if constexpr'.
-		ReallocFunc<std::is_trivially_move_constructible<Elem>::value> reallocFunc;
+		//  Also require trivially copyable, otherwise gcc-8 still warns
+		//  (e.g. for the std::pair in hash_map<const void*, unsigned>).
+		ReallocFunc<std::is_trivially_move_constructible<Elem>::value &&
+		            std::is_trivially_copyable<Elem>::value> reallocFunc;
 #endif
 		Elem* newBuf = reallocFunc(oldBuf, capacity_, newCapacity);
 
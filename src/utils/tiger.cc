@@ -708,7 +708,8 @@ void tiger(const uint8_t* str, size_t length, TigerHash& result)
 
 void tiger_int(const TigerHash& h0, const TigerHash& h1, TigerHash& result)
 {
-	static uint8_t buf[64] = {
+	// Not static: TigerTree calls this from multiple threads.
+	uint8_t buf[64] = {
 		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -728,7 +729,8 @@ void tiger_int(const TigerHash& h0, const TigerHash& h1, TigerHash& result)
 
 void tiger_leaf(/*const*/ uint8_t data[1024], TigerHash& result)
 {
-	static uint8_t last[64] = {
+	// Not static: TigerTree calls this from multiple threads.
+	uint8_t last[64] = {
 		0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
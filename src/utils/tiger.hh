@@ -45,14 +45,15 @@ void tiger(const uint8_t* str, size_t length, TigerHash& result);
 /** Use for tiger-tree internal node hash calculations.
  * Combine two earlier calculated tiger hash values in a specific way (add
  * marker/padding/length bytes before/after) and calculate a new hash value.
- * This function is not reentrant.
+ * This function is reentrant.
  */
 void tiger_int(const TigerHash& h0, const TigerHash& h1, TigerHash& result);
 
 /** Use for tiger-tree leaf node hash calculations.
  * Take a 1024-byte input block, add some marker/padding/length bytes
  * before/after and calculate a tiger-hash.
- * This function is not reentrant.
+ * This function is reentrant (as long as concurrent calls don't use
+ * overlapping data buffers, see below).
  * This function requires that data[-1] can be (temporarily) overridden (so
  * after the function returns the data buffer is unchanged, but temporarily
  * it is changed, hence the parameter cannot be const).
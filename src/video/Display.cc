@@ -18,6 +18,8 @@
 #include "HardwareConfig.hh"
 #include "XMLElement.hh"
 #include "VideoSystemChangeListener.hh"
+#include "TTFFont.hh"
+#include "TclObject.hh"
 #include "CommandException.hh"
 #include "StringOp.hh"
 #include "Version.hh"
@@ -38,11 +40,14 @@ Display::Display(Reactor& reactor_)
 	: RTSchedulable(reactor_.getRTScheduler())
 	, screenShotCmd(reactor_.getCommandController())
 	, fpsInfo(reactor_.getOpenMSXInfoCommand())
+	, fontCacheInfo(reactor_.getOpenMSXInfoCommand())
 	, osdGui(reactor_.getCommandController(), *this)
 	, reactor(reactor_)
 	, renderSettings(reactor.getCommandController())
 	, commandConsole(reactor.getGlobalCommandController(),
 	                 reactor.getEventDistributor(), *this)
+	, screenShotWriter(reactor.getCommandController(),
+	                   reactor.getEventDistributor(), reactor.getCliComm())
 	, currentRenderer(RenderSettings::UNINITIALIZED)
 	, resolution(-1, -1)
 	, switchInProgress(false)
@@ -403,6 +408,7 @@ void Display::ScreenShotCmd::execute(array_ref<TclObject> tokens, TclObject& res
 	bool rawShot = false;
 	bool withOsd = false;
 	bool doubleSize = false;
+	bool async = false;
 	string_view prefix = "openmsx";
 	vector<TclObject> arguments;
 	for (unsigned i = 1; i < tokens.size(); ++i) {
@@ -430,6 +436,8 @@ void Display::ScreenShotCmd::execute(array_ref<TclObject> tokens, TclObject& res
 				doubleSize = true;
 			} else if (tok == "-with-osd") {
 				withOsd = true;
+			} else if (tok == "-async") {
+				async = true;
 			} else {
 				throw CommandException("Invalid option: ", tok);
 			}
@@ -460,10 +468,11 @@ void Display::ScreenShotCmd::execute(array_ref<TclObject> tokens, TclObject& res
 	string filename = FileOperations::parseCommandFileArgument(
 		fname, "screenshots", prefix, ".png");
 
+	PNG::Image image;
 	if (!rawShot) {
 		// include all layers (OSD stuff, console)
 		try {
-			display.getVideoSystem().takeScreenShot(filename, withOsd);
+			image = display.getVideoSystem().takeScreenShot(withOsd);
 		} catch (MSXException& e) {
 			throw CommandException(
 				"Failed to take screenshot: ", e.getMessage());
@@ -477,14 +486,23 @@ void Display::ScreenShotCmd::execute(array_ref<TclObject> tokens, TclObject& res
 		}
 		unsigned height = doubleSize ? 480 : 240;
 		try {
-			videoLayer->takeRawScreenShot(height, filename);
+			image = videoLayer->takeRawScreenShot(height);
 		} catch (MSXException& e) {
 			throw CommandException(
 				"Failed to take screenshot: ", e.getMessage());
 		}
 	}
 
-	display.getCliComm().printInfo("Screen saved to ", filename);
+	try {
+		display.screenShotWriter.write(std::move(image), filename, async);
+	} catch (MSXException& e) {
+		throw CommandException(
+			"Failed to take screenshot: ", e.getMessage());
+	}
+	if (!async) {
+		// (when async, ScreenShotWriter reports this when it's written)
+		display.getCliComm().printInfo("Screen saved to ", filename);
+	}
 	result.setString(filename);
 }
 
@@ -497,6 +515,7 @@ string Display::ScreenShotCmd::help(const vector<string>& /*tokens*/) const
 	       "screenshot -raw              320x240 raw screenshot (of MSX screen only)\n"
 	       "screenshot -raw -doublesize  640x480 raw screenshot (of MSX screen only)\n"
 	       "screenshot -with-osd         Include OSD elements in the screenshot\n"
+	       "screenshot -async            Compress and write the file in the background\n"
 	       "screenshot -no-sprites       Don't include sprites in the screenshot\n";
 }
 
@@ -504,6 +523,7 @@ void Display::ScreenShotCmd::tabCompletion(vector<string>& tokens) const
 {
 	static const char* const extra[] = {
 		"-prefix", "-raw", "-doublesize", "-with-osd", "-no-sprites",
+		"-async",
 	};
 	completeFileName(tokens, userFileContext(), extra);
 }
@@ -529,4 +549,28 @@ string Display::FpsInfoTopic::help(const vector<string>& /*tokens*/) const
 	return "Returns the current rendering speed in frames per second.";
 }
 
+
+// FontCacheInfoTopic
+
+Display::FontCacheInfoTopic::FontCacheInfoTopic(InfoCommand& openMSXInfoCommand)
+	: InfoTopic(openMSXInfoCommand, "font_cache")
+{
+}
+
+void Display::FontCacheInfoTopic::execute(array_ref<TclObject> /*tokens*/,
+                           TclObject& result) const
+{
+	TTFFont::getCacheInfo(result);
+}
+
+string Display::FontCacheInfoTopic::help(const vector<string>& /*tokens*/) const
+{
+	return "Returns statistics of the glyph cache used to render the text "
+	       "of the console and OSD widgets, as a dictionary: the number of "
+	       "cached fonts and glyphs, the memory used by the glyph bitmaps "
+	       "(in bytes), the number of glyph lookups that hit or missed the "
+	       "cache, the hit rate, and the number of texts that couldn't use "
+	       "the cache (e.g. because of invalid UTF-8).";
+}
+
 } // namespace openmsx
@@ -6,6 +6,7 @@
 #include "CommandConsole.hh"
 #include "InfoTopic.hh"
 #include "OSDGUI.hh"
+#include "ScreenShotWriter.hh"
 #include "EventListener.hh"
 #include "LayerListener.hh"
 #include "RTSchedulable.hh"
@@ -114,11 +115,19 @@ private:
 		std::string help(const std::vector<std::string>& tokens) const override;
 	} fpsInfo;
 
+	struct FontCacheInfoTopic final : InfoTopic {
+		explicit FontCacheInfoTopic(InfoCommand& openMSXInfoCommand);
+		void execute(array_ref<TclObject> tokens,
+			     TclObject& result) const override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} fontCacheInfo;
+
 	OSDGUI osdGui;
 
 	Reactor& reactor;
 	RenderSettings renderSettings;
 	CommandConsole commandConsole;
+	ScreenShotWriter screenShotWriter;
 
 	// the current renderer
 	RenderSettings::RendererID currentRenderer;
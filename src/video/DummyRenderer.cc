@@ -16,6 +16,14 @@ void DummyRenderer::frameStart(EmuTime::param /*time*/) {
 void DummyRenderer::frameEnd(EmuTime::param /*time*/) {
 }
 
+bool DummyRenderer::isFrameRendered() const {
+	return false;
+}
+
+bool DummyRenderer::needsVRAMTiming() const {
+	return false;
+}
+
 void DummyRenderer::updateTransparency(bool /*enabled*/, EmuTime::param /*time*/) {
 }
 
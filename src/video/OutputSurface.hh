@@ -2,6 +2,7 @@
 #define OUTPUTSURFACE_HH
 
 #include "OutputRectangle.hh"
+#include "PNG.hh"
 #include "gl_vec.hh"
 #include <string>
 #include <cassert>
@@ -121,10 +122,10 @@ public:
 	  */
 	virtual void flushFrameBuffer();
 
-	/** Save the content of this OutputSurface to a PNG file.
-	  * @throws MSXException If creating the PNG file fails.
+	/** Copy the content of this OutputSurface, to save it as a PNG file.
+	  * @throws MSXException If reading the content fails.
 	  */
-	virtual void saveScreenshot(const std::string& filename) = 0;
+	virtual PNG::Image getScreenshot() = 0;
 
 	/** Clear screen (paint it black).
 	 */
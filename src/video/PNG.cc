@@ -11,7 +11,9 @@
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
+#include <memory>
 #include <png.h>
+#include <zlib.h>
 #include <SDL.h>
 
 namespace openmsx {
@@ -294,11 +296,9 @@ static void flushData(png_structp ctx)
 }
 
 static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
-                           const std::string& filename, bool color)
+                           File& file, bool color, int compressionLevel)
 {
 	try {
-		File file(filename, File::TRUNCATE);
-
 		PNGWriteHandle png;
 		png.ptr = png_create_write_struct(
 			PNG_LIBPNG_VER_STRING,
@@ -317,6 +317,13 @@ static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
 		// Set up the output control.
 		png_set_write_fn(png.ptr, &file, writeData, flushData);
 
+		png_set_compression_level(png.ptr, compressionLevel);
+		if (compressionLevel == 0) {
+			// Filtering only helps compression, skip it when the
+			// data isn't compressed anyway.
+			png_set_filter(png.ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+		}
+
 		// Mark this image as being generated by openMSX and add creation time.
 		std::string version = Version::full();
 		png_text text[2];
@@ -333,12 +340,19 @@ static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
 		// (and also to work around the windows _snprintf stuff) we add
 		// some extra buffer space.
 		static constexpr size_t size = (10 + 1 + 8 + 1) + 44;
+		// This runs on the ScreenShotWriter thread, so use the
+		// reentrant version of localtime().
 		time_t now = time(nullptr);
-		struct tm* tm = localtime(&now);
+		struct tm tm;
+#ifdef _WIN32
+		localtime_s(&tm, &now);
+#else
+		localtime_r(&now, &tm);
+#endif
 		char timeStr[size];
 		snprintf(timeStr, sizeof(timeStr), "%04d-%02d-%02d %02d:%02d:%02d",
-				1900 + tm->tm_year, tm->tm_mon + 1, tm->tm_mday,
-				tm->tm_hour, tm->tm_min, tm->tm_sec);
+				1900 + tm.tm_year, tm.tm_mon + 1, tm.tm_mday,
+				tm.tm_hour, tm.tm_min, tm.tm_sec);
 		text[1].text = timeStr;
 
 		png_set_text(png.ptr, png.info, text, 2);
@@ -356,14 +370,34 @@ static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
 			png.ptr,
 			reinterpret_cast<png_bytep*>(const_cast<void**>(row_pointers)));
 		png_write_end(png.ptr, png.info);
+	} catch (MSXException& e) {
+		throw MSXException(
+			"Error while writing PNG file \"", file.getURL(), "\": ",
+			e.getMessage());
+	}
+}
+
+static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
+                           const std::string& filename, bool color)
+{
+	std::unique_ptr<File> file;
+	try {
+		file = std::make_unique<File>(filename, File::TRUNCATE);
 	} catch (MSXException& e) {
 		throw MSXException(
 			"Error while writing PNG file \"", filename, "\": ",
 			e.getMessage());
 	}
+	IMG_SavePNG_RW(width, height, row_pointers, *file, color,
+	               Z_DEFAULT_COMPRESSION);
 }
 
-void save(SDL_Surface* image, const std::string& filename)
+const uint8_t* Image::getLinePtr(unsigned y) const
+{
+	return &pixels[y * width * (color ? 3 : 1)];
+}
+
+Image createImage(SDL_Surface* image)
 {
 	SDL_PixelFormat frmt24;
 	frmt24.palette = nullptr;
@@ -385,17 +419,20 @@ void save(SDL_Surface* image, const std::string& filename)
 	frmt24.alpha = 0;
 	SDLSurfacePtr surf24(SDL_ConvertSurface(image, &frmt24, 0));
 
-	// Create the array of pointers to image data
-	VLA(const void*, row_pointers, image->h);
+	Image result;
+	result.width = image->w;
+	result.height = image->h;
+	result.color = true;
+	result.pixels.resize(image->w * image->h * 3);
 	for (int i = 0; i < image->h; ++i) {
-		row_pointers[i] = surf24.getLinePtr(i);
+		memcpy(&result.pixels[i * image->w * 3],
+		       surf24.getLinePtr(i), image->w * 3);
 	}
-
-	IMG_SavePNG_RW(image->w, image->h, row_pointers, filename, true);
+	return result;
 }
 
-void save(unsigned width, unsigned height, const void** rowPointers,
-          const SDL_PixelFormat& format, const std::string& filename)
+Image createImage(unsigned width, unsigned height, const void** rowPointers,
+                  const SDL_PixelFormat& format)
 {
 	// this implementation creates 1 extra copy, can be optimized if required
 	SDLSurfacePtr surface(
@@ -405,13 +442,17 @@ void save(unsigned width, unsigned height, const void** rowPointers,
 		memcpy(surface.getLinePtr(y),
 		       rowPointers[y], width * format.BytesPerPixel);
 	}
-	save(surface.get(), filename);
+	return createImage(surface.get());
 }
 
-void save(unsigned width, unsigned height,
-          const void** rowPointers, const std::string& filename)
+void save(const Image& image, File& file, int compressionLevel)
 {
-	IMG_SavePNG_RW(width, height, rowPointers, filename, true);
+	VLA(const void*, rowPointers, image.height);
+	for (unsigned y = 0; y < image.height; ++y) {
+		rowPointers[y] = image.getLinePtr(y);
+	}
+	IMG_SavePNG_RW(image.width, image.height, rowPointers, file,
+	               image.color, compressionLevel);
 }
 
 void saveGrayscale(unsigned width, unsigned height,
@@ -2,6 +2,8 @@
 #define PNG_HH
 
 #include "SDLSurfacePtr.hh"
+#include "MemBuffer.hh"
+#include <cstdint>
 #include <string>
 
 struct SDL_Surface;
@@ -9,6 +11,8 @@ struct SDL_PixelFormat;
 
 namespace openmsx {
 
+class File;
+
 /** Utility functions to hide the complexity of saving to a PNG file.
   */
 namespace PNG {
@@ -20,11 +24,35 @@ namespace PNG {
 	 */
 	SDLSurfacePtr load(const std::string& filename, bool want32bpp);
 
-	void save(SDL_Surface* image, const std::string& filename);
-	void save(unsigned width, unsigned height, const void** rowPointers,
-	          const SDL_PixelFormat& format, const std::string& filename);
-	void save(unsigned width, unsigned height, const void** rowPointers,
-	          const std::string& filename);
+	/** An image in the format that is stored in the PNG file: 8 bits per
+	 * color component, RGB (or grayscale), without padding between the
+	 * rows. Creating it is cheap compared to compressing it, so this
+	 * allows to do the latter later (e.g. on another thread, see
+	 * ScreenShotWriter).
+	 */
+	struct Image {
+		const uint8_t* getLinePtr(unsigned y) const;
+
+		MemBuffer<uint8_t> pixels;
+		unsigned width = 0;
+		unsigned height = 0;
+		bool color = true;
+	};
+
+	/** Copy the given surface or rows of pixels (in the given pixel
+	 * format) into a (color) Image.
+	 */
+	Image createImage(SDL_Surface* image);
+	Image createImage(unsigned width, unsigned height,
+	                  const void** rowPointers, const SDL_PixelFormat& format);
+
+	/** Compress the given image and write it as a PNG file.
+	 * @param compressionLevel zlib compression level: 0 (fastest, not
+	 *        compressed) till 9 (smallest)
+	 * @throws MSXException
+	 */
+	void save(const Image& image, File& file, int compressionLevel);
+
 	void saveGrayscale(unsigned width, unsigned height,
 	                   const void** rowPointers, const std::string& filename);
 
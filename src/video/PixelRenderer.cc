@@ -234,6 +234,20 @@ void PixelRenderer::frameEnd(EmuTime::param time)
 	}
 }
 
+bool PixelRenderer::isFrameRendered() const
+{
+	return renderFrame;
+}
+
+bool PixelRenderer::needsVRAMTiming() const
+{
+	// Same conditions as in checkSync(): only when the current frame is
+	// rendered with a line or pixel accuracy, a VRAM write can trigger a
+	// (partial) render of the display area.
+	return renderFrame && displayEnabled &&
+	       (accuracy != RenderSettings::ACC_SCREEN);
+}
+
 void PixelRenderer::updateHorizontalScrollLow(
 	byte scroll, EmuTime::param time)
 {
@@ -245,6 +259,7 @@ void PixelRenderer::updateHorizontalScrollHigh(
 	byte /*scroll*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateBorderMask(
@@ -258,6 +273,7 @@ void PixelRenderer::updateMultiPage(
 	bool /*multiPage*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateTransparency(
@@ -278,6 +294,7 @@ void PixelRenderer::updateForegroundColor(
 	int /*color*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateBackgroundColor(
@@ -291,12 +308,14 @@ void PixelRenderer::updateBlinkForegroundColor(
 	int /*color*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateBlinkBackgroundColor(
 	int /*color*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateBlinkState(
@@ -307,6 +326,7 @@ void PixelRenderer::updateBlinkState(
 	//       I don't know why exactly, but it's probably related to
 	//       being called at frame start.
 	//sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updatePalette(
@@ -335,6 +355,11 @@ void PixelRenderer::updateVerticalScroll(
 	int /*scroll*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	if (vdp.getDisplayMode().isTextMode()) {
+		// In other modes the scroll position only selects which
+		// display line is drawn, it doesn't change its content.
+		rasterizer->invalidateLineCache();
+	}
 }
 
 void PixelRenderer::updateHorizontalAdjust(
@@ -363,18 +388,21 @@ void PixelRenderer::updateNameBase(
 	int /*addr*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updatePatternBase(
 	int /*addr*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateColorBase(
 	int /*addr*/, EmuTime::param time)
 {
 	if (displayEnabled) sync(time);
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::updateSpritesEnabled(
@@ -409,8 +437,8 @@ inline bool PixelRenderer::checkSync(int offset, EmuTime::param time)
 	// If display is disabled, VRAM changes will not affect the
 	// renderer output, therefore sync is not necessary.
 	// TODO: Have bitmapVisibleWindow disabled in this case.
+	// Likewise for frames that are skipped, see updateVRAM().
 	if (!displayEnabled) return false;
-	//if (frameSkipCounter != 0) return false; // TODO
 	if (accuracy == RenderSettings::ACC_SCREEN) return false;
 
 	// Calculate what display lines are scanned between current
@@ -496,6 +524,7 @@ void PixelRenderer::updateVRAM(unsigned offset, EmuTime::param time)
 		//	vdp.getTicksThisFrame(time) / VDP::TICKS_PER_LINE);
 		renderUntil(time);
 	}
+	rasterizer->updateVRAMCache(offset);
 }
 
 void PixelRenderer::updateWindow(bool /*enabled*/, EmuTime::param /*time*/)
@@ -504,6 +533,9 @@ void PixelRenderer::updateWindow(bool /*enabled*/, EmuTime::param /*time*/)
 	// This update is redundant: Renderer will be notified in another way
 	// as well (updateDisplayEnabled or updateNameBase, for example).
 	// TODO: Can this be used as the main update method instead?
+	// It's also sent when the VRAM contents got rearranged, so previously
+	// drawn display lines can't be reused.
+	rasterizer->invalidateLineCache();
 }
 
 void PixelRenderer::sync(EmuTime::param time, bool force)
@@ -521,7 +553,6 @@ void PixelRenderer::sync(EmuTime::param time, bool force)
 	// the past.
 	// TODO: I wonder if it's possible to enforce this synchronisation
 	//       scheme at a higher level. Probably. But how...
-	//if ((frameSkipCounter == 0) && TODO
 	if (accuracy != RenderSettings::ACC_SCREEN || force) {
 		vram.sync(time);
 		renderUntil(time);
@@ -34,6 +34,8 @@ public:
 	void reInit() override;
 	void frameStart(EmuTime::param time) override;
 	void frameEnd(EmuTime::param time) override;
+	bool isFrameRendered() const override;
+	bool needsVRAMTiming() const override;
 	void updateHorizontalScrollLow(byte scroll, EmuTime::param time) override;
 	void updateHorizontalScrollHigh(byte scroll, EmuTime::param time) override;
 	void updateBorderMask(bool masked, EmuTime::param time) override;
@@ -9,6 +9,7 @@
 #include "RenderSettings.hh"
 #include "RawFrame.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExporter.hh"
 #include "CliComm.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
@@ -35,6 +36,7 @@ PostProcessor::PostProcessor(MSXMotherBoard& motherBoard_,
 	, screen(screen_)
 	, paintFrame(nullptr)
 	, recorder(nullptr)
+	, exporter(nullptr)
 	, superImposeVideoFrame(nullptr)
 	, superImposeVdpFrame(nullptr)
 	, interleaveCount(0)
@@ -73,6 +75,9 @@ PostProcessor::~PostProcessor()
 			"during recording.");
 		recorder->stop();
 	}
+	if (exporter) {
+		exporter->stop();
+	}
 }
 
 CliComm& PostProcessor::getCliComm()
@@ -190,6 +195,9 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 			assert(!recorder);
 		}
 	}
+	if (exporter && needRecord()) {
+		exporter->addImage(paintFrame, time);
+	}
 
 	// Return recycled frame to the caller
 	if (canDoInterlace) {
@@ -255,7 +263,7 @@ static void getScaledFrame(FrameSource& paintFrame, unsigned bpp,
 	}
 }
 
-void PostProcessor::takeRawScreenShot(unsigned height2, const std::string& filename)
+PNG::Image PostProcessor::takeRawScreenShot(unsigned height2)
 {
 	if (!paintFrame) {
 		throw CommandException("TODO");
@@ -265,7 +273,8 @@ void PostProcessor::takeRawScreenShot(unsigned height2, const std::string& filen
 	WorkBuffer workBuffer;
 	getScaledFrame(*paintFrame, getBpp(), height2, lines, workBuffer);
 	unsigned width = (height2 == 240) ? 320 : 640;
-	PNG::save(width, height2, lines, paintFrame->getSDLPixelFormat(), filename);
+	return PNG::createImage(width, height2, lines,
+	                        paintFrame->getSDLPixelFormat());
 }
 
 unsigned PostProcessor::getBpp() const
@@ -18,6 +18,7 @@ class DoubledFrame;
 class Deflicker;
 class SuperImposedFrame;
 class AviRecorder;
+class SharedMemoryExporter;
 class CliComm;
 class EventDistributor;
 
@@ -71,6 +72,11 @@ public:
 	  */
 	void setRecorder(AviRecorder* recorder_) { recorder = recorder_; }
 
+	/** Sets the SharedMemoryExporter that finished frames should be
+	  * published to. Can also be nullptr, meaning no exporting.
+	  */
+	void setExporter(SharedMemoryExporter* exporter_) { exporter = exporter_; }
+
 	/** Is recording active.
 	  * ATM used to keep frameskip constant during recording.
 	  */
@@ -87,8 +93,14 @@ public:
 	  */
 	FrameSource* getPaintFrame() const { return paintFrame; }
 
+	/** Get the most recently finished frame (the one that was passed to
+	  * the last rotateFrames() call), or nullptr if not available.
+	  * SDLRasterizer uses this to copy display lines that didn't change.
+	  */
+	const RawFrame* getLastFrame() const { return lastFrames[0].get(); }
+
 	// VideoLayer
-	void takeRawScreenShot(unsigned height, const std::string& filename) override;
+	PNG::Image takeRawScreenShot(unsigned height) override;
 
 
 	CliComm& getCliComm();
@@ -133,6 +145,9 @@ protected:
 	/** Video recorder, nullptr when not recording. */
 	AviRecorder* recorder;
 
+	/** Shared memory exporter, nullptr when not exporting. */
+	SharedMemoryExporter* exporter;
+
 	/** Video frame on which to superimpose the (VDP) output.
 	  * nullptr when not superimposing. */
 	const RawFrame* superImposeVideoFrame;
@@ -62,6 +62,19 @@ public:
 	virtual void setTransparency(bool enabled) = 0;
 	virtual void setSuperimposeVideoFrame(const RawFrame* videoSource) = 0;
 
+	/** Some VDP state that influences the display area changed, and that
+	  * state isn't passed via one of the methods above (for example a
+	  * table base address or a text color). Display lines that were
+	  * converted before this call may no longer be reused.
+	  */
+	virtual void invalidateLineCache() = 0;
+
+	/** Informs the rasterizer of a change in VRAM contents.
+	  * This is called just before the new value is written.
+	  * @param address The VRAM address that will change.
+	  */
+	virtual void updateVRAMCache(unsigned address) = 0;
+
 	/** Render a rectangle of border pixels on the host screen.
 	  * The units are absolute lines (Y) and VDP clockticks (X).
 	  * @param fromX X coordinate of render start (inclusive).
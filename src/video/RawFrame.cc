@@ -8,6 +8,7 @@ RawFrame::RawFrame(
 		const SDL_PixelFormat& format, unsigned maxWidth_, unsigned height_)
 	: FrameSource(format)
 	, lineWidths(height_)
+	, displayInfos(height_)
 	, maxWidth(maxWidth_)
 {
 	setHeight(height_);
@@ -24,6 +25,7 @@ RawFrame::RawFrame(
 	// Start with a black frame.
 	init(FIELD_NONINTERLACED);
 	for (unsigned line = 0; line < height_; line++) {
+		displayInfos[line] = V9958RasterizerLineInfo();
 		if (bytesPerPixel == 2) {
 			setBlank(line, static_cast<uint16_t>(0));
 		} else {
@@ -5,6 +5,7 @@
 #include "MemBuffer.hh"
 #include "openmsx.hh"
 #include <cassert>
+#include <cstdint>
 
 namespace openmsx {
 
@@ -18,6 +19,24 @@ struct V9958RasterizerBorderInfo
 	bool masked;
 };
 
+// Used by SDLRasterizer to skip converting display lines that didn't change.
+// A valid entry means: the pixels [x, x + width) of this line are the result
+// of converting the VRAM line(s) 'src0'/'src1' in the VDP state identified
+// by 'stamp'. A zero stamp marks the entry as invalid.
+struct V9958RasterizerLineInfo
+{
+	bool operator==(const V9958RasterizerLineInfo& other) const {
+		return (stamp == other.stamp) &&
+		       (src0  == other.src0)  && (src1  == other.src1) &&
+		       (x     == other.x)     && (width == other.width);
+	}
+	void invalidate() { stamp = 0; }
+
+	uint64_t stamp;
+	unsigned src0, src1;
+	int x, width;
+};
+
 
 /** A video frame as output by the VDP scanline conversion unit,
   * before any postprocessing filters are applied.
@@ -31,6 +50,10 @@ public:
 	Pixel* getLinePtrDirect(unsigned y) {
 		return reinterpret_cast<Pixel*>(data.data() + y * pitch);
 	}
+	template<typename Pixel>
+	const Pixel* getLinePtrDirect(unsigned y) const {
+		return reinterpret_cast<const Pixel*>(data.data() + y * pitch);
+	}
 
 	unsigned getLineWidthDirect(unsigned y) const {
 		return lineWidths[y];
@@ -48,6 +71,7 @@ public:
 		Pixel* pixels = getLinePtrDirect<Pixel>(line);
 		pixels[0] = color;
 		lineWidths[line] = 1;
+		displayInfos[line].invalidate();
 	}
 
 	unsigned getRowLength() const override;
@@ -56,6 +80,16 @@ public:
 	// thing it does is store the information and give access to it.
 	V9958RasterizerBorderInfo& getBorderInfo() { return borderInfo; }
 
+	// Same for the per-line display info.
+	V9958RasterizerLineInfo& getDisplayInfo(unsigned line) {
+		assert(line < getHeight());
+		return displayInfos[line];
+	}
+	const V9958RasterizerLineInfo& getDisplayInfo(unsigned line) const {
+		assert(line < getHeight());
+		return displayInfos[line];
+	}
+
 protected:
 	unsigned getLineWidth(unsigned line) const override;
 	const void* getLineInfo(
@@ -66,6 +100,7 @@ protected:
 private:
 	MemBuffer<char, 64> data;
 	MemBuffer<unsigned> lineWidths;
+	MemBuffer<V9958RasterizerLineInfo> displayInfos;
 	unsigned maxWidth;
 	unsigned pitch;
 
@@ -138,6 +138,11 @@ RenderSettings::RenderSettings(CommandController& commandController)
 		"disablesprites", "disable sprite rendering",
 		false, Setting::DONT_SAVE)
 
+	, v9990RenderThreadSetting(commandController,
+		"v9990_render_thread", "convert V9990 (GFX9000) display lines "
+		"partly on a separate thread (only helps on multi-core hosts)",
+		false)
+
 	, cmdTimingSetting(commandController,
 		"cmdtiming", "VDP command timing", false,
 		EnumSetting<bool>::Map{{"real", false}, {"broken", true}},
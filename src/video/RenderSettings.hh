@@ -131,6 +131,9 @@ public:
 	/** Disable sprite rendering? */
 	bool getDisableSprites() const { return disableSpritesSetting.getBoolean(); }
 
+	/** Convert V9990 display lines on a helper thread? */
+	bool getV9990RenderThread() const { return v9990RenderThreadSetting.getBoolean(); }
+
 	/** CmdTiming [real, broken].
 	  * This setting is intended for debugging only, not for users. */
 	EnumSetting<bool>& getCmdTimingSetting() { return cmdTimingSetting; }
@@ -219,6 +222,7 @@ private:
 	IntegerSetting scanlineAlphaSetting;
 	BooleanSetting limitSpritesSetting;
 	BooleanSetting disableSpritesSetting;
+	BooleanSetting v9990RenderThreadSetting;
 	EnumSetting<bool> cmdTimingSetting;
 	EnumSetting<bool> tooFastAccessSetting;
 	EnumSetting<DisplayDeform> displayDeformSetting;
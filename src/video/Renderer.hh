@@ -44,6 +44,22 @@ public:
 	  */
 	virtual void frameEnd(EmuTime::param time) = 0;
 
+	/** Will the frame that was started by the last frameStart() call be
+	  * drawn? When not (e.g. because of frame skipping) the VDP only needs
+	  * to calculate the state that is visible to the MSX (like the sprite
+	  * status bits), not the information that is only used for drawing.
+	  */
+	virtual bool isFrameRendered() const = 0;
+
+	/** Does the output of this renderer depend on the exact moment in
+	  * time a VRAM write happens?
+	  * If not, the command engine is allowed to perform a series of VRAM
+	  * writes in bulk (see VDPVRAM::cmdWriteBulk()).
+	  * The result may only change at moments where the command engine
+	  * is synchronised anyway (e.g. a change in display enabled state).
+	  */
+	virtual bool needsVRAMTiming() const = 0;
+
 	/** Informs the renderer of a VDP transparency enable/disable change.
 	  * @param enabled The new transparency state.
 	  * @param time The moment in emulated time this change occurs.
@@ -2,6 +2,9 @@
 #include "RenderSettings.hh"
 #include "Reactor.hh"
 #include "Display.hh"
+#include "MSXMotherBoard.hh"
+#include "VDP.hh"
+#include "V9990.hh"
 #include "Version.hh"
 #include "unreachable.hh"
 #include <memory>
@@ -20,6 +23,7 @@
 #if COMPONENT_LASERDISC
 #include "LDDummyRenderer.hh"
 #include "LDPixelRenderer.hh"
+#include "LaserdiscPlayer.hh"
 #endif
 
 using std::unique_ptr;
@@ -46,6 +50,9 @@ unique_ptr<VideoSystem> createVideoSystem(Reactor& reactor)
 
 unique_ptr<Renderer> createRenderer(VDP& vdp, Display& display)
 {
+	if (vdp.getMotherBoard().isHeadless()) {
+		return std::make_unique<DummyRenderer>();
+	}
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<DummyRenderer>();
@@ -61,6 +68,9 @@ unique_ptr<Renderer> createRenderer(VDP& vdp, Display& display)
 
 unique_ptr<V9990Renderer> createV9990Renderer(V9990& vdp, Display& display)
 {
+	if (vdp.getMotherBoard().isHeadless()) {
+		return std::make_unique<V9990DummyRenderer>();
+	}
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<V9990DummyRenderer>();
@@ -77,6 +87,9 @@ unique_ptr<V9990Renderer> createV9990Renderer(V9990& vdp, Display& display)
 #if COMPONENT_LASERDISC
 unique_ptr<LDRenderer> createLDRenderer(LaserdiscPlayer& ld, Display& display)
 {
+	if (ld.getMotherBoard().isHeadless()) {
+		return std::make_unique<LDDummyRenderer>();
+	}
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<LDDummyRenderer>();
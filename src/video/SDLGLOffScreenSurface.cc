@@ -37,9 +37,9 @@ void SDLGLOffScreenSurface::clearScreen()
 	SDLGLOutputSurface::clearScreen();
 }
 
-void SDLGLOffScreenSurface::saveScreenshot(const std::string& filename)
+PNG::Image SDLGLOffScreenSurface::getScreenshot()
 {
-	SDLGLOutputSurface::saveScreenshot(filename, getWidth(), getHeight());
+	return SDLGLOutputSurface::getScreenshot(getWidth(), getHeight());
 }
 
 } // namespace openmsx
@@ -19,7 +19,7 @@ public:
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	PNG::Image getScreenshot() override;
 	void flushFrameBuffer() override;
 	void clearScreen() override;
 
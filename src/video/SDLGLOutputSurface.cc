@@ -4,9 +4,8 @@
 #include "PNG.hh"
 #include "build-info.hh"
 #include "Math.hh"
-#include "MemBuffer.hh"
-#include "vla.hh"
 #include <SDL.h>
+#include <algorithm>
 
 using namespace gl;
 
@@ -146,16 +145,22 @@ void SDLGLOutputSurface::clearScreen()
 	glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void SDLGLOutputSurface::saveScreenshot(
-	const std::string& filename, unsigned width, unsigned height)
+PNG::Image SDLGLOutputSurface::getScreenshot(unsigned width, unsigned height)
 {
-	VLA(const void*, rowPointers, height);
-	MemBuffer<uint8_t> buffer(width * height * 3);
-	for (unsigned i = 0; i < height; ++i) {
-		rowPointers[height - 1 - i] = &buffer[width * 3 * i];
+	PNG::Image image;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(width * height * 3);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE,
+	             image.pixels.data());
+	// OpenGL returns the bottom line first
+	unsigned pitch = width * 3;
+	for (unsigned i = 0; i < height / 2; ++i) {
+		std::swap_ranges(&image.pixels[pitch * i],
+		                 &image.pixels[pitch * (i + 1)],
+		                 &image.pixels[pitch * (height - 1 - i)]);
 	}
-	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, buffer.data());
-	PNG::save(width, height, rowPointers, filename);
+	return image;
 }
 
 } // namespace openmsx
@@ -95,9 +95,9 @@ void SDLGLVisibleSurface::clearScreen()
 	SDLGLOutputSurface::clearScreen();
 }
 
-void SDLGLVisibleSurface::saveScreenshot(const std::string& filename)
+PNG::Image SDLGLVisibleSurface::getScreenshot()
 {
-	SDLGLOutputSurface::saveScreenshot(filename, getWidth(), getHeight());
+	return SDLGLOutputSurface::getScreenshot(getWidth(), getHeight());
 }
 
 void SDLGLVisibleSurface::finish()
@@ -24,7 +24,7 @@ public:
 private:
 	// OutputSurface
 	void flushFrameBuffer() override;
-	void saveScreenshot(const std::string& filename) override;
+	PNG::Image getScreenshot() override;
 	void clearScreen() override;
 
 	// VisibleSurface
@@ -30,10 +30,10 @@ SDLOffScreenSurface::SDLOffScreenSurface(const SDL_Surface& proto)
 	setBufferPtr(static_cast<char*>(surface->pixels), surface->pitch);
 }
 
-void SDLOffScreenSurface::saveScreenshot(const std::string& filename)
+PNG::Image SDLOffScreenSurface::getScreenshot()
 {
 	lock();
-	PNG::save(getSDLSurface(), filename);
+	return PNG::createImage(getSDLSurface());
 }
 
 void SDLOffScreenSurface::clearScreen()
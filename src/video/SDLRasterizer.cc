@@ -70,6 +70,39 @@ inline void SDLRasterizer<Pixel>::renderBitmapLine(Pixel* buf, unsigned vramLine
 	}
 }
 
+template <class Pixel>
+inline uint64_t SDLRasterizer<Pixel>::getBitmapLineStamp(unsigned vramLine) const
+{
+	if (vdp.getDisplayMode().isPlanar()) {
+		// see VDPVRAM::getReadAreaPlanar(): even and odd bytes of a
+		// line are stored in the lower and upper 64kB
+		unsigned block = vramLine & 511;
+		return std::max(vramLineStamps[block], vramLineStamps[block | 512]);
+	} else {
+		return vramLineStamps[vramLine & 1023];
+	}
+}
+
+template <class Pixel>
+inline bool SDLRasterizer<Pixel>::reuseDisplayLine(
+	int y, const V9958RasterizerLineInfo& info)
+{
+	auto& current = workFrame->getDisplayInfo(y);
+	if (current == info) {
+		// Unchanged since this (recycled) frame was drawn.
+		return true;
+	}
+	current = info;
+	if (prevFrame && (prevFrame->getDisplayInfo(y) == info)) {
+		// Unchanged since the previous frame was drawn.
+		memcpy(workFrame->getLinePtrDirect<Pixel>(y) + info.x,
+		       prevFrame->getLinePtrDirect<Pixel>(y) + info.x,
+		       info.width * sizeof(Pixel));
+		return true;
+	}
+	return false;
+}
+
 template <class Pixel>
 SDLRasterizer<Pixel>::SDLRasterizer(
 		VDP& vdp_, Display& display, VisibleSurface& screen_,
@@ -82,7 +115,13 @@ SDLRasterizer<Pixel>::SDLRasterizer(
 	, characterConverter(vdp, palFg, palBg)
 	, bitmapConverter(palFg, PALETTE256, V9958_COLORS)
 	, spriteConverter(vdp.getSpriteChecker())
+	, prevFrame(nullptr)
+	, changeCounter(1) // stamp 0 is reserved for invalid line infos
+	, stateStamp(1)
+	, charStamp(1)
 {
+	std::fill(std::begin(vramLineStamps), std::end(vramLineStamps), 1);
+
 	// Init the palette.
 	precalcPalette();
 
@@ -131,6 +170,11 @@ void SDLRasterizer<Pixel>::reset()
 	spriteConverter.setTransparency(vdp.getTransparency());
 
 	resetPalette();
+
+	// VRAM may have changed without notification (e.g. loadstate).
+	std::fill(std::begin(vramLineStamps), std::end(vramLineStamps),
+	          ++changeCounter);
+	charStamp = stateStamp = changeCounter;
 }
 
 template <class Pixel>
@@ -150,12 +194,33 @@ void SDLRasterizer<Pixel>::setSuperimposeVideoFrame(const RawFrame* videoSource)
 	postProcessor->setSuperimposeVideoFrame(videoSource);
 	precalcColorIndex0(vdp.getDisplayMode(), vdp.getTransparency(),
 	                   videoSource, vdp.getBackgroundColor());
+	invalidateLineCache();
+}
+
+template <class Pixel>
+void SDLRasterizer<Pixel>::invalidateLineCache()
+{
+	stateStamp = ++changeCounter;
+}
+
+template <class Pixel>
+void SDLRasterizer<Pixel>::updateVRAMCache(unsigned address)
+{
+	uint64_t stamp = ++changeCounter;
+	vramLineStamps[(address >> 7) & 1023] = stamp;
+	if (!vdp.getDisplayMode().isBitmapMode() &&
+	    (vram.nameTable   .isInside(address) ||
+	     vram.patternTable.isInside(address) ||
+	     vram.colorTable  .isInside(address))) {
+		charStamp = stamp;
+	}
 }
 
 template <class Pixel>
 void SDLRasterizer<Pixel>::frameStart(EmuTime::param time)
 {
 	workFrame = postProcessor->rotateFrames(std::move(workFrame), time);
+	prevFrame = postProcessor->getLastFrame();
 	workFrame->init(
 	    vdp.isInterlaced() ? (vdp.getEvenOdd() ? FrameSource::FIELD_ODD
 	                                           : FrameSource::FIELD_EVEN)
@@ -235,6 +300,7 @@ void SDLRasterizer<Pixel>::setDisplayMode(DisplayMode mode)
 	                           ? palGraphic7Sprites : palBg);
 
 	borderSettingChanged();
+	invalidateLineCache();
 }
 
 template <class Pixel>
@@ -250,6 +316,7 @@ void SDLRasterizer<Pixel>::setPalette(int index, int grb)
 	precalcColorIndex0(vdp.getDisplayMode(), vdp.getTransparency(),
 	                   vdp.isSuperimposing(), vdp.getBackgroundColor());
 	borderSettingChanged();
+	invalidateLineCache();
 }
 
 template <class Pixel>
@@ -260,24 +327,28 @@ void SDLRasterizer<Pixel>::setBackgroundColor(int index)
 				   vdp.isSuperimposing(), index);
 	}
 	borderSettingChanged();
+	invalidateLineCache();
 }
 
 template <class Pixel>
 void SDLRasterizer<Pixel>::setHorizontalAdjust(int /*adjust*/)
 {
 	borderSettingChanged();
+	invalidateLineCache();
 }
 
 template <class Pixel>
 void SDLRasterizer<Pixel>::setHorizontalScrollLow(byte /*scroll*/)
 {
 	borderSettingChanged();
+	invalidateLineCache();
 }
 
 template <class Pixel>
 void SDLRasterizer<Pixel>::setBorderMask(bool /*masked*/)
 {
 	borderSettingChanged();
+	invalidateLineCache();
 }
 
 template <class Pixel>
@@ -286,6 +357,7 @@ void SDLRasterizer<Pixel>::setTransparency(bool enabled)
 	spriteConverter.setTransparency(enabled);
 	precalcColorIndex0(vdp.getDisplayMode(), enabled,
 	                   vdp.isSuperimposing(), vdp.getBackgroundColor());
+	invalidateLineCache();
 }
 
 template <class Pixel>
@@ -474,6 +546,13 @@ void SDLRasterizer<Pixel>::drawBorder(
 			    (workFrame->getLineWidthDirect(y) != 1)) continue;
 			memset(workFrame->getLinePtrDirect<Pixel>(y) + x,
 			       num, border0, border1);
+			auto& info = workFrame->getDisplayInfo(y);
+			if ((int(x) < (info.x + info.width)) &&
+			    (info.x < int(x + num))) {
+				// Overwrote (part of) the display area, e.g.
+				// because display got disabled mid-line.
+				info.invalidate();
+			}
 			if (limitX == VDP::TICKS_PER_LINE) {
 				// Only set line width at the end (right
 				// border) of the line. This ensures we can
@@ -560,6 +639,20 @@ void SDLRasterizer<Pixel>::drawDisplay(
 				(vram.nameTable.getMask() >> 7) & (pageMaskOdd  | displayY)
 			};
 
+			V9958RasterizerLineInfo info;
+			info.stamp = std::max({
+				stateStamp,
+				getBitmapLineStamp(vramLine[scrollPage1]),
+				getBitmapLineStamp(vramLine[scrollPage2])});
+			info.src0 = vramLine[scrollPage1];
+			info.src1 = vramLine[scrollPage2];
+			info.x = leftBackground + displayX;
+			info.width = displayWidth;
+			if (reuseDisplayLine(y, info)) {
+				displayY = (displayY + 1) & 255;
+				continue;
+			}
+
 			Pixel buf[512];
 			int lineInBuf = -1; // buffer data not valid
 			Pixel* dst = workFrame->getLinePtrDirect<Pixel>(y)
@@ -592,9 +685,21 @@ void SDLRasterizer<Pixel>::drawDisplay(
 		}
 	} else {
 		// horizontal scroll (high) is implemented in CharacterConverter
+		uint64_t stamp = std::max(stateStamp, charStamp);
 		for (int y = screenY; y < screenLimitY; y++) {
 			assert(!vdp.isMSX1VDP() || displayY < 192);
 
+			V9958RasterizerLineInfo info;
+			info.stamp = stamp;
+			info.src0 = displayY;
+			info.src1 = 0;
+			info.x = leftBackground + displayX;
+			info.width = displayWidth;
+			if (reuseDisplayLine(y, info)) {
+				displayY = (displayY + 1) & 255;
+				continue;
+			}
+
 			Pixel* dst = workFrame->getLinePtrDirect<Pixel>(y)
 			           + leftBackground + displayX;
 			if (displayX == 0) {
@@ -640,6 +745,14 @@ void SDLRasterizer<Pixel>::drawSprites(
 	int screenX = translateX(
 		vdp.getLeftSprites(),
 		vdp.getDisplayMode().getLineWidth() == 512);
+	// Lines that contain sprites can't be reused in a later frame.
+	auto& spriteChecker = vdp.getSpriteChecker();
+	for (int y = fromY; y < limitY; ++y) {
+		const SpriteChecker::SpriteInfo* visibleSprites;
+		if (spriteChecker.getSprites(y, visibleSprites)) {
+			workFrame->getDisplayInfo(screenY + (y - fromY)).invalidate();
+		}
+	}
 	if (spriteMode == 1) {
 		for (int y = fromY; y < limitY; y++, screenY++) {
 			Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(screenY) + screenX;
@@ -684,6 +797,7 @@ void SDLRasterizer<Pixel>::update(const Setting& setting)
 	    (&setting == &renderSettings.getColorMatrixSetting())) {
 		precalcPalette();
 		resetPalette();
+		invalidateLineCache();
 	}
 }
 
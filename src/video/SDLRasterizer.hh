@@ -7,6 +7,7 @@
 #include "SpriteConverter.hh"
 #include "Observer.hh"
 #include "openmsx.hh"
+#include <cstdint>
 #include <memory>
 
 namespace openmsx {
@@ -20,6 +21,7 @@ class RawFrame;
 class RenderSettings;
 class Setting;
 class PostProcessor;
+struct V9958RasterizerLineInfo;
 
 /** Rasterizer using a frame buffer approach: it writes pixels to a single
   * rectangular pixel buffer.
@@ -51,6 +53,8 @@ public:
 	void setBorderMask(bool masked) override;
 	void setTransparency(bool enabled) override;
 	void setSuperimposeVideoFrame(const RawFrame* videoSource) override;
+	void invalidateLineCache() override;
+	void updateVRAMCache(unsigned address) override;
 	void drawBorder(int fromX, int fromY, int limitX, int limitY) override;
 	void drawDisplay(
 		int fromX, int fromY,
@@ -65,6 +69,20 @@ public:
 private:
 	inline void renderBitmapLine(Pixel* buf, unsigned vramLine);
 
+	/** Can the display pixels of the given line be reused instead of
+	  * converted again? Either because they're still present in workFrame,
+	  * or because they can be copied from the previous frame.
+	  * In both cases the pixels are in place when this returns true.
+	  * Also records 'info' in workFrame, so the caller must (re)convert
+	  * the line when this returns false.
+	  */
+	inline bool reuseDisplayLine(int y, const V9958RasterizerLineInfo& info);
+
+	/** Stamp of the most recent change that influences the given bitmap
+	  * line (in [0..1024), see renderBitmapLine()).
+	  */
+	inline uint64_t getBitmapLineStamp(unsigned vramLine) const;
+
 	/** Reload entire palette from VDP.
 	  */
 	void resetPalette();
@@ -168,6 +186,31 @@ private:
 	// during this frame (meaning the border pixels of this frame cannot
 	// be reused for future frames).
 	bool mixedLeftRightBorders;
+
+	/** The previously finished frame, display lines that didn't change
+	  * can be copied from it. Can be nullptr.
+	  */
+	const RawFrame* prevFrame;
+
+	/** Incremented on each change that influences the display area.
+	  * The stamps below (and in V9958RasterizerLineInfo) hold values of
+	  * this counter, so a changed stamp always compares bigger.
+	  */
+	uint64_t changeCounter;
+
+	/** Most recent change in VDP state that influences all display lines.
+	  */
+	uint64_t stateStamp;
+
+	/** Most recent change in the name, pattern or color table, used for
+	  * character display modes.
+	  */
+	uint64_t charStamp;
+
+	/** Most recent change of each 128-byte block in VRAM, that is one
+	  * line in a non-planar bitmap mode or half a line in a planar mode.
+	  */
+	uint64_t vramLineStamps[1024];
 };
 
 } // namespace openmsx
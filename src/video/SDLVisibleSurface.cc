@@ -91,10 +91,10 @@ std::unique_ptr<OutputSurface> SDLVisibleSurface::createOffScreenSurface()
 	return std::make_unique<SDLOffScreenSurface>(*getSDLSurface());
 }
 
-void SDLVisibleSurface::saveScreenshot(const std::string& filename)
+PNG::Image SDLVisibleSurface::getScreenshot()
 {
 	lock();
-	PNG::save(getSDLSurface(), filename);
+	return PNG::createImage(getSDLSurface());
 }
 
 void SDLVisibleSurface::clearScreen()
@@ -17,7 +17,7 @@ public:
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	PNG::Image getScreenshot() override;
 	void clearScreen() override;
 
 	// VisibleSurface
@@ -0,0 +1,117 @@
+#include "ScreenShotWriter.hh"
+#include "EventDistributor.hh"
+#include "Event.hh"
+#include "CliComm.hh"
+#include "File.hh"
+#include "MSXException.hh"
+#include <cassert>
+
+namespace openmsx {
+
+// Don't let the screenshots that are still being written use an unlimited
+// amount of memory (a 640x480 image is about 1MB). When this many are
+// pending, a new screenshot waits till the oldest one is written.
+static const unsigned MAX_PENDING = 16;
+
+ScreenShotWriter::ScreenShotWriter(
+		CommandController& commandController,
+		EventDistributor& eventDistributor_, CliComm& cliComm_)
+	: eventDistributor(eventDistributor_)
+	, cliComm(cliComm_)
+	, compressionSetting(commandController, "screenshot_compression",
+		"zlib compression level for screenshots: 0 is fastest (not "
+		"compressed), 9 gives the smallest files", 6, 0, 9)
+	, exitThread(false)
+{
+	eventDistributor.registerEventListener(
+		OPENMSX_SCREENSHOT_WRITTEN_EVENT, *this);
+}
+
+ScreenShotWriter::~ScreenShotWriter()
+{
+	if (thread.joinable()) {
+		// finish all pending screenshots
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			exitThread = true;
+		}
+		condition.notify_all();
+		thread.join();
+	}
+	eventDistributor.unregisterEventListener(
+		OPENMSX_SCREENSHOT_WRITTEN_EVENT, *this);
+}
+
+void ScreenShotWriter::write(PNG::Image image, const std::string& filename,
+                             bool async)
+{
+	auto file = std::make_unique<File>(filename, File::TRUNCATE);
+	int level = compressionSetting.getInt();
+	if (!async) {
+		PNG::save(image, *file, level);
+		return;
+	}
+
+	if (!thread.joinable()) {
+		thread = std::thread([this]() { run(); });
+	}
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&] { return jobs.size() < MAX_PENDING; });
+		jobs.push_back(Job{std::move(image), std::move(file), filename, level});
+	}
+	condition.notify_all();
+}
+
+void ScreenShotWriter::run()
+{
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&] { return !jobs.empty() || exitThread; });
+			if (jobs.empty()) break; // exitThread, and all jobs done
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		condition.notify_all(); // there's room for a new job
+
+		Result result;
+		result.filename = job.filename;
+		try {
+			PNG::save(job.image, *job.file, job.compressionLevel);
+		} catch (MSXException& e) {
+			result.error = e.getMessage();
+		}
+		job.file.reset(); // close the file before reporting it's written
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			results.push_back(std::move(result));
+		}
+		eventDistributor.distributeEvent(
+			std::make_shared<SimpleEvent>(OPENMSX_SCREENSHOT_WRITTEN_EVENT));
+	}
+}
+
+int ScreenShotWriter::signalEvent(const std::shared_ptr<const Event>& event)
+{
+	(void)event;
+	assert(event->getType() == OPENMSX_SCREENSHOT_WRITTEN_EVENT);
+
+	std::vector<Result> done;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::swap(done, results);
+	}
+	for (auto& r : done) {
+		if (r.error.empty()) {
+			cliComm.printInfo("Screen saved to ", r.filename);
+		} else {
+			cliComm.printWarning("Failed to write screenshot: ", r.error);
+		}
+	}
+	return 0;
+}
+
+} // namespace openmsx
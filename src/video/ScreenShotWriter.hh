@@ -0,0 +1,76 @@
+#ifndef SCREENSHOTWRITER_HH
+#define SCREENSHOTWRITER_HH
+
+#include "PNG.hh"
+#include "EventListener.hh"
+#include "IntegerSetting.hh"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+class CommandController;
+class EventDistributor;
+class CliComm;
+class File;
+
+/** Writes screenshots (PNG files). Compressing a PNG file takes a lot more
+  * time than taking the screenshot itself, so this can be done on a
+  * background thread, then the emulation doesn't stall when e.g. a script
+  * takes a screenshot every frame.
+  */
+class ScreenShotWriter final : private EventListener
+{
+public:
+	ScreenShotWriter(CommandController& commandController,
+	                 EventDistributor& eventDistributor, CliComm& cliComm);
+	~ScreenShotWriter();
+
+	/** Write the given image to a PNG file.
+	  * With 'async' the file is compressed and written on a background
+	  * thread, the result is reported via CliComm. Otherwise the file is
+	  * written before this method returns.
+	  * In both cases the file itself is already created when this method
+	  * returns (so that the next numbered filename is different).
+	  * @throws MSXException When the file can't be created, or (only when
+	  *         not 'async') when writing it fails.
+	  */
+	void write(PNG::Image image, const std::string& filename, bool async);
+
+private:
+	struct Job {
+		PNG::Image image;
+		std::unique_ptr<File> file;
+		std::string filename;
+		int compressionLevel;
+	};
+	struct Result {
+		std::string filename;
+		std::string error; // empty when successful
+	};
+
+	void run();
+
+	// EventListener
+	int signalEvent(const std::shared_ptr<const Event>& event) override;
+
+	EventDistributor& eventDistributor;
+	CliComm& cliComm;
+	IntegerSetting compressionSetting;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<Job> jobs;         // protected by mutex
+	std::vector<Result> results;  // protected by mutex
+	bool exitThread;              // protected by mutex
+};
+
+} // namespace openmsx
+
+#endif
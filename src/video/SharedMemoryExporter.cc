@@ -0,0 +1,382 @@
+#include "SharedMemoryExporter.hh"
+#include "Reactor.hh"
+#include "MSXMotherBoard.hh"
+#include "CommandException.hh"
+#include "Display.hh"
+#include "PostProcessor.hh"
+#include "FrameSource.hh"
+#include "MSXMixer.hh"
+#include "TclObject.hh"
+#include "MemBuffer.hh"
+#include "outer.hh"
+#include "strCat.hh"
+#include "build-info.hh"
+#include <SDL.h>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+// 8 frames are enough to not have to wait for a reader that is (at most)
+// a few frames behind. The audio slots are a lot smaller, and there are
+// usually several audio blocks per frame.
+static const unsigned NUM_FRAME_SLOTS = 8;
+static const unsigned NUM_AUDIO_SLOTS = 64;
+static const unsigned MAX_AUDIO_SAMPLES = 8192; // see MSXMixer::updateStream()
+
+static unsigned alignSlot(size_t size)
+{
+	return unsigned((size + 63) & ~63); // cache line aligned
+}
+
+SharedMemoryExporter::SharedMemoryExporter(Reactor& reactor_)
+	: reactor(reactor_)
+	, exportCommand(reactor.getCommandController())
+	, mixer(nullptr)
+	, memory(nullptr)
+	, memorySize(0)
+	, frameCount(0)
+	, audioCount(0)
+{
+}
+
+SharedMemoryExporter::~SharedMemoryExporter()
+{
+	stop();
+}
+
+void SharedMemoryExporter::start(const string& name, bool exportVideo,
+                                 bool exportAudio, unsigned height)
+{
+	stop();
+#ifdef _WIN32
+	(void)name; (void)exportVideo; (void)exportAudio; (void)height;
+	throw CommandException(
+		"Shared memory export is not supported on this platform.");
+#else
+	MSXMotherBoard* motherBoard = reactor.getMotherBoard();
+	if (!motherBoard) {
+		throw CommandException("No active MSX machine.");
+	}
+	vector<PostProcessor*> pps;
+	if (exportVideo) {
+		// Like AviRecorder: only the active video source sends frames.
+		for (auto* l : reactor.getDisplay().getAllLayers()) {
+			if (auto* pp = dynamic_cast<PostProcessor*>(l)) {
+				pps.push_back(pp);
+			}
+		}
+		if (pps.empty()) {
+			throw CommandException(
+				"Current renderer doesn't support exporting video.");
+		}
+	}
+
+	unsigned width = height * 4 / 3;
+	unsigned frameSlotSize = exportVideo
+		? alignSlot(sizeof(SlotHeader) + width * height * 4) : 0;
+	unsigned audioSlotSize = exportAudio
+		? alignSlot(sizeof(SlotHeader) + MAX_AUDIO_SAMPLES * 2 * sizeof(int16_t)) : 0;
+	unsigned numFrameSlots = exportVideo ? NUM_FRAME_SLOTS : 0;
+	unsigned numAudioSlots = exportAudio ? NUM_AUDIO_SLOTS : 0;
+	uint64_t frameOffset = alignSlot(sizeof(Header));
+	uint64_t audioOffset = frameOffset + uint64_t(numFrameSlots) * frameSlotSize;
+	size_t size = audioOffset + uint64_t(numAudioSlots) * audioSlotSize;
+
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1) {
+		throw CommandException("Couldn't create shared memory object ",
+		                       name, ": ", strerror(errno));
+	}
+	if (ftruncate(fd, size) == -1) {
+		int err = errno;
+		close(fd);
+		shm_unlink(name.c_str());
+		throw CommandException("Couldn't resize shared memory object ",
+		                       name, ": ", strerror(err));
+	}
+	void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd); // the mapping stays valid
+	if (mem == MAP_FAILED) {
+		int err = errno;
+		shm_unlink(name.c_str());
+		throw CommandException("Couldn't map shared memory object ",
+		                       name, ": ", strerror(err));
+	}
+
+	// ftruncate() already filled everything with zeros
+	auto* header = new (mem) Header();
+	memcpy(header->magic, "oMSXSHM1", 8);
+	header->headerSize      = sizeof(Header);
+	header->slotHeaderSize  = sizeof(SlotHeader);
+	header->frameWidth      = exportVideo ? width  : 0;
+	header->frameHeight     = exportVideo ? height : 0;
+	header->numFrameSlots   = numFrameSlots;
+	header->frameSlotSize   = frameSlotSize;
+	header->frameOffset     = frameOffset;
+	header->numAudioSlots   = numAudioSlots;
+	header->audioSlotSize   = audioSlotSize;
+	header->audioOffset     = audioOffset;
+	header->maxAudioSamples = MAX_AUDIO_SAMPLES;
+	header->emuTimeFreq     = MAIN_FREQ32;
+	header->frameCount.store(0, std::memory_order_relaxed);
+	header->audioCount.store(0, std::memory_order_relaxed);
+	auto* base = static_cast<char*>(mem);
+	for (unsigned i = 0; i < numFrameSlots; ++i) {
+		new (base + frameOffset + i * frameSlotSize) SlotHeader();
+	}
+	for (unsigned i = 0; i < numAudioSlots; ++i) {
+		new (base + audioOffset + i * audioSlotSize) SlotHeader();
+	}
+	header->active.store(1, std::memory_order_release);
+
+	memory = mem;
+	memorySize = size;
+	shmName = name;
+	frameCount = 0;
+	audioCount = 0;
+
+	// only attach when all errors are checked for
+	postProcessors = std::move(pps);
+	for (auto* pp : postProcessors) {
+		pp->setExporter(this);
+	}
+	if (exportAudio) {
+		mixer = &motherBoard->getMSXMixer();
+		mixer->setExporter(this);
+	}
+#endif
+}
+
+void SharedMemoryExporter::stop()
+{
+	for (auto* pp : postProcessors) {
+		pp->setExporter(nullptr);
+	}
+	postProcessors.clear();
+	if (mixer) {
+		mixer->setExporter(nullptr);
+		mixer = nullptr;
+	}
+	if (!memory) return;
+#ifndef _WIN32
+	// Readers that still have the object mapped can keep on using it,
+	// they see that nothing new will be published.
+	getHeader().active.store(0, std::memory_order_release);
+	munmap(memory, memorySize);
+	shm_unlink(shmName.c_str());
+#endif
+	memory = nullptr;
+	memorySize = 0;
+}
+
+SharedMemoryExporter::SlotHeader& SharedMemoryExporter::beginSlot(
+	uint64_t offset, unsigned slotSize, unsigned numSlots, uint64_t count,
+	EmuTime::param time)
+{
+	auto* slotPtr = static_cast<char*>(memory) + offset +
+	                ((count - 1) % numSlots) * slotSize;
+	auto& slot = *reinterpret_cast<SlotHeader*>(slotPtr);
+	slot.sequence.store(2 * count - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.emuTime = (time - EmuTime::zero).length();
+	return slot;
+}
+
+void SharedMemoryExporter::endSlot(
+	SlotHeader& slot, std::atomic<uint64_t>& counter, uint64_t count)
+{
+	slot.sequence.store(2 * count, std::memory_order_release);
+	counter.store(count, std::memory_order_release);
+}
+
+template<typename Pixel>
+static void convertFrame(const FrameSource& frame, unsigned height,
+                         uint8_t* dst)
+{
+	unsigned width = height * 4 / 3;
+	const auto& format = frame.getSDLPixelFormat();
+	MemBuffer<Pixel, SSE2_ALIGNMENT> buf(width);
+	for (unsigned y = 0; y < height; ++y) {
+		const Pixel* line;
+		switch (height) {
+		case 240: line = frame.getLinePtr320_240(y, buf.data()); break;
+		case 480: line = frame.getLinePtr640_480(y, buf.data()); break;
+		default:  line = frame.getLinePtr960_720(y, buf.data()); break;
+		}
+		for (unsigned x = 0; x < width; ++x) {
+			Pixel p = line[x];
+			*dst++ = ((p & format.Rmask) >> format.Rshift) << format.Rloss;
+			*dst++ = ((p & format.Gmask) >> format.Gshift) << format.Gloss;
+			*dst++ = ((p & format.Bmask) >> format.Bshift) << format.Bloss;
+			*dst++ = 255;
+		}
+	}
+}
+
+void SharedMemoryExporter::addImage(FrameSource* frame, EmuTime::param time)
+{
+	assert(memory);
+	auto& header = getHeader();
+	uint64_t count = ++frameCount;
+	auto& slot = beginSlot(header.frameOffset, header.frameSlotSize,
+	                       header.numFrameSlots, count, time);
+	slot.count = 1;
+	slot.sampleRate = 0;
+	auto* dst = reinterpret_cast<uint8_t*>(&slot) + sizeof(SlotHeader);
+#if HAVE_32BPP
+	if (frame->getSDLPixelFormat().BytesPerPixel == 4) {
+		convertFrame<uint32_t>(*frame, header.frameHeight, dst);
+	} else
+#endif
+	{
+#if HAVE_16BPP
+		convertFrame<uint16_t>(*frame, header.frameHeight, dst);
+#endif
+	}
+	endSlot(slot, header.frameCount, count);
+}
+
+void SharedMemoryExporter::addWave(unsigned num, const int16_t* data,
+                                   EmuTime::param time)
+{
+	assert(memory);
+	if (num == 0) return;
+	assert(num <= MAX_AUDIO_SAMPLES);
+	auto& header = getHeader();
+	uint64_t count = ++audioCount;
+	auto& slot = beginSlot(header.audioOffset, header.audioSlotSize,
+	                       header.numAudioSlots, count, time);
+	slot.count = num;
+	slot.sampleRate = mixer->getSampleRate();
+	memcpy(reinterpret_cast<char*>(&slot) + sizeof(SlotHeader),
+	       data, num * 2 * sizeof(int16_t));
+	endSlot(slot, header.audioCount, count);
+}
+
+void SharedMemoryExporter::processStart(array_ref<TclObject> tokens, TclObject& result)
+{
+	bool exportVideo = true;
+	bool exportAudio = true;
+	unsigned height = 240;
+	string name;
+	for (unsigned i = 2; i < tokens.size(); ++i) {
+		string_view token = tokens[i].getString();
+		if (token == "-videoonly") {
+			exportAudio = false;
+		} else if (token == "-audioonly") {
+			exportVideo = false;
+		} else if (token == "-doublesize") {
+			height = 480;
+		} else if (token == "-triplesize") {
+			height = 720;
+		} else if (token.starts_with('-')) {
+			throw CommandException("Invalid option: ", token);
+		} else if (name.empty()) {
+			name = token.str();
+		} else {
+			throw SyntaxError();
+		}
+	}
+	if (!exportVideo && !exportAudio) {
+		throw CommandException("Can't have both -videoonly and -audioonly.");
+	}
+	if (name.empty()) {
+#ifndef _WIN32
+		name = strCat("/openmsx-", int(getpid()));
+#endif
+	} else if (name[0] != '/') {
+		name = '/' + name;
+	}
+	start(name, exportVideo, exportAudio, height);
+	result.setString("Exporting to shared memory object " + name);
+}
+
+void SharedMemoryExporter::status(array_ref<TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	result.addListElement("status");
+	if (!memory) {
+		result.addListElement("idle");
+		return;
+	}
+	result.addListElement("exporting");
+	result.addListElement("name");
+	result.addListElement(shmName);
+	result.addListElement("frames");
+	result.addListElement(double(frameCount));
+	result.addListElement("audio_blocks");
+	result.addListElement(double(audioCount));
+}
+
+// class SharedMemoryExporter::Cmd
+
+SharedMemoryExporter::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "shm_export")
+{
+}
+
+void SharedMemoryExporter::Cmd::execute(array_ref<TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 2) {
+		throw CommandException("Missing argument");
+	}
+	auto& exporter = OUTER(SharedMemoryExporter, exportCommand);
+	const string_view subcommand = tokens[1].getString();
+	if (subcommand == "start") {
+		exporter.processStart(tokens, result);
+	} else if (subcommand == "stop") {
+		if (tokens.size() != 2) throw SyntaxError();
+		exporter.stop();
+	} else if (subcommand == "status") {
+		exporter.status(tokens, result);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string SharedMemoryExporter::Cmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Publishes the openMSX video frames and audio in a POSIX shared "
+	       "memory object, for use by external programs.\n"
+	       "shm_export start          Export to '/openmsx-<pid>'\n"
+	       "shm_export start <name>   Export to the given shared memory object\n"
+	       "shm_export stop           Stop exporting (and remove the object)\n"
+	       "shm_export status         Query export state\n"
+	       "\n"
+	       "The start subcommand also accepts an optional -videoonly, "
+	       "-audioonly, -doublesize or -triplesize flag. Frames are exported "
+	       "as 320x240 RGBA pixels by default, 640x480 with -doublesize and "
+	       "960x720 with -triplesize. Audio is exported as 16-bit stereo "
+	       "samples. See SharedMemoryExporter.hh for the layout of the "
+	       "shared memory object.";
+}
+
+void SharedMemoryExporter::Cmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = {
+			"start", "stop", "status",
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens.size() >= 3) && (tokens[1] == "start")) {
+		static const char* const options[] = {
+			"-videoonly", "-audioonly", "-doublesize", "-triplesize",
+		};
+		completeString(tokens, options);
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,112 @@
+#ifndef SHAREDMEMORYEXPORTER_HH
+#define SHAREDMEMORYEXPORTER_HH
+
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "array_ref.hh"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Reactor;
+class PostProcessor;
+class FrameSource;
+class MSXMixer;
+class TclObject;
+
+/** Publishes the finished video frames and the generated audio in a POSIX
+  * shared memory object, so that external programs (stream encoders, test
+  * tools, ...) can read them without the overhead of screenshots or video
+  * recording. openMSX never waits for the readers: both the frames and the
+  * audio blocks are written in a ring of slots, a reader that is too slow
+  * simply misses some of them (it can detect this via the sequence
+  * numbers).
+  *
+  * Layout of the shared memory object (all in host byte order):
+  *   Header, then 'numFrameSlots' slots of 'frameSlotSize' bytes at
+  *   'frameOffset' and 'numAudioSlots' slots of 'audioSlotSize' bytes at
+  *   'audioOffset'. Each slot starts with a SlotHeader followed by the data:
+  *   - video: frameWidth x frameHeight pixels, 4 bytes per pixel in the byte
+  *     order R, G, B, A (A is always 255).
+  *   - audio: 'count' stereo samples, signed 16-bit, left first.
+  *
+  * To read the most recent frame: n = frameCount, slot = (n - 1) %
+  * numFrameSlots, check that slot.sequence == 2 * n, read the data, then
+  * check slot.sequence again (it's odd while the slot is being written). The
+  * same goes for audio, the audio blocks are consecutive, so a reader that
+  * wants all audio should read the slots in order.
+  */
+class SharedMemoryExporter
+{
+public:
+	struct Header {
+		char magic[8];                    // "oMSXSHM1"
+		uint32_t headerSize;              // sizeof(Header)
+		uint32_t slotHeaderSize;          // sizeof(SlotHeader)
+		uint32_t frameWidth;              // 0 when not exporting video
+		uint32_t frameHeight;
+		uint32_t numFrameSlots;
+		uint32_t frameSlotSize;           // including the SlotHeader
+		uint64_t frameOffset;
+		uint32_t numAudioSlots;           // 0 when not exporting audio
+		uint32_t audioSlotSize;           // including the SlotHeader
+		uint64_t audioOffset;
+		uint32_t maxAudioSamples;         // per slot
+		uint32_t emuTimeFreq;             // emuTime ticks per second
+		std::atomic<uint64_t> frameCount; // number of published frames
+		std::atomic<uint64_t> audioCount; // number of published audio blocks
+		std::atomic<uint32_t> active;     // set to 0 when the export stops
+	};
+	struct SlotHeader {
+		std::atomic<uint64_t> sequence; // 2 * n for the n-th published
+		                                // item (1-based), odd while writing
+		uint64_t emuTime;    // time of the frame/the end of the audio block
+		uint32_t count;      // audio: number of samples, video: 1
+		uint32_t sampleRate; // audio only
+	};
+
+	explicit SharedMemoryExporter(Reactor& reactor);
+	~SharedMemoryExporter();
+
+	// Called by PostProcessor and MSXMixer
+	void addImage(FrameSource* frame, EmuTime::param time);
+	void addWave(unsigned num, const int16_t* data, EmuTime::param time);
+	void stop();
+
+private:
+	void start(const std::string& name, bool exportVideo, bool exportAudio,
+	           unsigned height);
+	SlotHeader& beginSlot(uint64_t offset, unsigned slotSize,
+	                      unsigned numSlots, uint64_t count,
+	                      EmuTime::param time);
+	void endSlot(SlotHeader& slot, std::atomic<uint64_t>& counter,
+	             uint64_t count);
+	Header& getHeader() const { return *static_cast<Header*>(memory); }
+
+	void processStart(array_ref<TclObject> tokens, TclObject& result);
+	void status(array_ref<TclObject> tokens, TclObject& result) const;
+
+	Reactor& reactor;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(array_ref<TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} exportCommand;
+
+	std::vector<PostProcessor*> postProcessors;
+	MSXMixer* mixer;
+	std::string shmName;
+	void* memory; // nullptr when not exporting
+	size_t memorySize;
+	uint64_t frameCount;
+	uint64_t audioCount;
+};
+
+} // namespace openmsx
+
+#endif
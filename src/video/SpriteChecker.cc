@@ -33,7 +33,7 @@ void SpriteChecker::reset(EmuTime::param time)
 	collisionX = 0;
 	collisionY = 0;
 
-	frameStart(time);
+	frameStart(time, true);
 
 	updateSpritesMethod = &SpriteChecker::updateSprites1;
 }
@@ -51,6 +51,42 @@ static inline SpriteChecker::SpritePattern doublePattern(SpriteChecker::SpritePa
 	return a | (a >> 1);             // aabbccddeeffgghhiijjkkllmmnnoopp
 }
 
+int SpriteChecker::findCollision(const SpriteInfo* sprites, int count,
+                                 bool mode2)
+{
+	// Instead of checking every pair of sprites, draw all sprites in a
+	// 1-bit-per-pixel line buffer and keep track of the pixels that were
+	// already set. This buffer covers the range [-32, 288), so word 0
+	// holds the (left border) pixels that can't collide, words 1-8 the
+	// in-screen pixels. Word 9 only catches overflow from word 8.
+	uint32_t covered [10] = {};
+	uint32_t collided[10] = {};
+	for (int i = 0; i < count; ++i) {
+		// In sprite mode 2, if CC or IC is set, this sprite cannot
+		// collide.
+		if (mode2 && (sprites[i].colorAttrib & 0x60)) continue;
+		SpritePattern pattern = sprites[i].pattern;
+		assert(sprites[i].x >= -32);
+		unsigned pos = sprites[i].x + 32;
+		unsigned w = pos / 32;
+		unsigned s = pos % 32;
+		uint32_t left = pattern >> s;
+		collided[w] |= covered[w] & left;
+		covered [w] |= left;
+		if (s) {
+			uint32_t right = pattern << (32 - s);
+			collided[w + 1] |= covered[w + 1] & right;
+			covered [w + 1] |= right;
+		}
+	}
+	for (int w = 1; w < 9; ++w) {
+		if (collided[w]) {
+			return (w - 1) * 32 + Math::countLeadingZeros(collided[w]);
+		}
+	}
+	return -1; // no collision
+}
+
 inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternNP(
 	unsigned patternNr, unsigned y)
 {
@@ -119,7 +155,12 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
 
 	// Get sprites for this line and detect 5th sprite if any.
-	bool limitSprites = limitSpritesSetting.getBoolean();
+	// In a frame that is not drawn, the sprites beyond the 5th are never
+	// needed. The first 4 are only needed for the collision check, and
+	// once collision occurred that state is stable (see below), so then
+	// it's enough to only count the sprites (for the 5th sprite status).
+	bool limitSprites = limitSpritesSetting.getBoolean() || !renderSprites;
+	bool countOnly = !renderSprites && (vdp.getStatusReg0() & 0x20);
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
 	int magSize = (mag + 1) * size;
@@ -153,6 +194,11 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 				if (limitSprites) continue;
 			}
 
+			if (countOnly) {
+				spriteCount[line] = visibleIndex + 1;
+				continue;
+			}
+
 			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
 			int patternIndex = attributePtr[4 * sprite + 2] & patternIndexMask;
 			if (mag) spriteLine /= 2;
@@ -200,41 +246,14 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow,
-	but there are max 4 sprites and therefore max 6 pairs.
+	Implemented in findCollision(), which merges the (max 4) sprites
+	in a line bitmap instead of checking every pair.
 	If any collision is found, method returns at once.
 	*/
 	for (int line = minLine; line < maxLine; ++line) {
-		int minXCollision = 999;
-		for (int i = std::min<int>(4, spriteCount[line]); --i >= 1; /**/) {
-			int x_i = spriteBuffer[line][i].x;
-			SpritePattern pattern_i = spriteBuffer[line][i].pattern;
-			for (int j = i; --j >= 0; ) {
-				// Do sprite i and sprite j collide?
-				int x_j = spriteBuffer[line][j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = spriteBuffer[line][j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + Math::countLeadingZeros(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
+		int minXCollision = findCollision(
+			spriteBuffer[line], std::min<int>(4, spriteCount[line]), false);
+		if (minXCollision >= 0) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// verified: collision coords are also filled
 			//           in for sprite mode 1
@@ -275,7 +294,9 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
 
 	// Get sprites for this line and detect 5th sprite if any.
-	bool limitSprites = limitSpritesSetting.getBoolean();
+	// See checkSprites1() about frames that are not drawn.
+	bool limitSprites = limitSpritesSetting.getBoolean() || !renderSprites;
+	bool countOnly = !renderSprites && (vdp.getStatusReg0() & 0x20);
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
 	int magSize = (mag + 1) * size;
@@ -315,6 +336,10 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 					}
 					if (limitSprites) continue;
 				}
+				if (countOnly) {
+					spriteCount[line] = visibleIndex + 1;
+					continue;
+				}
 
 				if (mag) spriteLine /= 2;
 				int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
@@ -360,6 +385,10 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 					}
 					if (limitSprites) continue;
 				}
+				if (countOnly) {
+					spriteCount[line] = visibleIndex + 1;
+					continue;
+				}
 
 				if (mag) spriteLine /= 2;
 				int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
@@ -428,49 +457,13 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow.
-	There are max 8 sprites and therefore max 42 pairs.
-	  TODO: Maybe this is slow... Think of something faster.
-	        Probably new approach is needed anyway for OR-ing.
+	Implemented in findCollision(), which merges the (max 8) sprites
+	in a line bitmap instead of checking every pair (max 28 pairs).
 	*/
 	for (int line = minLine; line < maxLine; ++line) {
-		int minXCollision = 999; // no collision
-		SpriteInfo* visibleSprites = spriteBuffer[line];
-		for (int i = std::min<int>(8, spriteCount[line]); --i >= 1; /**/) {
-			// If CC or IC is set, this sprite cannot collide.
-			if (visibleSprites[i].colorAttrib & 0x60) continue;
-
-			int x_i = visibleSprites[i].x;
-			SpritePattern pattern_i = visibleSprites[i].pattern;
-			for (int j = i; --j >= 0; ) {
-				// If CC or IC is set, this sprite cannot collide.
-				if (visibleSprites[j].colorAttrib & 0x60) continue;
-
-				// Do sprite i and sprite j collide?
-				int x_j = visibleSprites[j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = visibleSprites[j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + Math::countLeadingZeros(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
+		int minXCollision = findCollision(
+			spriteBuffer[line], std::min<int>(8, spriteCount[line]), true);
+		if (minXCollision >= 0) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// x-coord should be increased by 12
 			// y-coord                         8
@@ -500,6 +493,7 @@ void SpriteChecker::serialize(Archive& ar, unsigned version)
 		// first (partial) frame after loadstate.
 		for (auto& c : spriteCount) c = 0;
 		// content of spriteBuffer[] doesn't matter if spriteCount[] is 0
+		renderSprites = true;
 	}
 	ar.serialize("collisionX", collisionX);
 	ar.serialize("collisionY", collisionY);
@@ -41,6 +41,18 @@ public:
 		byte colorAttrib;
 	};
 
+	/** Find the left-most pixel where two of the given sprites overlap.
+	  * Sprites can only collide on the in-screen pixels, see the model
+	  * described in checkSprites1().
+	  * @param sprites The sprites on one line.
+	  * @param count The number of sprites that should be checked.
+	  * @param mode2 In sprite mode 2, sprites with CC or IC set can't
+	  *              collide.
+	  * @return The x-coordinate of the collision, or -1 if there is none.
+	  */
+	static int findCollision(const SpriteInfo* sprites, int count,
+	                         bool mode2);
+
 	/** Create a sprite checker.
 	  * @param vdp The VDP this sprite checker is part of.
 	  * @param renderSettings TODO
@@ -194,9 +206,13 @@ public:
 
 	/** Signals the start of a new frame.
 	  * @param time Moment in emulated time the new frame starts.
+	  * @param render Will the sprites of this frame be drawn? When not,
+	  *   only the status register and collision coordinates are
+	  *   calculated (exactly), getSprites() must not be called.
 	  */
-	inline void frameStart(EmuTime::param time) {
+	inline void frameStart(EmuTime::param time, bool render) {
 		frameStartTime.reset(time);
+		renderSprites = render;
 		currentLine = 0;
 		for (auto& c : spriteCount) c = 0;
 		// TODO: Reset anything else? Does the real VDP?
@@ -364,6 +380,12 @@ private:
 	  */
 	uint8_t spriteCount[313];
 
+	/** Are the sprites of the current frame drawn? When not, spriteBuffer
+	  * only contains the sprites that are needed for the collision check,
+	  * see checkSprites1().
+	  */
+	bool renderSprites;
+
 	/** Is current display mode planar or not?
 	  * TODO: Introduce separate update methods for planar/nonplanar modes.
 	  */
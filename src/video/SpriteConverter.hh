@@ -8,8 +8,13 @@ TODO:
 
 #include "SpriteChecker.hh"
 #include "DisplayMode.hh"
+#include "Math.hh"
+#include "endian.hh"
 #include "likely.hh"
 #include "openmsx.hh"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace openmsx {
 
@@ -100,6 +105,49 @@ public:
 		// Lines without any sprites are very common in most programs.
 		if (visibleIndex == 0) return;
 
+		drawMode1(visibleSprites, visibleIndex, minX, maxX,
+		          palette, pixelPtr);
+	}
+
+	/** Draw one line of sprites in sprite mode 1.
+	  * Same as above, but the sprites and palette are passed explicitly
+	  * (this is also what makes it possible to test this in isolation).
+	  * @param visibleSprites The sprites on this line, see
+	  *     SpriteChecker::getSprites().
+	  * @param visibleIndex The number of sprites on this line.
+	  * @param minX Minimum X coordinate to draw (inclusive).
+	  * @param maxX Maximum X coordinate to draw (exclusive).
+	  * @param palette 16-entry sprite palette.
+	  * @param pixelPtr Pointer to memory to draw to.
+	  */
+	static void drawMode1(
+		const SpriteChecker::SpriteInfo* visibleSprites,
+		int visibleIndex, int minX, int maxX,
+		const Pixel* palette, Pixel* __restrict pixelPtr)
+	{
+#ifdef __SSE2__
+		// Merge all sprites in a line buffer with one color index per
+		// pixel, 32 pixels at a time. Bit 7 marks a sprite pixel.
+		alignas(16) byte buf[256 + 32];
+		clearLine(buf);
+		while (visibleIndex--) {
+			const SpriteChecker::SpriteInfo& info =
+				visibleSprites[visibleIndex];
+			byte colIndex = info.colorAttrib & 0x0F;
+			// Don't draw transparent sprites in sprite mode 1.
+			if (colIndex == 0) continue;
+			SpriteChecker::SpritePattern pattern = info.pattern;
+			int x = info.x;
+			if (!clipPattern(x, pattern, minX, maxX)) continue;
+			__m128i maskL, maskR;
+			expandPattern(pattern, maskL, maskR);
+			__m128i col = _mm_set1_epi8(char(colIndex | 0x80));
+			blend(&buf[x +  0], maskL, col);
+			blend(&buf[x + 16], maskR, col);
+		}
+		convertLine<DisplayMode::GRAPHIC4>(
+			buf, minX, maxX, palette, pixelPtr);
+#else
 		// Render using overdraw.
 		while (visibleIndex--) {
 			// Get sprite info.
@@ -127,6 +175,7 @@ public:
 				p++;
 			}
 		}
+#endif
 	}
 
 	/** Draw sprites in sprite mode 2.
@@ -151,6 +200,23 @@ public:
 		// Lines without any sprites are very common in most programs.
 		if (visibleIndex == 0) return;
 
+		drawMode2<MODE>(visibleSprites, visibleIndex, minX, maxX,
+		                transparency, palette, pixelPtr);
+	}
+
+	/** Draw one line of sprites in sprite mode 2.
+	  * Same as above, but the sprites, transparency and palette are passed
+	  * explicitly. See drawMode1() for the other parameters.
+	  * @param visibleSprites The sprites on this line, followed by a
+	  *     sentinel with CC=0, see SpriteChecker::getSprites().
+	  * @param transparency VDP transparency setting (R#8, bit5).
+	  */
+	template <unsigned MODE>
+	static void drawMode2(
+		const SpriteChecker::SpriteInfo* visibleSprites,
+		int visibleIndex, int minX, int maxX, bool transparency,
+		const Pixel* palette, Pixel* __restrict pixelPtr)
+	{
 		// Sprites with CC=1 are only visible if preceded by a sprite
 		// with CC=0. Therefor search for first sprite with CC=0.
 		int first = 0;
@@ -160,6 +226,48 @@ public:
 			}
 			++first;
 		} while (first < visibleIndex);
+#ifdef __SSE2__
+		// Same approach as in drawMode1(), but now also OR in the
+		// colors of the following CC=1 sprites, for all 32 pixels of
+		// a sprite at once.
+		alignas(16) byte buf[256 + 32];
+		clearLine(buf);
+		for (int i = visibleIndex - 1; i >= first; --i) {
+			const SpriteChecker::SpriteInfo& info = visibleSprites[i];
+			int x = info.x;
+			SpriteChecker::SpritePattern pattern = info.pattern;
+			// Clip sprite pattern to render range.
+			if (!clipPattern(x, pattern, minX, maxX)) continue;
+			byte c = info.colorAttrib & 0x0F;
+			if (c == 0 && transparency) continue;
+			__m128i maskL, maskR;
+			expandPattern(pattern, maskL, maskR);
+			__m128i colL = _mm_set1_epi8(char(c | 0x80));
+			__m128i colR = colL;
+			// Merge in any following CC=1 sprites.
+			for (int j = i + 1; /*sentinel*/; ++j) {
+				const SpriteChecker::SpriteInfo& info2 =
+					visibleSprites[j];
+				if (!(info2.colorAttrib & 0x40)) break;
+				// Align the pattern of this sprite with the
+				// (clipped) position of sprite 'i'.
+				int shift2 = x - info2.x;
+				if ((shift2 <= -32) || (32 <= shift2)) continue;
+				SpriteChecker::SpritePattern pattern2 = (shift2 >= 0)
+					? (info2.pattern <<  shift2)
+					: (info2.pattern >> -shift2);
+				if (!pattern2) continue;
+				__m128i mask2L, mask2R;
+				expandPattern(pattern2, mask2L, mask2R);
+				__m128i col2 = _mm_set1_epi8(char(info2.colorAttrib & 0x0F));
+				colL = _mm_or_si128(colL, _mm_and_si128(mask2L, col2));
+				colR = _mm_or_si128(colR, _mm_and_si128(mask2R, col2));
+			}
+			blend(&buf[x +  0], maskL, colL);
+			blend(&buf[x + 16], maskR, colR);
+		}
+		convertLine<MODE>(buf, minX, maxX, palette, pixelPtr);
+#else
 		for (int i = visibleIndex - 1; i >= first; --i) {
 			const SpriteChecker::SpriteInfo& info = visibleSprites[i];
 			int x = info.x;
@@ -182,28 +290,97 @@ public:
 							color |= info2.colorAttrib & 0x0F;
 						}
 					}
-					if (MODE == DisplayMode::GRAPHIC5) {
-						Pixel pixL = palette[color >> 2];
-						Pixel pixR = palette[color & 3];
-						pixelPtr[x * 2 + 0] = pixL;
-						pixelPtr[x * 2 + 1] = pixR;
-					} else {
-						Pixel pix = palette[color];
-						if (MODE == DisplayMode::GRAPHIC6) {
-							pixelPtr[x * 2 + 0] = pix;
-							pixelPtr[x * 2 + 1] = pix;
-						} else {
-							pixelPtr[x] = pix;
-						}
-					}
+					drawPixel<MODE>(x, color, palette, pixelPtr);
 				}
 				++x;
 				pattern <<= 1;
 			}
 		}
+#endif
 	}
 
 private:
+	template <unsigned MODE>
+	static inline void drawPixel(int x, byte color, const Pixel* palette,
+	                             Pixel* __restrict pixelPtr)
+	{
+		if (MODE == DisplayMode::GRAPHIC5) {
+			Pixel pixL = palette[color >> 2];
+			Pixel pixR = palette[color & 3];
+			pixelPtr[x * 2 + 0] = pixL;
+			pixelPtr[x * 2 + 1] = pixR;
+		} else {
+			Pixel pix = palette[color];
+			if (MODE == DisplayMode::GRAPHIC6) {
+				pixelPtr[x * 2 + 0] = pix;
+				pixelPtr[x * 2 + 1] = pix;
+			} else {
+				pixelPtr[x] = pix;
+			}
+		}
+	}
+
+#ifdef __SSE2__
+	static inline void clearLine(byte* buf)
+	{
+		__m128i zero = _mm_setzero_si128();
+		for (int i = 0; i < (256 + 32); i += 16) {
+			_mm_store_si128(reinterpret_cast<__m128i*>(&buf[i]), zero);
+		}
+	}
+
+	/** Expand a 32-pixel sprite pattern to one byte per pixel: 0xFF for
+	  * a sprite dot, 0x00 otherwise. The left-most pixel (bit 31) ends
+	  * up in the lowest byte of 'left'.
+	  */
+	static inline void expandPattern(SpriteChecker::SpritePattern pattern,
+	                                 __m128i& left, __m128i& right)
+	{
+		const __m128i bits = _mm_set_epi8(
+			1, 2, 4, 8, 16, 32, 64, char(128),
+			1, 2, 4, 8, 16, 32, 64, char(128));
+		// Bytes (from low to high): b31-24, b23-16, b15-8, b7-0
+		__m128i p = _mm_cvtsi32_si128(int(Endian::bswap32(pattern)));
+		p = _mm_unpacklo_epi8 (p, p); // each byte 2x
+		p = _mm_unpacklo_epi16(p, p); // each byte 4x
+		__m128i l = _mm_unpacklo_epi32(p, p); // each byte 8x
+		__m128i r = _mm_unpackhi_epi32(p, p);
+		left  = _mm_cmpeq_epi8(_mm_and_si128(l, bits), bits);
+		right = _mm_cmpeq_epi8(_mm_and_si128(r, bits), bits);
+	}
+
+	/** Overwrite the bytes in 'p' with 'color' where 'mask' is set.
+	  */
+	static inline void blend(byte* p, __m128i mask, __m128i color)
+	{
+		__m128i* q = reinterpret_cast<__m128i*>(p);
+		__m128i old = _mm_loadu_si128(q);
+		_mm_storeu_si128(q, _mm_or_si128(_mm_and_si128   (mask, color),
+		                                 _mm_andnot_si128(mask, old)));
+	}
+
+	/** Convert the line buffer to host pixels. Only the pixels that are
+	  * marked (bit 7) are drawn, others keep their current value. Blocks
+	  * of 16 pixels without any sprite dot are skipped at once.
+	  */
+	template <unsigned MODE>
+	static inline void convertLine(const byte* buf, int minX, int maxX,
+	                               const Pixel* palette,
+	                               Pixel* __restrict pixelPtr)
+	{
+		for (int x = minX; x < maxX; x += 16) {
+			unsigned dots = _mm_movemask_epi8(_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(&buf[x])));
+			if (maxX - x < 16) dots &= (1 << (maxX - x)) - 1;
+			while (dots) {
+				int i = x + Math::findFirstSet(dots) - 1;
+				drawPixel<MODE>(i, buf[i] & 0x0F, palette, pixelPtr);
+				dots &= dots - 1;
+			}
+		}
+	}
+#endif
+
 	SpriteChecker& spriteChecker;
 
 	/** The current sprite palette.
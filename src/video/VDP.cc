@@ -593,7 +593,7 @@ void VDP::frameStart(EmuTime::param time)
 	// Inform VDP subcomponents.
 	// TODO: Do this via VDPVRAM?
 	renderer->frameStart(time);
-	spriteChecker->frameStart(time);
+	spriteChecker->frameStart(time, renderer->isFrameRendered());
 
 	/*
 	   cout << "--> frameStart = " << frameStartTime
@@ -1122,7 +1122,7 @@ void VDP::changeRegister(byte reg, byte val, EmuTime::param time)
 		if ((change & 0x80) && isVDPwithVRAMremapping()) {
 			// confirmed: VRAM remapping only happens on TMS99xx
 			// see VDPVRAM for details on the remapping itself
-			vram->change4k8kMapping((val & 0x80) != 0);
+			vram->change4k8kMapping((val & 0x80) != 0, time);
 		}
 		break;
 	case 2:
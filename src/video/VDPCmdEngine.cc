@@ -41,6 +41,7 @@ TODO:
 #include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <type_traits>
 
 using std::min;
 using std::max;
@@ -1311,6 +1312,28 @@ void VDPCmdEngine::executeLmmc(EmuTime::param limit)
 	nextAccessSlot(limit); // inaccurate, but avoid assert
 }
 
+template<typename Mode>
+inline bool VDPCmdEngine::canWriteBulk() const
+{
+	// The renderer is the only observer that would see the intermediate
+	// states (the sprite checker is handled per address in VDPVRAM, the
+	// status register only depends on the access slot timing, which is
+	// still calculated byte per byte). In non-bitmap modes the renderer
+	// also needs to know which table each written address belongs to.
+	return !std::is_same<Mode, NonBitmapMode>::value &&
+	       !vram.needsCmdWriteTiming();
+}
+
+inline void VDPCmdEngine::cmdWrite(
+	bool bulk, unsigned address, byte value, EmuTime::param time)
+{
+	if (bulk) {
+		vram.cmdWriteBulk(address, value, time);
+	} else {
+		vram.cmdWrite(address, value, time);
+	}
+}
+
 /** High-speed move VDP -> VRAM.
   */
 template<typename Mode>
@@ -1340,12 +1363,14 @@ void VDPCmdEngine::executeHmmv(EmuTime::param limit)
 		ADX, ANX << Mode::PIXELS_PER_BYTE_SHIFT, ARG );
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset = !dstExt || hasExtendedVRAM;
+	bool bulk = canWriteBulk<Mode>();
+	if (bulk) vram.startCmdBulk();
 	auto calculator = getSlotCalculator(limit);
 
 	while (!calculator.limitReached()) {
 		if (likely(doPset)) {
-			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
-			              COL, calculator.getTime());
+			cmdWrite(bulk, Mode::addressOf(ADX, DY, dstExt),
+			         COL, calculator.getTime());
 		}
 		ADX += TX;
 		Delta delta = DELTA_48;
@@ -1448,6 +1473,8 @@ void VDPCmdEngine::executeHmmm(EmuTime::param limit)
 	bool dstExt  = (ARG & MXD) != 0;
 	bool doPoint = !srcExt || hasExtendedVRAM;
 	bool doPset  = !dstExt || hasExtendedVRAM;
+	bool bulk = canWriteBulk<Mode>();
+	if (bulk) vram.startCmdBulk();
 	auto calculator = getSlotCalculator(limit);
 
 	switch (phase) {
@@ -1462,8 +1489,8 @@ loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
 	case 1: {
 		if (unlikely(calculator.limitReached())) { phase = 1; break; }
 		if (likely(doPset)) {
-			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
-			              tmpSrc, calculator.getTime());
+			cmdWrite(bulk, Mode::addressOf(ADX, DY, dstExt),
+			         tmpSrc, calculator.getTime());
 		}
 		ASX += TX; ADX += TX;
 		Delta delta = DELTA_64;
@@ -1582,6 +1609,8 @@ void VDPCmdEngine::executeYmmm(EmuTime::param limit)
 	//  OTOH YMMM also uses DX for both read and write
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset  = !dstExt || hasExtendedVRAM;
+	bool bulk = canWriteBulk<Mode>();
+	if (bulk) vram.startCmdBulk();
 	auto calculator = getSlotCalculator(limit);
 
 	switch (phase) {
@@ -1596,8 +1625,8 @@ loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
 	case 1:
 		if (unlikely(calculator.limitReached())) { phase = 1; break; }
 		if (likely(doPset)) {
-			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
-			              tmpSrc, calculator.getTime());
+			cmdWrite(bulk, Mode::addressOf(ADX, DY, dstExt),
+			         tmpSrc, calculator.getTime());
 		}
 		ADX += TX;
 		if (--ANX == 0) {
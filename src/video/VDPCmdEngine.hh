@@ -166,6 +166,14 @@ private:
 		return vdp.getAccessSlotCalculator(engineTime, limit);
 	}
 
+	/** Can the VRAM writes of the high-speed commands be executed in
+	  * bulk (see VDPVRAM::cmdWriteBulk())? This is the case when nobody
+	  * can observe the exact moment a byte gets written.
+	  */
+	template<typename Mode> inline bool canWriteBulk() const;
+	inline void cmdWrite(bool bulk, unsigned address, byte value,
+	                     EmuTime::param time);
+
 	/** Finshed executing graphical operation.
 	  */
 	void commandDone(EmuTime::param time);
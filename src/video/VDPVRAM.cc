@@ -130,6 +130,7 @@ VDPVRAM::VDPVRAM(VDP& vdp_, unsigned size, EmuTime::param time)
 
 	vrMode = vdp.getVRMode();
 	setSizeMask(time);
+	startCmdBulk();
 
 	// Whole VRAM is cachable.
 	// Because this window has no observer, any EmuTime can be passed.
@@ -150,6 +151,11 @@ void VDPVRAM::clear()
 	}
 }
 
+bool VDPVRAM::needsCmdWriteTiming() const
+{
+	return renderer->needsVRAMTiming();
+}
+
 void VDPVRAM::updateDisplayMode(DisplayMode mode, bool cmdBit, EmuTime::param time)
 {
 	assert(vdp.isInsideFrame(time));
@@ -238,7 +244,7 @@ void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime::param time)
 	bitmapVisibleWindow.setObserver(renderer);
 }
 
-void VDPVRAM::change4k8kMapping(bool mapping8k)
+void VDPVRAM::change4k8kMapping(bool mapping8k, EmuTime::param time)
 {
 	/* Sources:
 	 *  - http://www.msx.org/forumtopicl8624.html
@@ -282,6 +288,8 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 	 * even in 4K mode, all 16K of VRAM can be accessed. The only
 	 * difference is in what addresses are used to store data.
 	 */
+	renderer->updateWindow(true, time);
+
 	byte tmp[0x4000];
 	if (mapping8k) {
 		// from 8k/16k to 4k mapping
@@ -428,6 +428,65 @@ public:
 		writeCommon(address, value, time);
 	}
 
+	/** Does the renderer need to see command engine writes at their
+	  * exact moment in time? See Renderer::needsVRAMTiming().
+	  */
+	bool needsCmdWriteTiming() const;
+
+	/** Is there a subsystem that must be informed of a change of this
+	  * address at the exact moment in time it happens? Currently those
+	  * are the sprite tables, observed by the SpriteChecker.
+	  */
+	inline bool hasTimedObserver(unsigned address) const {
+		address &= sizeMask;
+		return spriteAttribTable .isInside(address) ||
+		       spritePatternTable.isInside(address);
+	}
+
+	/** Must be called before a series of cmdWriteBulk() calls.
+	  */
+	inline void startCmdBulk() {
+		bulkBlock[0] = bulkBlock[1] = unsigned(-1);
+	}
+
+	/** Write a byte from the command engine as part of a bulk operation.
+	  * Only allowed when needsCmdWriteTiming() returns false. Then it
+	  * doesn't matter at which moment a write is reported to the renderer,
+	  * so the renderer is only informed once per (consecutively written)
+	  * block of 128 bytes. There are two such blocks, one for the even and
+	  * one for the odd 64kB bank, so that the interleaved layout of
+	  * Graphic 6 and 7 also benefits.
+	  * Writes to an address with a timed observer are still reported
+	  * individually, see hasTimedObserver().
+	  */
+	inline void cmdWriteBulk(unsigned address, byte value, EmuTime::param time) {
+		assert(vdp.isInsideFrame(time));
+
+		// handle mirroring and non-present ram chips
+		address &= sizeMask;
+		if (unlikely(address >= actualSize)) {
+			assert(address < 0x30000);
+			return;
+		}
+		if (unlikely(hasTimedObserver(address))) {
+			writeCommon(address, value, time);
+			return;
+		}
+		if (data[address] == value) return;
+
+		#ifdef DEBUG
+		assert(time >= vramTime);
+		vramTime = time;
+		#endif
+
+		unsigned& block = bulkBlock[(address >> 16) & 1];
+		if (block != (address >> 7)) {
+			block = address >> 7;
+			bitmapVisibleWindow.notify(address, time);
+		}
+		data[address] = value;
+	}
+
 	/** Write a byte to VRAM through the CPU interface.
 	  * @param address The address to write.
 	  * @param value The value to write.
@@ -541,7 +600,7 @@ public:
 	/** TMS99x8 VRAM can be mapped in two ways.
 	  * See implementation for more details.
 	  */
-	void change4k8kMapping(bool mapping8k);
+	void change4k8kMapping(bool mapping8k, EmuTime::param time);
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -660,6 +719,11 @@ private:
 	  */
 	bool vrMode;
 
+	/** Last 128-byte block (per 64kB bank) that was reported to the
+	  * renderer during the current bulk operation, see cmdWriteBulk().
+	  */
+	unsigned bulkBlock[2];
+
 public:
 	VRAMWindow cmdReadWindow;
 	VRAMWindow cmdWriteWindow;
@@ -5,6 +5,7 @@
 #include "Layer.hh"
 #include "Observer.hh"
 #include "MSXEventListener.hh"
+#include "PNG.hh"
 #include <string>
 
 namespace openmsx {
@@ -30,9 +31,8 @@ public:
 
 	/** Create a raw (=non-postprocessed) screenshot. The 'height'
 	 * parameter should be either '240' or '480'. The current image will be
-	 * scaled to '320x240' or '640x480' and written to a png file. */
-	virtual void takeRawScreenShot(
-		unsigned height, const std::string& filename) = 0;
+	 * scaled to '320x240' or '640x480'. */
+	virtual PNG::Image takeRawScreenShot(unsigned height) = 0;
 
 	// We used to test whether a Layer is active by looking at the
 	// Z-coordinate (Z_MSX_ACTIVE vs Z_MSX_PASSIVE). Though in case of
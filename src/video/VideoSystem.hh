@@ -1,6 +1,7 @@
 #ifndef VIDEOSYSTEM_HH
 #define VIDEOSYSTEM_HH
 
+#include "PNG.hh"
 #include <string>
 #include <memory>
 #include "components.hh"
@@ -62,11 +63,11 @@ public:
 
 	/** Take a screenshot.
 	  * The default implementation throws an exception.
-	  * @param filename Name of the file to save the screenshot to.
 	  * @param withOsd Should OSD elements be included in the screenshot.
+	  * @result The image, to be saved with ScreenShotWriter.
 	  * @throws MSXException If taking the screen shot fails.
 	  */
-	virtual void takeScreenShot(const std::string& filename, bool withOsd);
+	virtual PNG::Image takeScreenShot(bool withOsd);
 
 	/** Called when the window title string has changed.
 	  */
@@ -217,23 +217,45 @@ void V9990SDLRasterizer<Pixel>::drawDisplay(
 	}
 }
 
+template <class Pixel>
+template <typename DrawLines>
+void V9990SDLRasterizer<Pixel>::drawLines(int numLines, DrawLines& drawLines)
+{
+	// The converters only read VRAM and VDP state, and each line is
+	// written to a different part of the work frame. So converting lines
+	// in parallel is safe, as long as we wait for the helper thread
+	// before returning (VDP state can only change after that).
+	// Splitting only pays off when there's enough work to hide the
+	// thread synchronisation overhead.
+	static const int MIN_THREADED_LINES = 16;
+	if (renderSettings.getV9990RenderThread() &&
+	    (numLines >= MIN_THREADED_LINES)) {
+		int half = numLines / 2;
+		auto bottomHalf = [&]() { drawLines(half, numLines); };
+		helperThread.start(bottomHalf);
+		drawLines(0, half);
+		helperThread.wait();
+	} else {
+		drawLines(0, numLines);
+	}
+}
+
 template <class Pixel>
 void V9990SDLRasterizer<Pixel>::drawP1Mode(
 	int fromX, int fromY, int displayX,
 	int displayY, int displayYA, int displayYB,
 	int displayWidth, int displayHeight, bool drawSprites)
 {
-	while (displayHeight--) {
-		Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(fromY) + fromX;
-		p1Converter.convertLine(pixelPtr, displayX, displayWidth,
-		                        displayY, displayYA, displayYB,
-		                        drawSprites);
-		workFrame->setLineWidth(fromY, 320);
-		++fromY;
-		++displayY;
-		++displayYA;
-		++displayYB;
-	}
+	auto draw = [&](int first, int last) {
+		for (int i = first; i < last; ++i) {
+			Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(fromY + i) + fromX;
+			p1Converter.convertLine(pixelPtr, displayX, displayWidth,
+			                        displayY + i, displayYA + i, displayYB + i,
+			                        drawSprites);
+			workFrame->setLineWidth(fromY + i, 320);
+		}
+	};
+	drawLines(displayHeight, draw);
 }
 
 template <class Pixel>
@@ -241,15 +263,15 @@ void V9990SDLRasterizer<Pixel>::drawP2Mode(
 	int fromX, int fromY, int displayX, int displayY, int displayYA,
 	int displayWidth, int displayHeight, bool drawSprites)
 {
-	while (displayHeight--) {
-		Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(fromY) + fromX;
-		p2Converter.convertLine(pixelPtr, displayX, displayWidth,
-		                        displayY, displayYA, drawSprites);
-		workFrame->setLineWidth(fromY, 640);
-		++fromY;
-		++displayY;
-		++displayYA;
-	}
+	auto draw = [&](int first, int last) {
+		for (int i = first; i < last; ++i) {
+			Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(fromY + i) + fromX;
+			p2Converter.convertLine(pixelPtr, displayX, displayWidth,
+			                        displayY + i, displayYA + i, drawSprites);
+			workFrame->setLineWidth(fromY + i, 640);
+		}
+	};
+	drawLines(displayHeight, draw);
 }
 
 template <class Pixel>
@@ -273,21 +295,23 @@ void V9990SDLRasterizer<Pixel>::drawBxMode(
 	unsigned rollMask = vdp.getRollMask(0x1FFF);
 	unsigned scrollYBase = scrollY & ~rollMask & 0x1FFF;
 	int cursorY = displayY - vdp.getCursorYOffset();
-	while (displayHeight--) {
-		// Note: convertLine() can draw up to 3 pixels too many. But
-		// that's ok, the buffer is big enough: buffer can hold 1280
-		// pixels, max displayWidth is 1024 pixels. When taking the
-		// position of the borders into account, the display area
-		// plus 3 pixels cannot go beyond the end of the buffer.
-		unsigned y = scrollYBase + ((displayYA + scrollY) & rollMask);
-		Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(fromY) + fromX;
-		bitmapConverter.convertLine(pixelPtr, x, y, displayWidth,
-		                            cursorY, drawSprites);
-		workFrame->setLineWidth(fromY, vdp.getLineWidth());
-		++fromY;
-		displayYA += lineStep;
-		cursorY   += lineStep;
-	}
+	unsigned lineWidth = vdp.getLineWidth();
+	auto draw = [&](int first, int last) {
+		for (int i = first; i < last; ++i) {
+			// Note: convertLine() can draw up to 3 pixels too many. But
+			// that's ok, the buffer is big enough: buffer can hold 1280
+			// pixels, max displayWidth is 1024 pixels. When taking the
+			// position of the borders into account, the display area
+			// plus 3 pixels cannot go beyond the end of the buffer.
+			int delta = i * lineStep;
+			unsigned y = scrollYBase + ((displayYA + delta + scrollY) & rollMask);
+			Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(fromY + i) + fromX;
+			bitmapConverter.convertLine(pixelPtr, x, y, displayWidth,
+			                            cursorY + delta, drawSprites);
+			workFrame->setLineWidth(fromY + i, lineWidth);
+		}
+	};
+	drawLines(displayHeight, draw);
 }
 
 
@@ -5,6 +5,7 @@
 #include "V9990BitmapConverter.hh"
 #include "V9990P1Converter.hh"
 #include "V9990P2Converter.hh"
+#include "HelperThread.hh"
 #include "Observer.hh"
 #include <memory>
 
@@ -115,11 +116,22 @@ private:
 	V9990P1Converter<Pixel> p1Converter;
 	V9990P2Converter<Pixel> p2Converter;
 
+	/** Converts part of the display lines when the 'v9990_render_thread'
+	  * setting is enabled.
+	  */
+	HelperThread helperThread;
+
 	/** Fill the palettes.
 	  */
 	void preCalcPalettes();
 	void resetPalette();
 
+	/** Call 'drawLines(first, last)' for the line range [0, numLines),
+	  * possibly split over the calling thread and the helper thread.
+	  */
+	template <typename DrawLines>
+	void drawLines(int numLines, DrawLines& drawLines);
+
 	void drawP1Mode(int fromX, int fromY, int displayX,
 	                int displayY, int displayYA, int displayYB,
 	                int displayWidth, int displayHeight, bool drawSprites);
@@ -123,13 +123,13 @@ void Video9000::paint(OutputSurface& output)
 	activeLayer->paint(output);
 }
 
-void Video9000::takeRawScreenShot(unsigned height, const std::string& filename)
+PNG::Image Video9000::takeRawScreenShot(unsigned height)
 {
 	auto* layer = dynamic_cast<VideoLayer*>(activeLayer);
 	if (!layer) {
 		throw CommandException("TODO");
 	}
-	layer->takeRawScreenShot(height, filename);
+	return layer->takeRawScreenShot(height);
 }
 
 int Video9000::signalEvent(const std::shared_ptr<const Event>& event)